@@ -265,6 +265,18 @@ extern JIT_EXPORT uint32_t jit_llvm_vector_width();
 /// Specify the number of threads that are used to parallelize the computation
 extern JIT_EXPORT void jit_llvm_set_thread_count(uint32_t size);
 
+/**
+ * \brief Set the number of launches after which a kernel compiled with the
+ * cheap optimization pipeline is recompiled at full optimization
+ *
+ * This only has an effect when \c JitFlag::TieredCompile is set. The
+ * default is 16.
+ */
+extern JIT_EXPORT void jit_llvm_set_tier_threshold(uint32_t launches);
+
+/// Return the tier-up threshold, see \ref jit_llvm_set_tier_threshold()
+extern JIT_EXPORT uint32_t jit_llvm_tier_threshold();
+
 // ====================================================================
 //                        Logging infrastructure
 // ====================================================================
@@ -430,9 +442,173 @@ extern JIT_EXPORT void jit_flush_malloc_cache();
 /// Clear the peak memory usage statistics
 extern JIT_EXPORT void jit_malloc_clear_statistics();
 
+/// Placement policy for large (>= 2 MiB) host allocations
+#if defined(__cplusplus)
+enum class MallocPolicy : uint32_t {
+    /**
+     * Back allocations with 2 MiB pages. Dr.Jit first tries to obtain them
+     * from the huge page pool via <tt>MAP_HUGETLB</tt> (for sizes that are a
+     * multiple of 2 MiB) and otherwise requests transparent huge pages via
+     * <tt>madvise(MADV_HUGEPAGE)</tt>. Linux only.
+     */
+    HugePages = 1,
+
+    /// Interleave pages across all permitted NUMA nodes. Linux only.
+    NumaInterleave = 2,
+
+    /**
+     * Fault in new allocations using all workers of the thread pool, so that
+     * the operating system's first-touch policy places each contiguous
+     * chunk on the NUMA node of the worker that is likely to process it.
+     */
+    NumaFirstTouch = 4,
+
+    /// Default policy
+    Default = (uint32_t) HugePages
+};
+#else
+enum MallocPolicy {
+    MallocPolicyHugePages = 1,
+    MallocPolicyNumaInterleave = 2,
+    MallocPolicyNumaFirstTouch = 4,
+    MallocPolicyDefault = MallocPolicyHugePages
+};
+#endif
+
+/**
+ * \brief Set the placement policy for large host allocations
+ *
+ * The \c policy parameter is a combination of \ref MallocPolicy flags. It
+ * only affects memory that is newly requested from the operating system, so
+ * it may be worthwhile to call \ref jit_flush_malloc_cache() after changing
+ * it.
+ */
+extern JIT_EXPORT void jit_malloc_set_policy(uint32_t policy);
+
+/// Return the placement policy for large host allocations
+extern JIT_EXPORT uint32_t jit_malloc_policy();
+
+/**
+ * \brief Set a soft limit on the memory held by the allocator
+ *
+ * The limit applies to the memory of the given type that has been requested
+ * from the GPU / OS, including unused blocks in the allocation cache (the \c
+ * allocated quantity of \ref jit_malloc_stats()). When a new allocation would
+ * exceed it, Dr.Jit releases the least recently freed cached blocks until the
+ * total drops below 7/8 of the limit. Memory that is in use is never
+ * released, hence the limit can still be exceeded. A value of \c 0 (the
+ * default) disables the limit.
+ */
+extern JIT_EXPORT void jit_malloc_set_limit(JIT_ENUM AllocType type,
+                                            size_t limit);
+
+/**
+ * \brief Query memory usage statistics of the given allocation type
+ *
+ * Each pointer may be \c NULL. \c requested is the total size requested by
+ * live allocations, and \c usage is what they occupy after rounding to the
+ * allocator's size classes. \c allocated additionally includes unused blocks
+ * held by the allocation cache, and \c watermark is the peak of
+ * \c allocated since the last call to \ref jit_malloc_clear_statistics().
+ * The ratios <tt>(usage - requested) / usage</tt> and <tt>(allocated -
+ * usage) / allocated</tt> quantify internal and external fragmentation.
+ */
+extern JIT_EXPORT void jit_malloc_stats(JIT_ENUM AllocType type,
+                                        size_t *requested, size_t *usage,
+                                        size_t *allocated, size_t *watermark);
+
 /// Flush internal kernel cache
 extern JIT_EXPORT void jit_flush_kernel_cache();
 
+/**
+ * \brief Set a budget for the in-memory kernel cache
+ *
+ * When the compiled kernels occupy more than \c size bytes or the cache
+ * contains more than \c count kernels, the least recently launched kernels
+ * are released at the beginning of the next evaluation. A value of \c 0
+ * disables the corresponding limit (the default).
+ */
+extern JIT_EXPORT void jit_kernel_cache_set_limit(size_t size, size_t count);
+
+/**
+ * \brief Query statistics of the in-memory kernel cache
+ *
+ * Each pointer may be \c NULL. Misses are split into soft misses (kernel was
+ * loaded from disk) and hard misses (kernel was compiled). \c evictions
+ * counts kernels released by \ref jit_kernel_cache_set_limit(), and \c size
+ * is the memory occupied by the compiled kernels.
+ */
+extern JIT_EXPORT void jit_kernel_cache_stats(size_t *hits, size_t *soft_misses,
+                                              size_t *hard_misses,
+                                              size_t *evictions, size_t *size);
+
+/**
+ * \brief Pass literal constants that keep changing via the kernel parameters
+ *
+ * Literal constants are normally embedded into the generated code. Kernels
+ * that only differ in the value of a constant (e.g. a time step) therefore
+ * have different hashes, and each one must be compiled separately.
+ *
+ * When set to a nonzero value, Dr.Jit tracks the value of each 32/64-bit
+ * integer and floating point literal of a kernel across launches. Once a
+ * literal took on a new value \c threshold times, it is loaded from the
+ * kernel parameter array instead (like pointer literals), so that the
+ * kernel can be reused for any value. Literals that stay constant are still
+ * embedded into the code. The default is 0 (disabled).
+ *
+ * The history covers a bounded number of recently used literals and is
+ * cleared by \ref jit_flush_kernel_cache().
+ */
+extern JIT_EXPORT void jit_set_literal_hoisting(uint32_t threshold);
+
+/// Return the threshold of \ref jit_set_literal_hoisting()
+extern JIT_EXPORT uint32_t jit_literal_hoisting();
+
+/**
+ * \brief Compact the on-disk kernel cache
+ *
+ * On Linux and macOS, compiled kernels are appended to a single memory-mapped
+ * file (\c ~/.drjit/kernels-v*.pack) that is shared between processes. This
+ * function rewrites it so that its index has a load factor between 1/4 and
+ * 1/2 while dropping records that are no longer referenced. Other processes
+ * using the cache switch over to the new file automatically. The function
+ * has no effect on Windows, which stores one file per kernel.
+ */
+extern JIT_EXPORT void jit_kernel_cache_compact();
+
+/**
+ * \brief Limit the size of the on-disk kernel cache
+ *
+ * When a newly written kernel makes the cache exceed \c size bytes, the least
+ * recently loaded kernels are evicted until it occupies less than 7/8 of the
+ * limit. The default is 1 GiB, and a value of \c 0 disables the limit. This
+ * is currently only enforced on Linux and macOS.
+ */
+extern JIT_EXPORT void jit_kernel_cache_set_disk_limit(size_t size);
+
+/// Return the limit of \ref jit_kernel_cache_set_disk_limit()
+extern JIT_EXPORT size_t jit_kernel_cache_disk_limit();
+
+/**
+ * \brief Set the directory of the on-disk kernel cache
+ *
+ * The default location is <tt>~/.drjit</tt> on Linux and macOS and
+ * <tt>%TEMP%\\drjit</tt> on Windows, unless the environment variable
+ * \c DRJIT_CACHE_DIR specifies another directory. It is created if it
+ * doesn't exist yet. This can be used to place the cache on a shared file
+ * system or a tmpfs mount. The setting persists until \ref jit_shutdown().
+ */
+extern JIT_EXPORT void jit_kernel_cache_set_dir(const char *path);
+
+/**
+ * \brief Return the directory of the on-disk kernel cache
+ *
+ * Returns \c NULL before \ref jit_init(). Note: the return value points into
+ * a static array, whose contents may be changed by later calls to
+ * <tt>jit_*</tt> API functions. Either use it right away or create a copy.
+ */
+extern JIT_EXPORT const char *jit_kernel_cache_dir();
+
 /// Query the flavor of a memory allocation made using \ref jit_malloc()
 extern JIT_EXPORT JIT_ENUM AllocType jit_malloc_type(void *ptr);
 
@@ -1206,6 +1382,23 @@ extern JIT_EXPORT int jit_var_eval(uint32_t index);
 /// Evaluate all scheduled computation
 extern JIT_EXPORT void jit_eval();
 
+/**
+ * \brief Bound the size of traced programs by inserting evaluation
+ * checkpoints automatically
+ *
+ * When set to a nonzero value, Dr.Jit counts the operations that were traced
+ * since the last evaluation. Once there are more than \c ops of them, the next
+ * operation first evaluates some of the unevaluated variables that are still
+ * referenced by the program. These cut points are chosen to materialize few
+ * bytes while leaving at most <tt>ops / 2</tt> operations unevaluated, which
+ * avoids kernels that are very slow to compile. Checkpoints are not inserted
+ * while \c JitFlag::Recording is set. The default is 0 (disabled).
+ */
+extern JIT_EXPORT void jit_set_auto_eval_budget(uint32_t ops);
+
+/// Return the operation budget, see \ref jit_set_auto_eval_budget()
+extern JIT_EXPORT uint32_t jit_auto_eval_budget();
+
 /**
  * \brief Assign a callback function that is invoked when the variable is
  * evaluated or freed.
@@ -1246,6 +1439,9 @@ extern JIT_EXPORT const char *jit_var_label(uint32_t index);
  */
 extern JIT_EXPORT const char *jit_var_whos();
 
+/// Return the memory usage of the variable table in bytes
+extern JIT_EXPORT size_t jit_var_table_memory();
+
 /**
  * \brief Return a GraphViz representation of registered variables and their
  * dependencies
@@ -1353,12 +1549,44 @@ enum class JitFlag : uint32_t {
     /// Perform a intra-warp/SIMD register reduction before issuing global atomics
     AtomicReduceLocal = 16384,
 
+    /**
+     * \brief Compile the kernels of a single jit_eval() call in parallel
+     * (LLVM only). When several kernels miss the cache, they are compiled
+     * by the thread pool and each one is launched once its compilation
+     * finishes.
+     */
+    ParallelCompile = 32768,
+
+    /**
+     * \brief Tiered compilation of LLVM kernels
+     *
+     * Kernels are first compiled using a cheap optimization pipeline. Once a
+     * kernel has been launched \ref jit_llvm_tier_threshold() times, it is
+     * recompiled with full optimizations in the background, and subsequent
+     * launches use the optimized version. Only fully optimized kernels are
+     * written to the cache on disk.
+     */
+    TieredCompile = 65536,
+
+    /**
+     * \brief Debug mode: keep the source code of cached kernels and compare
+     * it on every lookup instead of only comparing the 128-bit kernel hash
+     */
+    KernelCacheVerify = 131072,
+
+    /**
+     * \brief Use compensated (Kahan) summation in floating point reductions
+     * of the LLVM backend. Sums otherwise use pairwise summation, which is
+     * faster but less accurate.
+     */
+    ReduceKahan = 262144,
+
     /// Default flags
     Default = (uint32_t) ConstProp | (uint32_t) ValueNumbering |
               (uint32_t) LoopRecord | (uint32_t) LoopOptimize |
               (uint32_t) VCallRecord | (uint32_t) VCallDeduplicate |
               (uint32_t) VCallOptimize | (uint32_t) ADOptimize |
-              (uint32_t) AtomicReduceLocal
+              (uint32_t) AtomicReduceLocal | (uint32_t) ParallelCompile
 };
 #else
 enum JitFlag {
@@ -1376,7 +1604,11 @@ enum JitFlag {
     JitFlagKernelHistory       = 2048,
     JitFlagLaunchBlocking      = 4096,
     JitFlagADOptimize          = 8192,
-    JitFlagAtomicReduceLocal = 16384
+    JitFlagAtomicReduceLocal = 16384,
+    JitFlagParallelCompile     = 32768,
+    JitFlagTieredCompile       = 65536,
+    JitFlagKernelCacheVerify   = 131072,
+    JitFlagReduceKahan         = 262144
 };
 #endif
 
@@ -1554,7 +1786,7 @@ extern JIT_EXPORT uint32_t jit_var_mask_peek(JIT_ENUM JitBackend backend);
 
 /// Return the default mask for a wavefront of the given \c size
 extern JIT_EXPORT uint32_t jit_var_mask_default(JIT_ENUM JitBackend backend,
-                                                uint32_t size);
+                                                size_t size);
 
 /**
  * \brief Combine the given mask 'index' with the mask stack
@@ -1562,7 +1794,7 @@ extern JIT_EXPORT uint32_t jit_var_mask_default(JIT_ENUM JitBackend backend,
  * On the LLVM backend, a default mask will be created when the mask stack is empty.
  * The \c size parameter determines the size of the associated wavefront.
  */
-extern JIT_EXPORT uint32_t jit_var_mask_apply(uint32_t index, uint32_t size);
+extern JIT_EXPORT uint32_t jit_var_mask_apply(uint32_t index, size_t size);
 
 // ====================================================================
 //                          Horizontal reductions
@@ -1589,7 +1821,7 @@ extern JIT_EXPORT uint32_t jit_var_reduce(uint32_t index, JIT_ENUM ReduceOp redu
  * a single int, float, double, etc. (\c isize can be 1, 2, 4, or 8).
  * Runs asynchronously.
  */
-extern JIT_EXPORT void jit_memset_async(JIT_ENUM JitBackend backend, void *ptr, uint32_t size,
+extern JIT_EXPORT void jit_memset_async(JIT_ENUM JitBackend backend, void *ptr, size_t size,
                                         uint32_t isize, const void *src);
 
 /// Perform a synchronous copy operation
@@ -1611,7 +1843,7 @@ extern JIT_EXPORT void jit_memcpy_async(JIT_ENUM JitBackend backend, void *dst,
  */
 extern JIT_EXPORT void jit_reduce(JIT_ENUM JitBackend backend, JIT_ENUM VarType type,
                                   JIT_ENUM ReduceOp rtype,
-                                  const void *in, uint32_t size, void *out);
+                                  const void *in, size_t size, void *out);
 
 /** \brief Compute n prefix sum over the given input array
  *
@@ -1646,7 +1878,7 @@ extern JIT_EXPORT void jit_reduce(JIT_ENUM JitBackend backend, JIT_ENUM VarType
  */
 extern JIT_EXPORT void jit_prefix_sum(JIT_ENUM JitBackend backend,
                                       JIT_ENUM VarType type, int exclusive,
-                                      const void *in, uint32_t size, void *out);
+                                      const void *in, size_t size, void *out);
 
 /**
  * \brief Compress a mask into a list of nonzero indices
@@ -1659,10 +1891,12 @@ extern JIT_EXPORT void jit_prefix_sum(JIT_ENUM JitBackend backend,
  * The internals resemble \ref jit_prefix_sum_u32(), and the CUDA implementation may
  * similarly access regions beyond the end of \c in and \c out.
  *
+ * Since the output consists of 32-bit indices, \c size may not exceed 2^32.
+ *
  * This function internally performs a synchronization step.
  */
 extern JIT_EXPORT uint32_t jit_compress(JIT_ENUM JitBackend backend, const uint8_t *in,
-                                        uint32_t size, uint32_t *out);
+                                        size_t size, uint32_t *out);
 
 
 /**
@@ -1692,9 +1926,12 @@ extern JIT_EXPORT uint32_t jit_compress(JIT_ENUM JitBackend backend, const uint8
  * \return
  *     When \c offsets != NULL, the function returns the number of unique
  *     values found in \c values. Otherwise, it returns zero.
+ *
+ * Since the permutation consists of 32-bit indices, \c size may not exceed
+ * 2^32.
  */
 extern JIT_EXPORT uint32_t jit_mkperm(JIT_ENUM JitBackend backend, const uint32_t *values,
-                                      uint32_t size, uint32_t bucket_count,
+                                      size_t size, uint32_t bucket_count,
                                       uint32_t *perm, uint32_t *offsets);
 
 /// Helper data structure for vector method calls, see \ref jit_var_vcall()
@@ -1857,7 +2094,7 @@ struct KernelHistoryEntry {
     int cache_disk;
 
     /// Launch width / number of array entries that were processed
-    uint32_t size;
+    size_t size;
 
     /// Number of input arrays
     uint32_t input_count;
@@ -1868,6 +2105,9 @@ struct KernelHistoryEntry {
     /// Number of IR operations
     uint32_t operation_count;
 
+    /// Number of operations removed as redundant or unused before assembly
+    uint32_t eliminated_count;
+
     /// Time (ms) spent generating the kernel intermediate representation
     float codegen_time;
 
@@ -1877,6 +2117,9 @@ struct KernelHistoryEntry {
     /// Time (ms) spent executing the kernel
     float execution_time;
 
+    /// Optimization tier of an LLVM kernel (0: quick compile, 1: optimized)
+    uint32_t tier;
+
     // Dr.Jit internal portion, will be cleared by jit_kernel_history()
     // ================================================================
 
@@ -1914,6 +2157,33 @@ extern JIT_EXPORT void jit_kernel_history_clear();
  */
 extern JIT_EXPORT struct KernelHistoryEntry *jit_kernel_history();
 
+/**
+ * \brief Create a kernel cache manifest from a kernel history
+ *
+ * Takes the list returned by \ref jit_kernel_history() and produces a textual
+ * manifest with one line per unique kernel, which specifies its backend and
+ * 128-bit hash (e.g. <tt>llvm 0123...cdef</tt>). The manifest can be stored
+ * and later passed to \ref jit_kernel_cache_prefetch() to warm up the kernel
+ * cache of another session. The caller must release the returned string
+ * using \c free().
+ */
+extern JIT_EXPORT char *
+jit_kernel_history_manifest(const struct KernelHistoryEntry *history);
+
+/**
+ * \brief Load the kernels of a manifest from the disk cache
+ *
+ * This function parses a manifest created by \ref jit_kernel_history_manifest()
+ * and loads the listed kernels from the on-disk cache into the in-memory
+ * kernel cache. This happens in parallel, and it avoids latency spikes when
+ * the kernels are first launched. Kernels that are already cached, that
+ * don't exist on disk, or that target an uninitialized backend are skipped.
+ * Empty lines and lines starting with \c # are ignored.
+ *
+ * Returns the number of kernels that were loaded.
+ */
+extern JIT_EXPORT uint32_t jit_kernel_cache_prefetch(const char *manifest);
+
 #if defined(__cplusplus)
 }
 
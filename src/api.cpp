@@ -274,6 +274,16 @@ void jit_llvm_set_thread_count(uint32_t size) {
     pool_set_size(nullptr, size);
 }
 
+void jit_llvm_set_tier_threshold(uint32_t launches) {
+    lock_guard guard(state.lock);
+    jitc_llvm_tier_threshold = launches;
+}
+
+uint32_t jit_llvm_tier_threshold() {
+    lock_guard guard(state.lock);
+    return jitc_llvm_tier_threshold;
+}
+
 void jit_llvm_set_target(const char *target_cpu,
                          const char *target_features,
                          uint32_t vector_width) {
@@ -325,6 +335,62 @@ void jit_flush_kernel_cache() {
     jitc_flush_kernel_cache();
 }
 
+void jit_kernel_cache_set_limit(size_t size, size_t count) {
+    lock_guard guard(state.lock);
+    state.kernel_cache_limit_size = size;
+    state.kernel_cache_limit_count = count;
+}
+
+void jit_kernel_cache_stats(size_t *hits, size_t *soft_misses,
+                            size_t *hard_misses, size_t *evictions,
+                            size_t *size) {
+    lock_guard guard(state.lock);
+    if (hits)
+        *hits = state.kernel_hits;
+    if (soft_misses)
+        *soft_misses = state.kernel_soft_misses;
+    if (hard_misses)
+        *hard_misses = state.kernel_hard_misses;
+    if (evictions)
+        *evictions = state.kernel_evictions;
+    if (size)
+        *size = state.kernel_cache_size;
+}
+
+void jit_set_literal_hoisting(uint32_t threshold) {
+    lock_guard guard(state.lock);
+    state.literal_hoisting = threshold;
+}
+
+uint32_t jit_literal_hoisting() {
+    lock_guard guard(state.lock);
+    return state.literal_hoisting;
+}
+
+void jit_kernel_cache_compact() {
+    jitc_kernel_cache_compact();
+}
+
+void jit_kernel_cache_set_disk_limit(size_t size) {
+    lock_guard guard(state.lock);
+    jitc_kernel_cache_disk_limit = size;
+}
+
+size_t jit_kernel_cache_disk_limit() {
+    lock_guard guard(state.lock);
+    return jitc_kernel_cache_disk_limit;
+}
+
+void jit_kernel_cache_set_dir(const char *path) {
+    lock_guard guard(state.lock);
+    jitc_set_cache_dir(path);
+}
+
+const char *jit_kernel_cache_dir() {
+    lock_guard guard(state.lock);
+    return jitc_cache_dir();
+}
+
 void *jit_malloc(AllocType type, size_t size) {
     lock_guard guard(state.lock);
     return jitc_malloc(type, size);
@@ -345,6 +411,38 @@ void jit_malloc_clear_statistics() {
     jitc_malloc_clear_statistics();
 }
 
+void jit_malloc_set_policy(uint32_t policy) {
+    lock_guard guard(state.lock);
+    jitc_malloc_policy = policy;
+}
+
+uint32_t jit_malloc_policy() {
+    lock_guard guard(state.lock);
+    return jitc_malloc_policy;
+}
+
+void jit_malloc_set_limit(AllocType type, size_t limit) {
+    lock_guard guard(state.lock);
+    if ((int) type < 0 || type >= AllocType::Count)
+        jitc_raise("jit_malloc_set_limit(): invalid allocation type!");
+    state.alloc_limit[(int) type] = limit;
+}
+
+void jit_malloc_stats(AllocType type, size_t *requested, size_t *usage,
+                      size_t *allocated, size_t *watermark) {
+    lock_guard guard(state.lock);
+    if ((int) type < 0 || type >= AllocType::Count)
+        jitc_raise("jit_malloc_stats(): invalid allocation type!");
+    if (requested)
+        *requested = state.alloc_requested[(int) type];
+    if (usage)
+        *usage = state.alloc_usage[(int) type];
+    if (allocated)
+        *allocated = state.alloc_allocated[(int) type];
+    if (watermark)
+        *watermark = state.alloc_watermark[(int) type];
+}
+
 enum AllocType jit_malloc_type(void *ptr) {
     lock_guard guard(state.lock);
     return jitc_malloc_type(ptr);
@@ -442,7 +540,7 @@ int jit_var_exists(uint32_t index) {
     if (index == 0)
         return 0;
     lock_guard guard(state.lock);
-    return state.variables.find(index) != state.variables.end();
+    return state.variables.find(index) != nullptr;
 }
 
 uint32_t jit_var_ref(uint32_t index) {
@@ -570,7 +668,7 @@ uint32_t jit_var_mask_peek(JitBackend backend) {
     return jitc_var_mask_peek(backend);
 }
 
-uint32_t jit_var_mask_apply(uint32_t index, uint32_t size) {
+uint32_t jit_var_mask_apply(uint32_t index, size_t size) {
     lock_guard guard(state.lock);
     return jitc_var_mask_apply(index, size);
 }
@@ -585,7 +683,7 @@ void jit_var_mask_pop(JitBackend backend) {
     jitc_var_mask_pop(backend);
 }
 
-uint32_t jit_var_mask_default(JitBackend backend, uint32_t size) {
+uint32_t jit_var_mask_default(JitBackend backend, size_t size) {
     lock_guard guard(state.lock);
     return jitc_var_mask_default(backend, size);
 }
@@ -610,6 +708,11 @@ const char *jit_var_whos() {
     return jitc_var_whos();
 }
 
+size_t jit_var_table_memory() {
+    lock_guard guard(state.lock);
+    return state.variables.memory();
+}
+
 const char *jit_var_graphviz() {
     lock_guard guard(state.lock);
     return jitc_var_graphviz();
@@ -642,6 +745,16 @@ void jit_eval() {
     jitc_eval(thread_state_llvm);
 }
 
+void jit_set_auto_eval_budget(uint32_t ops) {
+    lock_guard guard(state.lock);
+    state.auto_eval_budget = ops;
+}
+
+uint32_t jit_auto_eval_budget() {
+    lock_guard guard(state.lock);
+    return state.auto_eval_budget;
+}
+
 int jit_var_eval(uint32_t index) {
     if (index == 0)
         return 0;
@@ -666,7 +779,7 @@ void jit_prefix_pop(JitBackend backend) {
     jitc_prefix_pop(backend);
 }
 
-void jit_memset_async(JitBackend backend, void *ptr, uint32_t size, uint32_t isize,
+void jit_memset_async(JitBackend backend, void *ptr, size_t size, uint32_t isize,
                       const void *src) {
     lock_guard guard(state.lock);
     jitc_memset_async(backend, ptr, size, isize, src);
@@ -683,23 +796,23 @@ void jit_memcpy_async(JitBackend backend, void *dst, const void *src, size_t siz
 }
 
 void jit_reduce(JitBackend backend, VarType type, ReduceOp rtype, const void *ptr,
-                uint32_t size, void *out) {
+                size_t size, void *out) {
     lock_guard guard(state.lock);
     jitc_reduce(backend, type, rtype, ptr, size, out);
 }
 
 void jit_prefix_sum(JitBackend backend, VarType type, int exclusive, const void *in,
-              uint32_t size, void *out) {
+              size_t size, void *out) {
     lock_guard guard(state.lock);
     jitc_prefix_sum(backend, type, exclusive != 0, in, size, out);
 }
 
-uint32_t jit_compress(JitBackend backend, const uint8_t *in, uint32_t size, uint32_t *out) {
+uint32_t jit_compress(JitBackend backend, const uint8_t *in, size_t size, uint32_t *out) {
     lock_guard guard(state.lock);
     return jitc_compress(backend, in, size, out);
 }
 
-uint32_t jit_mkperm(JitBackend backend, const uint32_t *values, uint32_t size,
+uint32_t jit_mkperm(JitBackend backend, const uint32_t *values, size_t size,
                     uint32_t bucket_count, uint32_t *perm, uint32_t *offsets) {
     lock_guard guard(state.lock);
     return jitc_mkperm(backend, values, size, bucket_count, perm, offsets);
@@ -832,6 +945,15 @@ struct KernelHistoryEntry *jit_kernel_history() {
     return state.kernel_history.get();
 }
 
+char *jit_kernel_history_manifest(const struct KernelHistoryEntry *history) {
+    return jitc_kernel_manifest(history);
+}
+
+uint32_t jit_kernel_cache_prefetch(const char *manifest) {
+    lock_guard guard(state.lock);
+    return jitc_kernel_prefetch(manifest);
+}
+
 #if defined(DRJIT_ENABLE_OPTIX)
 OptixDeviceContext jit_optix_context() {
     lock_guard guard(state.lock);
@@ -160,8 +160,8 @@ void jitc_cuda_assemble(ThreadState *ts, ScheduledGroup group,
     for (uint32_t gi = group.start; gi != group.end; ++gi) {
         uint32_t index = schedule[gi].index;
         Variable *v = jitc_var(index);
-        const uint32_t vti = v->type,
-                       size = v->size;
+        const uint32_t vti = v->type;
+        const size_t size = v->size;
         const VarType vt = (VarType) vti;
         bool assemble = false;
 
@@ -184,9 +184,9 @@ void jitc_cuda_assemble(ThreadState *ts, ScheduledGroup group,
             }
         }
 
-        if (likely(v->param_type == ParamType::Input)) {
+        if (likely(jitc_var_scratch(v).param_type == ParamType::Input)) {
             if (v->is_literal()) {
-                fmt("    ld.$s.u64 $v, [$s+$o];\n", params_type, v, params_base, v);
+                fmt("    ld.$s.$b $v, [$s+$o];\n", params_type, v, v, params_base, v);
                 continue;
             } else {
                 fmt("    ld.$s.u64 %rd0, [$s+$o];\n", params_type, params_base, v);
@@ -210,7 +210,20 @@ void jitc_cuda_assemble(ThreadState *ts, ScheduledGroup group,
             jitc_cuda_render_stmt(index, v);
         }
 
-        if (v->param_type == ParamType::Output) {
+        if (jitc_var_scratch(v).param_type == ParamType::Output && size != group.size) {
+            /* Scalar output of a larger kernel (see jitc_eval_fuse_scalars()).
+               All threads compute the same value, the first one stores it. */
+            fmt("    ld.$s.u64 %rd0, [$s+$o];\n"
+                "    setp.eq.u32 %p3, %r0, 0;\n",
+                params_type, params_base, v);
+
+            if (vt != VarType::Bool) {
+                fmt("    @%p3 st.global.$t [%rd0], $v;\n", v, v);
+            } else {
+                fmt("    selp.u16 %w0, 1, 0, $v;\n"
+                    "    @%p3 st.global.u8 [%rd0], %w0;\n", v);
+            }
+        } else if (jitc_var_scratch(v).param_type == ParamType::Output) {
             fmt("    ld.$s.u64 %rd0, [$s+$o];\n"
                 "    mad.wide.u32 %rd0, %r0, $a, %rd0;\n",
                 params_type, params_base, v, v);
@@ -690,7 +703,7 @@ static void jitc_cuda_render_var(uint32_t index, Variable *v) {
                 bool is_bool = v->type == (uint32_t) VarType::Bool;
 
                 if (!unmasked)
-                    fmt("    @!$v bra l_$u_masked;\n", a2, v->reg_index);
+                    fmt("    @!$v bra l_$u_masked;\n", a2, jitc_var_scratch(v).reg_index);
 
                 if (index_zero) {
                     fmt("    mov.u64 %rd3, $v;\n", a0);
@@ -713,8 +726,8 @@ static void jitc_cuda_render_var(uint32_t index, Variable *v) {
                     fmt("    bra.uni l_$u_done;\n\n"
                         "l_$u_masked:\n"
                         "    mov.$b $v, 0;\n\n"
-                        "l_$u_done:\n", v->reg_index,
-                        v->reg_index, v, v, v->reg_index);
+                        "l_$u_done:\n", jitc_var_scratch(v).reg_index,
+                        jitc_var_scratch(v).reg_index, v, v, jitc_var_scratch(v).reg_index);
             }
             break;
 
@@ -745,8 +758,8 @@ static void jitc_cuda_render_var(uint32_t index, Variable *v) {
 
         case VarKind::Dispatch:
             jitc_var_vcall_assemble((VCall *) state.extra[index].callback_data,
-                                    a0->reg_index, a1->reg_index, a2->reg_index,
-                                    a3 ? a3->reg_index : 0);
+                                    jitc_var_scratch(a0).reg_index, jitc_var_scratch(a1).reg_index, jitc_var_scratch(a2).reg_index,
+                                    a3 ? jitc_var_scratch(a3).reg_index : 0);
             break;
 
         case VarKind::TexLookup:
@@ -794,7 +807,7 @@ static void jitc_cuda_render_scatter(const Variable *v,
     bool is_bool = value->type == (uint32_t) VarType::Bool;
 
     if (!unmasked)
-        fmt("    @!$v bra l_$u_done;\n", mask, v->reg_index);
+        fmt("    @!$v bra l_$u_done;\n", mask, jitc_var_scratch(v).reg_index);
 
     if (index_zero) {
         fmt("    mov.u64 %rd3, $v;\n", ptr);
@@ -904,7 +917,7 @@ static void jitc_cuda_render_scatter(const Variable *v,
     }
 
     if (!unmasked)
-        fmt("\nl_$u_done:\n", v->reg_index);
+        fmt("\nl_$u_done:\n", jitc_var_scratch(v).reg_index);
 }
 
 static void jitc_cuda_render_scatter_inc(Variable *v,
@@ -942,7 +955,7 @@ static void jitc_cuda_render_scatter_inc(Variable *v,
         "}\n");
 
     if (!unmasked)
-        fmt("    @!$v bra l_$u_done;\n", mask, v->reg_index);
+        fmt("    @!$v bra l_$u_done;\n", mask, jitc_var_scratch(v).reg_index);
 
     if (index_zero) {
         fmt("    mov.u64 %rd3, $v;\n", ptr);
@@ -957,7 +970,7 @@ static void jitc_cuda_render_scatter_inc(Variable *v,
         "    }\n", v);
 
     if (!unmasked)
-        fmt("\nl_$u_done:\n", v->reg_index);
+        fmt("\nl_$u_done:\n", jitc_var_scratch(v).reg_index);
 
     v->consumed = 1;
 }
@@ -974,7 +987,7 @@ static void jitc_cuda_render_scatter_kahan(const Variable *v, uint32_t v_index)
     bool unmasked = mask->is_literal() && mask->literal == 1;
 
     if (!unmasked)
-        fmt("    @!$v bra l_$u_done;\n", mask, v->reg_index);
+        fmt("    @!$v bra l_$u_done;\n", mask, jitc_var_scratch(v).reg_index);
 
     fmt("    mad.wide.$t %rd2, $v, $a, $v;\n"
         "    mad.wide.$t %rd3, $v, $a, $v;\n",
@@ -1017,7 +1030,7 @@ static void jitc_cuda_render_scatter_kahan(const Variable *v, uint32_t v_index)
         value);
 
     if (!unmasked)
-        fmt("\nl_$u_done:\n", v->reg_index);
+        fmt("\nl_$u_done:\n", jitc_var_scratch(v).reg_index);
 }
 
 static void jitc_cuda_render_printf(uint32_t index, const Variable *v,
@@ -1143,7 +1156,7 @@ static void jitc_cuda_render_trace(uint32_t index, const Variable *v,
 
     bool masked = !valid->is_literal() || valid->literal != 1;
     if (masked)
-        fmt("    @!$v bra l_masked_$u;\n", valid, v->reg_index);
+        fmt("    @!$v bra l_masked_$u;\n", valid, jitc_var_scratch(v).reg_index);
 
     fmt("    .reg.u32 $v_payload_type, $v_payload_count;\n"
         "    mov.u32 $v_payload_type, 0;\n"
@@ -1169,7 +1182,7 @@ static void jitc_cuda_render_trace(uint32_t index, const Variable *v,
     put(");\n");
 
     if (masked)
-        fmt("\nl_masked_$u:\n", v->reg_index);
+        fmt("\nl_masked_$u:\n", jitc_var_scratch(v).reg_index);
 }
 #endif
 
@@ -1215,8 +1228,8 @@ static void jitc_cuda_render_stmt(uint32_t index, const Variable *v) {
             put(prefix, strlen(prefix));
 
             if (type == 'r') {
-                buffer.put_u32(dep->reg_index);
-                if (unlikely(dep->reg_index == 0))
+                buffer.put_u32(jitc_var_scratch(dep).reg_index);
+                if (unlikely(jitc_var_scratch(dep).reg_index == 0))
                     jitc_fail("jitc_cuda_render_stmt(): variable has no register index!");
             }
         }
@@ -1281,16 +1294,15 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
 
     // Special handling for predicates
     for (uint32_t in : vcall->in) {
-        auto it = state.variables.find(in);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(in);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
 
         if ((VarType) v2->type != VarType::Bool)
             continue;
 
         fmt("        selp.u16 %w$u, 1, 0, %p$u;\n",
-            v2->reg_index, v2->reg_index);
+            jitc_var_scratch(v2).reg_index, jitc_var_scratch(v2).reg_index);
     }
 
     put("        {\n");
@@ -1326,10 +1338,9 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
 
     uint32_t offset = 0;
     for (uint32_t in : vcall->in) {
-        auto it = state.variables.find(in);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(in);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
         uint32_t size = type_size[v2->type];
 
         const char *tname = type_name_ptx[v2->type],
@@ -1342,7 +1353,7 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
         }
 
         fmt("            st.param.$s [in+$u], $s$u;\n", tname, offset, prefix,
-            v2->reg_index);
+            jitc_var_scratch(v2).reg_index);
 
         offset += size;
     }
@@ -1366,20 +1377,19 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
     for (uint32_t i = 0; i < n_out; ++i) {
         uint32_t index = vcall->out_nested[i],
                  index_2 = vcall->out[i];
-        auto it = state.variables.find(index);
-        if (it == state.variables.end())
+        const Variable *v = state.variables.find(index);
+        if (!v)
             continue;
-        uint32_t size = type_size[it->second.type],
+        uint32_t size = type_size[v->type],
                  load_offset = offset;
         offset += size;
 
         // Skip if expired
-        auto it2 = state.variables.find(index_2);
-        if (it2 == state.variables.end())
+        const Variable *v2 = state.variables.find(index_2);
+        if (!v2)
             continue;
 
-        const Variable *v2 = &it2.value();
-        if (v2->reg_index == 0 || v2->param_type == ParamType::Input)
+        if (jitc_var_scratch(v2).reg_index == 0 || jitc_var_scratch(v2).param_type == ParamType::Input)
             continue;
 
         const char *tname = type_name_ptx[v2->type],
@@ -1392,7 +1402,7 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
         }
 
         fmt("            ld.param.$s $s$u, [out+$u];\n",
-            tname, prefix, v2->reg_index, load_offset);
+            tname, prefix, jitc_var_scratch(v2).reg_index, load_offset);
     }
 
     put("        }\n\n");
@@ -1402,18 +1412,17 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
     // =====================================================
 
     for (uint32_t out : vcall->out) {
-        auto it = state.variables.find(out);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(out);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
         if ((VarType) v2->type != VarType::Bool)
             continue;
-        if (v2->reg_index == 0 || v2->param_type == ParamType::Input)
+        if (jitc_var_scratch(v2).reg_index == 0 || jitc_var_scratch(v2).param_type == ParamType::Input)
             continue;
 
         // Special handling for predicates
         fmt("        setp.ne.u16 %p$u, %w$u, 0;\n",
-            v2->reg_index, v2->reg_index);
+            jitc_var_scratch(v2).reg_index, jitc_var_scratch(v2).reg_index);
     }
 
 
@@ -1426,11 +1435,10 @@ void jitc_var_vcall_assemble_cuda(VCall *vcall, uint32_t vcall_reg,
 
     fmt("\nl_masked_$u:\n", vcall_reg);
     for (uint32_t out : vcall->out) {
-        auto it = state.variables.find(out);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(out);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
-        if (v2->reg_index == 0 || v2->param_type == ParamType::Input)
+        if (jitc_var_scratch(v2).reg_index == 0 || jitc_var_scratch(v2).param_type == ParamType::Input)
             continue;
 
         fmt("    mov.$b $v, 0;\n", v2, v2);
@@ -466,7 +466,7 @@ void jitc_cuda_tex_memcpy_t2d(size_t ndim, const size_t *shape,
 
 Variable jitc_cuda_tex_check(size_t ndim, const uint32_t *pos) {
     // Validate input types, determine size of the operation
-    uint32_t size = 0;
+    size_t size = 0;
     bool dirty = false, placeholder = false;
     JitBackend backend = JitBackend::Invalid;
 
@@ -15,7 +15,8 @@
 #include "util.h"
 #include "optix.h"
 #include "loop.h"
-#include <tsl/robin_set.h>
+#include <chrono>
+#include <atomic>
 
 // ====================================================================
 //  The following data structures are temporarily used during program
@@ -29,8 +30,41 @@ std::vector<ScheduledVariable> schedule;
 /// Groups of variables with the same size
 std::vector<ScheduledGroup> schedule_groups;
 
-/// Auxiliary data structure needed to compute 'schedule_sizes' and 'schedule'
-static tsl::robin_set<std::pair<uint32_t, uint32_t>, pair_hash> visited;
+/* Variables are marked as visited by jitc_var_traverse() by storing the
+   current epoch in VariableScratch::visit_epoch. Every traversal pass (one per
+   distinct launch size) uses a new epoch, and epochs newer than
+   'visit_epoch_base' were assigned during the current jitc_eval() call. */
+static uint32_t visit_epoch = 0;
+static uint32_t visit_epoch_base = 0;
+
+/// Explicit stack used by jitc_var_traverse()
+struct TraverseFrame {
+    Variable *v;
+    uint32_t index;
+    uint32_t dep_pos;
+    const uint32_t *extra_dep;
+    uint32_t extra_n_dep;
+};
+static std::vector<TraverseFrame> traverse_stack;
+
+/// Roots of the traversal, sorted by size in jitc_eval()
+static std::vector<ScheduledVariable> traverse_roots;
+
+/// A variable that jitc_eval_auto() could evaluate at a checkpoint
+struct AutoEvalCandidate {
+    uint32_t index;
+    uint32_t ops;
+    size_t bytes;
+};
+static std::vector<AutoEvalCandidate> auto_eval_candidates;
+static std::vector<uint32_t> auto_eval_stack;
+
+/// Number of references to a variable from other unevaluated variables
+static tsl::robin_map<uint32_t, uint32_t, UInt32Hasher> auto_eval_refs;
+
+/// Value numbering across scopes and aliases found by jitc_assemble_simplify()
+static LVNMap cse_map;
+static tsl::robin_map<uint32_t, uint32_t, UInt32Hasher> cse_alias;
 
 /// Kernel parameter buffer and device copy
 static std::vector<void *> kernel_params;
@@ -46,6 +80,69 @@ StringBuffer globals { 1000 };
 /// Temporary scratch space for scheduled tasks (LLVM only)
 static std::vector<Task *> scheduled_tasks;
 
+/// An LLVM kernel whose compilation and launch were deferred by jitc_eval()
+struct PendingKernel {
+    ScheduledGroup group { 0, 0, 0 };
+
+    /// Copy of the kernel IR (moves to the kernel cache if it verifies keys)
+    char *source = nullptr;
+    uint32_t source_size = 0;
+
+    /// Hash, name and callables of the kernel
+    XXH128_hash_t hash { 0, 0 };
+    char name[52] { };
+    std::vector<XXH128_hash_t> callables;
+
+    /// Copy of the kernel parameter array
+    std::vector<void *> params;
+
+    /// Number of IR operations (used to choose the work unit size)
+    uint32_t n_ops = 0;
+
+    /// Launch information for the kernel history
+    KernelHistoryEntry history { };
+
+    /// The compiled kernel
+    Kernel kernel { };
+
+    /// Was the kernel found in the in-memory cache (1) or on disk (2)?
+    int cached = 0;
+
+    /// Time (us) spent loading or compiling the kernel
+    float compile_time = 0.f;
+
+    /// Optimization level passed to jitc_llvm_compile()
+    int opt_level = 2;
+
+    /// Compilation task, if the kernel was not found in any cache
+    Task *task = nullptr;
+
+    /// Index of an earlier entry with the same IR whose kernel is reused
+    int shared = -1;
+};
+
+/// Kernels that are compiled in parallel during the current jitc_eval() call
+static std::vector<PendingKernel> pending_kernels;
+
+/// Background recompilation of a tier-0 LLVM kernel (JitFlag::TieredCompile)
+struct TierUpJob {
+    char *source = nullptr;
+    uint32_t source_size = 0;
+    XXH128_hash_t hash { 0, 0 };
+    char name[52] { };
+    std::vector<XXH128_hash_t> callables;
+    Kernel kernel { };
+    Task *task = nullptr;
+    std::atomic<bool> done { false };
+};
+
+/// Recompilations that are in progress (protected by 'state.lock')
+static std::vector<TierUpJob *> tier_up_jobs;
+
+/// Replaced tier-0 kernels, which queued launches may still reference. They
+/// are released when the LLVM backend becomes idle, see jitc_sync_thread()
+static std::vector<Kernel> tier_up_retired;
+
 /// Hash code of the last generated kernel
 XXH128_hash_t kernel_hash { 0, 0 };
 
@@ -76,38 +173,323 @@ KernelHistoryEntry kernel_history_entry;
 
 // ====================================================================
 
-/// Recursively traverse the computation graph to find variables needed by a computation
-static void jitc_var_traverse(uint32_t size, uint32_t index) {
-    if (!visited.emplace(size, index).second)
-        return;
+/// Begin a traversal that will consist of up to 'n_passes' passes
+static void jitc_var_traverse_begin(size_t n_passes) {
+    if (unlikely((size_t) visit_epoch + n_passes >= 0xFFFFFFFFu)) {
+        // Epoch counter overflow, clear all marks
+        state.variables.for_each([](uint32_t, Variable &v) {
+            jitc_var_scratch(&v).visit_epoch = 0;
+        });
+        visit_epoch = 0;
+    }
+    visit_epoch_base = visit_epoch;
+}
 
+/// Start a new traversal pass. Variables may be scheduled once per pass.
+static void jitc_var_traverse_pass() { visit_epoch++; }
+
+/// Mark a variable as visited. Returns 'false' if it was already visited in this pass
+static bool jitc_var_traverse_visit(Variable *v) {
+    VariableScratch &vs = jitc_var_scratch(v);
+    if (vs.visit_epoch == visit_epoch)
+        return false;
+
+    // If we're really visiting this variable the first time, no matter its size
+    if (vs.visit_epoch <= visit_epoch_base)
+        vs.output_flag = false;
+
+    vs.visit_epoch = visit_epoch;
+    return true;
+}
+
+/// Traverse the computation graph to find variables needed by a computation
+static void jitc_var_traverse(size_t size, uint32_t index) {
     Variable *v = jitc_var(index);
-    for (int i = 0; i < 4; ++i) {
-        uint32_t index2 = v->dep[i];
-        if (index2 == 0)
-            break;
-        jitc_var_traverse(size, index2);
-    }
+    if (!jitc_var_traverse_visit(v))
+        return;
 
-    if (unlikely(v->extra)) {
-        auto it = state.extra.find(index);
-        if (it == state.extra.end())
-            jitc_fail("jit_var_traverse(): could not find matching 'extra' record!");
+    // Depth-first search using an explicit stack (graphs can be very deep)
+    traverse_stack.push_back(TraverseFrame{ v, index, 0, nullptr, 0 });
 
-        const Extra &extra = it->second;
-        for (uint32_t i = 0; i < extra.n_dep; ++i) {
-            uint32_t index2 = extra.dep[i];
+    while (!traverse_stack.empty()) {
+        TraverseFrame &f = traverse_stack.back();
+        uint32_t index2 = 0;
+
+        // Find the next dependency that has not been visited yet
+        while (f.dep_pos < 4) {
+            index2 = f.v->dep[f.dep_pos++];
+            if (index2 == 0) {
+                f.dep_pos = 4;
+                break;
+            }
+            Variable *v2 = jitc_var(index2);
+            if (jitc_var_traverse_visit(v2))
+                break;
+            index2 = 0;
+        }
+
+        if (!index2 && f.dep_pos == 4 && unlikely(f.v->extra)) {
+            auto it = state.extra.find(f.index);
+            if (it == state.extra.end())
+                jitc_fail("jit_var_traverse(): could not find matching 'extra' record!");
+
+            f.extra_dep = it->second.dep;
+            f.extra_n_dep = it->second.n_dep;
+            f.dep_pos++;
+        }
+
+        while (!index2 && f.dep_pos > 4 && f.dep_pos - 5 < f.extra_n_dep) {
+            index2 = f.extra_dep[f.dep_pos++ - 5];
             if (index2 == 0)
                 continue;
-            jitc_var_traverse(size, index2);
+            Variable *v2 = jitc_var(index2);
+            if (!jitc_var_traverse_visit(v2))
+                index2 = 0;
+        }
+
+        if (index2) {
+            traverse_stack.push_back(
+                TraverseFrame{ jitc_var(index2), index2, 0, nullptr, 0 });
+        } else {
+            // All dependencies have been scheduled
+            schedule.emplace_back(size, f.v->scope, f.index);
+            traverse_stack.pop_back();
         }
     }
+}
 
-    // If we're really visiting this variable the first time, no matter its size
-    if (visited.emplace(0, index).second)
-        v->output_flag = false;
+/// Can jitc_assemble_simplify() merge 'v' with an equivalent variable?
+static bool jitc_cse_eligible(const Variable *v) {
+    if (v->placeholder || v->side_effect || v->extra || v->write_ptr)
+        return false;
+
+    VarKind kind = (VarKind) v->kind;
+    if (kind == VarKind::Literal)
+        return (VarType) v->type != VarType::Pointer;
+
+    // Pure operations only (no memory accesses or calls)
+    return (kind >= VarKind::Neg && kind <= VarKind::Bitcast) ||
+           kind == VarKind::Counter || kind == VarKind::DefaultMask;
+}
+
+/// Return the variable that computes the value of 'index' (see jitc_assemble_simplify())
+static uint32_t jitc_cse_resolve(uint32_t index) {
+    auto it = cse_alias.find(index);
+    return it != cse_alias.end() ? it.value() : index;
+}
+
+/**
+ * \brief Remove redundant work from a kernel before it is assembled
+ *
+ * Value numbering at variable creation time (\c state.lvn_map) only merges
+ * variables in the same scope. This pass additionally merges pure operations
+ * with identical operands in different scopes (scopes separate side effects,
+ * which don't influence such operations). A merged variable reuses the
+ * register of its equivalent, see \ref jitc_assemble(). Variables with
+ * control flow (loops, calls) end the range of merging, since the equivalent
+ * might not dominate all uses afterwards.
+ *
+ * Variables that are no longer used by anything in the kernel are then
+ * removed as well. Eliminated variables are moved behind the end of the
+ * group, and the function returns their count.
+ *
+ * The pass tracks the number of uses of each variable in 'reg_index', which
+ * is assigned afterwards by jitc_assemble().
+ */
+static uint32_t jitc_assemble_simplify(ScheduledGroup &group) {
+    const uint32_t eliminated = 0xFFFFFFFFu;
+
+    cse_map.clear();
+    cse_alias.clear();
+
+    // Merge equivalent operations
+    for (uint32_t i = group.start; i != group.end; ++i) {
+        uint32_t index = schedule[i].index;
+        Variable *v = jitc_var(index);
+        VariableScratch &vs = jitc_var_scratch(v);
+        vs.reg_index = 0;
+
+        if (v->extra || v->is_stmt()) {
+            cse_map.clear();
+            continue;
+        }
+
+        if (!jitc_cse_eligible(v))
+            continue;
+
+        VariableKey key(*v);
+        key.scope = 0;
+        for (int j = 0; j < 4; ++j)
+            key.dep[j] = jitc_cse_resolve(key.dep[j]);
+
+        auto [it, inserted] = cse_map.try_emplace(key, index);
+        if (!inserted && !vs.output_flag) {
+            cse_alias[index] = it.value();
+            vs.reg_index = eliminated;
+        }
+    }
+
+    // Count the uses of the remaining variables
+    auto use = [](uint32_t index, int amount) {
+        if (!index)
+            return;
+        VariableScratch &vs = jitc_var_scratch(jitc_var(jitc_cse_resolve(index)));
+        vs.reg_index = (uint32_t) ((int) vs.reg_index + amount);
+    };
+
+    auto use_deps = [&use](uint32_t index, const Variable *v, int amount) {
+        for (int j = 0; j < 4; ++j)
+            use(v->dep[j], amount);
+
+        if (unlikely(v->extra)) {
+            const Extra &extra = state.extra[index];
+            for (uint32_t j = 0; j < extra.n_dep; ++j)
+                use(extra.dep[j], amount);
+        }
+    };
+
+    for (uint32_t i = group.start; i != group.end; ++i) {
+        uint32_t index = schedule[i].index;
+        const Variable *v = jitc_var(index);
+        if (jitc_var_scratch(v).reg_index != eliminated)
+            use_deps(index, v, 1);
+    }
+
+    // Remove unused variables (in reverse, which also removes their operands)
+    uint32_t n_eliminated = (uint32_t) cse_alias.size();
+    for (uint32_t i = group.end; i != group.start; --i) {
+        uint32_t index = schedule[i - 1].index;
+        const Variable *v = jitc_var(index);
+        VariableScratch &vs = jitc_var_scratch(v);
+
+        if (vs.reg_index != 0 || vs.output_flag ||
+            !(jitc_cse_eligible(v) || v->is_data()))
+            continue;
+
+        vs.reg_index = eliminated;
+        use_deps(index, v, -1);
+        n_eliminated++;
+    }
+
+    if (n_eliminated) {
+        auto end = std::stable_partition(
+            schedule.begin() + group.start, schedule.begin() + group.end,
+            [eliminated](const ScheduledVariable &sv) {
+                return jitc_var_scratch(jitc_var(sv.index)).reg_index != eliminated;
+            });
+        group.end = (uint32_t) (end - schedule.begin());
+    }
+
+    return n_eliminated;
+}
+
+/// Can jitc_assemble_hoist() pass the literal 'v' via the parameter array?
+static bool jitc_hoist_eligible(const Variable *v) {
+    if (!v->is_literal() || jitc_var_scratch(v).output_flag)
+        return false;
 
-    schedule.emplace_back(size, v->scope, index);
+    VarType vt = (VarType) v->type;
+    return vt == VarType::Int32 || vt == VarType::UInt32 ||
+           vt == VarType::Int64 || vt == VarType::UInt64 ||
+           vt == VarType::Float32 || vt == VarType::Float64;
+}
+
+/// Forget the least recently used half of 'state.literal_history'
+static void jitc_literal_history_trim() {
+    std::vector<uint64_t> last_use;
+    last_use.reserve(state.literal_history.size());
+    for (auto &kv : state.literal_history)
+        last_use.push_back(kv.second.last_use);
+
+    auto median = last_use.begin() + last_use.size() / 2;
+    std::nth_element(last_use.begin(), median, last_use.end());
+    uint64_t threshold = *median;
+
+    for (auto it = state.literal_history.begin();
+         it != state.literal_history.end();) {
+        if (it->second.last_use <= threshold)
+            it = state.literal_history.erase(it);
+        else
+            ++it;
+    }
+}
+
+/**
+ * \brief Select the literals that are passed via the parameter array
+ *
+ * Each literal is identified by a hash of the kernel's structure (which
+ * excludes the value of eligible literals and data pointers) and by its
+ * position in the kernel. Its history in \c state.literal_history counts
+ * how often the value changed between launches. Literals that reached the
+ * threshold of \ref jit_set_literal_hoisting() are marked by setting their
+ * 'param_type' to \c ParamType::Input, which makes the kernel text
+ * independent of their value. Returns the number of marked literals.
+ *
+ * The function stores the position of variables in 'reg_index', which is
+ * assigned afterwards by jitc_assemble().
+ */
+static uint32_t jitc_assemble_hoist(JitBackend backend,
+                                    const ScheduledGroup &group) {
+    size_t shape = (size_t) backend;
+    hash_combine(shape, group.size == 1);
+
+    for (uint32_t i = group.start; i != group.end; ++i) {
+        const Variable *v = jitc_var(schedule[i].index);
+        VariableScratch &vs = jitc_var_scratch(v);
+        vs.reg_index = i - group.start;
+        vs.param_type = ParamType::Register;
+
+        uint64_t key[6] = { 0 };
+        key[0] = (uint64_t) v->kind | ((uint64_t) v->type << 8) |
+                 ((uint64_t) (v->size == 1) << 16) |
+                 ((uint64_t) vs.output_flag << 17) |
+                 ((uint64_t) (v->extra != 0) << 18);
+
+        if (v->is_stmt())
+            key[1] = (uint64_t) hash(v->stmt, strlen(v->stmt));
+        else if (v->is_literal() && !jitc_hoist_eligible(v) &&
+                 (VarType) v->type != VarType::Pointer)
+            key[1] = v->literal;
+
+        for (int j = 0; j < 4; ++j) {
+            uint32_t dep = jitc_cse_resolve(v->dep[j]);
+            if (dep)
+                key[2 + j] = jitc_var_scratch(jitc_var(dep)).reg_index + 1;
+        }
+
+        shape = hash(key, sizeof(key), shape);
+    }
+
+    uint32_t n_hoisted = 0;
+    for (uint32_t i = group.start; i != group.end; ++i) {
+        const Variable *v = jitc_var(schedule[i].index);
+        if (!jitc_hoist_eligible(v))
+            continue;
+
+        size_t key = shape;
+        hash_combine(key, i - group.start);
+
+        auto [it, inserted] = state.literal_history.try_emplace(
+            (uint64_t) key, LiteralHistory{ v->literal, 0, 0 });
+        LiteralHistory &lh = it.value();
+        lh.last_use = state.kernel_launches;
+
+        if (!inserted && lh.value != v->literal) {
+            lh.value = v->literal;
+            if (lh.changes != 0xFFFFFFFFu)
+                lh.changes++;
+        }
+
+        if (lh.changes >= state.literal_hoisting) {
+            jitc_var_scratch(v).param_type = ParamType::Input;
+            n_hoisted++;
+        }
+    }
+
+    if (state.literal_history.size() > DRJIT_LITERAL_HISTORY_MAX)
+        jitc_literal_history_trim();
+
+    return n_hoisted;
 }
 
 void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
@@ -132,21 +514,26 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
              n_regs         = 0;
 
     if (backend == JitBackend::CUDA) {
-        uintptr_t size = 0;
-        memcpy(&size, &group.size, sizeof(uint32_t));
-        kernel_params.push_back((void *) size);
+        // CUDA kernels take a 32-bit size (checked when creating the arrays)
+        kernel_params.push_back((void *) (uintptr_t) (uint32_t) group.size);
 
         // The first 3 variables are reserved on the CUDA backend
         n_regs = 4;
     } else {
-        // First 3 parameters reserved for: kernel ptr, size, ITT identifier
-        for (int i = 0; i < 3; ++i)
+        // First 4 parameters reserved for: kernel ptr, size, block size, profile
+        for (int i = 0; i < 4; ++i)
             kernel_params.push_back(nullptr);
         n_regs = 1;
     }
 
     (void) timer();
 
+    uint32_t n_eliminated = jitc_assemble_simplify(group),
+             n_hoisted = 0;
+
+    if (state.literal_hoisting)
+        n_hoisted = jitc_assemble_hoist(backend, group);
+
     for (uint32_t group_index = group.start; group_index != group.end; ++group_index) {
         ScheduledVariable &sv = schedule[group_index];
         uint32_t index = sv.index;
@@ -159,23 +546,28 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
             jitc_fail("jit_assemble(): schedule contains unreferenced variable r%u!", index);
         if (unlikely(v->size != 1 && v->size != group.size))
             jitc_fail("jit_assemble(): schedule contains variable r%u with incompatible size "
-                     "(%u and %u)!", index, v->size, group.size);
+                     "(%zu and %zu)!", index, v->size, group.size);
         if (unlikely(v->is_dirty()))
             jitc_fail("jit_assemble(): dirty variable r%u encountered!", index);
 
-        v->param_offset = (uint32_t) kernel_params.size() * sizeof(void *);
-        v->reg_index = n_regs++;
+        VariableScratch &vs = jitc_var_scratch(v);
+        bool hoisted = n_hoisted && v->is_literal() &&
+                       vs.param_type == ParamType::Input;
+        vs.param_offset = (uint32_t) kernel_params.size() * sizeof(void *);
+        vs.reg_index = n_regs++;
 
         if (v->is_data()) {
             n_params_in++;
-            v->param_type = ParamType::Input;
+            vs.param_type = ParamType::Input;
             kernel_params.push_back(v->data);
-        } else if (v->output_flag && v->size == group.size) {
+        } else if (vs.output_flag &&
+                   (v->size == group.size ||
+                    (v->size == 1 && group.scalar_outputs))) {
             n_params_out++;
-            v->param_type = ParamType::Output;
+            vs.param_type = ParamType::Output;
 
             size_t isize = (size_t) type_size[v->type],
-                   dsize = (size_t) group.size * isize;
+                   dsize = v->size * isize;
 
             // Padding to support out-of-bounds accesses in LLVM gather operations
             if (backend == JitBackend::LLVM && isize < 4)
@@ -187,14 +579,14 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
                 dsize); // Note: unsafe to access 'v' after jitc_malloc().
 
             kernel_params.push_back(sv.data);
-        } else if (v->is_literal() && (VarType) v->type == VarType::Pointer) {
+        } else if (v->is_literal() && ((VarType) v->type == VarType::Pointer || hoisted)) {
             n_params_in++;
-            v->param_type = ParamType::Input;
+            vs.param_type = ParamType::Input;
             kernel_params.push_back((void *) v->literal);
         } else {
             n_side_effects += (uint32_t) v->side_effect;
-            v->param_type = ParamType::Register;
-            v->param_offset = 0xFFFF;
+            vs.param_type = ParamType::Register;
+            vs.param_offset = 0xFFFF;
 
             #if defined(DRJIT_ENABLE_OPTIX)
                 uses_optix |= v->optix;
@@ -202,6 +594,21 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
         }
     }
 
+    // Merged variables reuse the register of their equivalent
+    for (auto &kv : cse_alias) {
+        VariableScratch &vs = jitc_var_scratch(jitc_var(kv.first));
+        vs.reg_index = jitc_var_scratch(jitc_var(kv.second)).reg_index;
+        vs.param_type = ParamType::Register;
+    }
+
+    if (n_eliminated)
+        jitc_log(Debug, "jit_assemble(): eliminated %u redundant operation%s.",
+                 n_eliminated, n_eliminated == 1 ? "" : "s");
+
+    if (n_hoisted)
+        jitc_log(Debug, "jit_assemble(): passing %u literal%s via the parameter array.",
+                 n_hoisted, n_hoisted == 1 ? "" : "s");
+
     if (unlikely(n_regs > 0xFFFFF))
         jitc_log(Warn,
                  "jit_run(): The generated kernel uses a more than 1 million "
@@ -241,26 +648,27 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
             uint32_t index = schedule[group_index].index;
             Variable *v = jitc_var(index);
 
+            const VariableScratch &vs = jitc_var_scratch(v);
             buffer.fmt("   - %s%u -> r%u: ", type_prefix[v->type],
-                       v->reg_index, index);
+                       vs.reg_index, index);
 
             const char *label = jitc_var_label(index);
             if (label)
                 buffer.fmt("label=\"%s\", ", label);
-            if (v->param_type == ParamType::Input)
-                buffer.fmt("in, offset=%u, ", v->param_offset);
-            if (v->param_type == ParamType::Output)
-                buffer.fmt("out, offset=%u, ", v->param_offset);
+            if (vs.param_type == ParamType::Input)
+                buffer.fmt("in, offset=%u, ", vs.param_offset);
+            if (vs.param_type == ParamType::Output)
+                buffer.fmt("out, offset=%u, ", vs.param_offset);
             if (v->is_literal())
                 buffer.put("literal, ");
-            if (v->size == 1 && v->param_type != ParamType::Output)
+            if (v->size == 1 && vs.param_type != ParamType::Output)
                 buffer.put("scalar, ");
             if (v->side_effect)
                 buffer.put("side effects, ");
             buffer.rewind_to(buffer.size() - 2);
             buffer.put('\n');
         }
-        jitc_trace("jit_assemble(size=%u): register map:\n%s",
+        jitc_trace("jit_assemble(size=%zu): register map:\n%s",
                   group.size, buffer.get());
     }
 
@@ -294,13 +702,13 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
 
     if (n_side_effects)
         jitc_log(
-            Info, "  -> launching %016llx (%sn=%u, in=%u, out=%u, se=%u, ops=%u, jit=%s):",
+            Info, "  -> launching %016llx (%sn=%zu, in=%u, out=%u, se=%u, ops=%u, jit=%s):",
             (unsigned long long) kernel_hash.high64,
             uses_optix ? "via OptiX, " : "", group.size, n_params_in,
             n_params_out, n_side_effects, n_ops_total, jitc_time_string(codegen_time));
     else
         jitc_log(
-            Info, "  -> launching %016llx (%sn=%u, in=%u, out=%u, ops=%u, jit=%s):",
+            Info, "  -> launching %016llx (%sn=%zu, in=%u, out=%u, ops=%u, jit=%s):",
             (unsigned long long) kernel_hash.high64,
             uses_optix ? "via OptiX, " : "", group.size, n_params_in,
             n_params_out, n_ops_total, jitc_time_string(codegen_time));
@@ -317,6 +725,7 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
         kernel_history_entry.input_count = n_params_in;
         kernel_history_entry.output_count = n_params_out + n_side_effects;
         kernel_history_entry.operation_count = n_ops_total;
+        kernel_history_entry.eliminated_count = n_eliminated;
         kernel_history_entry.codegen_time = codegen_time * 1e-3f;
     }
 }
@@ -324,6 +733,320 @@ void jitc_assemble(ThreadState *ts, ScheduledGroup group) {
 static ProfilerRegion profiler_region_backend_compile("jit_eval: compiling");
 static ProfilerRegion profiler_region_backend_load("jit_eval: loading");
 
+/// Return the callables referenced by the last assembled kernel (LLVM)
+static void jitc_llvm_callables(std::vector<XXH128_hash_t> &callables) {
+    callables.clear();
+    if (!callable_count_unique)
+        return;
+
+    for (auto const &kv: globals_map) {
+        if (kv.first.callable)
+            callables.push_back(kv.first.hash);
+    }
+}
+
+/**
+ * \brief Count a launch of the last assembled kernel and submit its
+ * recompilation at full optimization once it becomes hot
+ *
+ * Only affects tier-0 kernels, see \c JitFlag::TieredCompile.
+ */
+static void jitc_llvm_tier_up_count(Kernel &kernel) {
+    if (kernel.llvm.tier != 0 || kernel.llvm.launches == (uint32_t) -1)
+        return;
+
+    if (++kernel.llvm.launches < jitc_llvm_tier_threshold)
+        return;
+
+    // Don't submit another recompilation for this kernel
+    kernel.llvm.launches = (uint32_t) -1;
+
+    TierUpJob *job = new TierUpJob();
+    job->source_size = (uint32_t) buffer.size();
+    job->source = (char *) malloc_check(buffer.size() + 1);
+    memcpy(job->source, buffer.get(), buffer.size() + 1);
+    job->hash = kernel_hash;
+    memcpy(job->name, kernel_name, sizeof(kernel_name));
+    jitc_llvm_callables(job->callables);
+
+    auto compile = [](uint32_t, void *payload) {
+        TierUpJob *job2 = *(TierUpJob **) payload;
+        try {
+            jitc_llvm_compile(job2->source, job2->source_size, job2->name,
+                              job2->callables, job2->kernel, 3);
+        } catch (...) {
+            // Keep using the tier-0 kernel
+            job2->kernel.data = nullptr;
+        }
+        job2->done.store(true, std::memory_order_release);
+    };
+
+    job->task = task_submit_dep(nullptr, nullptr, 0, 1, compile, &job,
+                                (uint32_t) sizeof(TierUpJob *), nullptr,
+                                1 /* async */);
+    tier_up_jobs.push_back(job);
+}
+
+/// Install the kernels of finished recompilations into the kernel cache
+static void jitc_llvm_tier_up_poll() {
+    size_t j = 0;
+    for (TierUpJob *job : tier_up_jobs) {
+        if (!job->done.load(std::memory_order_acquire)) {
+            tier_up_jobs[j++] = job;
+            continue;
+        }
+
+        task_wait_and_release(job->task);
+
+        if (job->kernel.data) {
+            auto it = state.kernel_cache.find(
+                KernelKey(job->hash, nullptr, -1, 0),
+                KernelHash::compute_hash(job->hash.high64, -1, 0));
+
+            if (it != state.kernel_cache.end() && it.value().llvm.tier == 0) {
+                jitc_log(Debug, "jit_eval(): kernel %s recompiled at full "
+                                "optimization (%s).", job->name,
+                         std::string(jitc_mem_string(job->kernel.size)).c_str());
+                // Without queued launches, the old kernel can be freed right away
+                if (jitc_task)
+                    tier_up_retired.push_back(it.value());
+                else
+                    jitc_kernel_free(-1, it.value());
+                state.kernel_cache_size += job->kernel.size;
+                state.kernel_cache_size -= it.value().size;
+                job->kernel.last_use = it.value().last_use;
+                it.value() = job->kernel;
+                jitc_kernel_write_async(job->source, job->source_size,
+                                        JitBackend::LLVM, job->hash, job->kernel);
+            } else {
+                jitc_kernel_free(-1, job->kernel);
+            }
+        }
+
+        free(job->source);
+        delete job;
+    }
+    tier_up_jobs.resize(j);
+}
+
+void jitc_llvm_tier_up_flush() {
+    for (TierUpJob *job : tier_up_jobs) {
+        try {
+            task_wait_and_release(job->task);
+        } catch (...) { }
+        if (job->kernel.data)
+            jitc_kernel_free(-1, job->kernel);
+        free(job->source);
+        delete job;
+    }
+    tier_up_jobs.clear();
+
+    jitc_llvm_tier_up_release();
+}
+
+void jitc_llvm_tier_up_release() {
+    for (const Kernel &kernel : tier_up_retired)
+        jitc_kernel_free(-1, kernel);
+    tier_up_retired.clear();
+}
+
+/**
+ * \brief Register a freshly compiled or loaded kernel in the in-memory cache
+ *
+ * If another kernel with the same key was inserted in the meantime, the new
+ * one (and the key's copy of the source) is released. Returns the kernel
+ * that is stored in the cache.
+ */
+static Kernel jitc_kernel_insert(KernelKey key, const Kernel &kernel,
+                                 bool cache_hit, float link_time,
+                                 KernelHistoryEntry &entry) {
+    jitc_log(Info, "     cache %s, %s: %s, %s.",
+            cache_hit ? "hit" : "miss",
+            cache_hit ? "load" : "build",
+            std::string(jitc_time_string(link_time)).c_str(),
+            std::string(jitc_mem_string(kernel.size)).c_str());
+
+    auto [it, inserted] = state.kernel_cache.emplace(key, kernel);
+    Kernel &cached = it.value();
+    cached.last_use = state.kernel_launches;
+
+    if (inserted) {
+        state.kernel_cache_size += kernel.size;
+    } else {
+        jitc_kernel_free(key.device, kernel);
+        free(key.str);
+    }
+
+    if (cache_hit)
+        state.kernel_soft_misses++;
+    else
+        state.kernel_hard_misses++;
+
+    if (unlikely(jit_flag(JitFlag::KernelHistory))) {
+        entry.cache_disk = cache_hit;
+        entry.cache_hit = cache_hit;
+        if (!cache_hit)
+            entry.backend_time = link_time * 1e-3f;
+    }
+
+    return cached;
+}
+
+/**
+ * \brief Choose the number of elements per work unit of an LLVM kernel
+ *
+ * Work units should take roughly DRJIT_POOL_BLOCK_TIME to amortize the task
+ * overhead. The cost per element is initially estimated from the number of
+ * IR operations and later replaced by the execution time measured on the
+ * first work unit of earlier launches. Large launches are further split into
+ * at least 4 work units per worker thread to balance the load.
+ */
+static size_t jitc_llvm_block_size(const Kernel &kernel, size_t size,
+                                   uint32_t n_ops) {
+    uint32_t pool_size = ::pool_size();
+    if (pool_size <= 1 || size <= DRJIT_POOL_BLOCK_SIZE_MIN)
+        return std::max(size, (size_t) 1);
+
+    // Estimated cost (ns) per element
+    double cost = DRJIT_POOL_OP_COST * std::max(n_ops, 1u);
+
+    LLVMKernelProfile *profile = kernel.llvm.profile;
+    if (profile) {
+        uint64_t time     = profile->time.load(std::memory_order_relaxed),
+                 elements = profile->elements.load(std::memory_order_relaxed);
+
+        if (elements >= DRJIT_POOL_BLOCK_SIZE_MIN)
+            cost = std::max((double) time / (double) elements, 1e-3);
+
+        // Exponentially decay old measurements
+        if (elements >= ((uint64_t) 1 << 32)) {
+            profile->time.store(time / 2, std::memory_order_relaxed);
+            profile->elements.store(elements / 2, std::memory_order_relaxed);
+        }
+    }
+
+    double block_size = DRJIT_POOL_BLOCK_TIME / cost;
+    block_size = std::min(block_size, (double) size / (4.0 * pool_size));
+    block_size = std::max(block_size, (double) DRJIT_POOL_BLOCK_SIZE_MIN);
+    block_size = std::min(block_size, (double) DRJIT_POOL_BLOCK_SIZE_MAX);
+
+    // Round down to a power of two (a multiple of the vector width)
+    size_t result = (size_t) 1 << (log2i_ceil((uint32_t) block_size + 1) - 1);
+
+    // The thread pool supports at most 2^32-1 work units
+    if (unlikely(size / result >= 0xFFFFFFFF))
+        result = round_pow2(size / 0xFFFFFFFF + 1);
+
+    return result;
+}
+
+/// Submit a compiled LLVM kernel to the thread pool
+static Task *jitc_run_llvm(const Kernel &kernel, size_t size, uint32_t n_ops,
+                           std::vector<void *> &params) {
+    size_t packets =
+        (size + jitc_llvm_vector_width - 1) / jitc_llvm_vector_width;
+
+    auto callback = [](uint32_t index, void *ptr) {
+        void **params = (void **) ptr;
+        LLVMKernelFunction kernel = (LLVMKernelFunction) params[0];
+        LLVMKernelProfile *profile = (LLVMKernelProfile *) params[3];
+        uint64_t size       = (uint64_t) (uintptr_t) params[1],
+                 block_size = (uint64_t) (uintptr_t) params[2],
+                 start      = index * block_size,
+                 end        = std::min(start + block_size, size);
+
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+        // Signal start of kernel
+        __itt_task_begin(drjit_domain, __itt_null, __itt_null,
+                         (__itt_string_handle *) profile->itt);
+#endif
+
+        // Measure the first work unit to refine the work unit size
+        if (index == 0 && profile) {
+            auto t0 = std::chrono::steady_clock::now();
+            kernel(start, end, params);
+            auto t1 = std::chrono::steady_clock::now();
+            uint64_t ns = (uint64_t)
+                std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+            profile->time.fetch_add(ns, std::memory_order_relaxed);
+            profile->elements.fetch_add(end - start, std::memory_order_relaxed);
+        } else {
+            // Perform the main computation
+            kernel(start, end, params);
+        }
+
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+        // Signal termination of kernel
+        __itt_task_end(drjit_domain);
+#endif
+    };
+
+    size_t block_size = jitc_llvm_block_size(kernel, size, n_ops);
+    uint32_t blocks = (uint32_t) ((size + block_size - 1) / block_size);
+
+    params[0] = (void *) kernel.llvm.reloc[0];
+    params[1] = (void *) (uintptr_t) size;
+    params[2] = (void *) (uintptr_t) block_size;
+    params[3] = (void *) kernel.llvm.profile;
+
+    jitc_trace("jit_run(): scheduling %zu packet%s in %u block%s of size %zu ..",
+               packets, packets == 1 ? "" : "s", blocks,
+               blocks == 1 ? "" : "s", block_size);
+    (void) packets; // jitc_trace may be disabled
+
+    Task *task = task_submit_dep(
+        nullptr, &jitc_task, 1, blocks,
+        callback, params.data(),
+        (uint32_t) (params.size() * sizeof(void *)),
+        nullptr
+    );
+
+    if (unlikely(jit_flag(JitFlag::LaunchBlocking)))
+        task_wait(task);
+
+    return task;
+}
+
+/// Load a compiled PTX kernel into the current CUDA context
+void jitc_cuda_link(XXH128_hash_t hash, Kernel &kernel) {
+    CUresult ret = (CUresult) 0;
+    /* Unlock while synchronizing */ {
+        unlock_guard guard(state.lock);
+        ret = cuModuleLoadData(&kernel.cuda.mod, kernel.data);
+    }
+    if (ret == CUDA_ERROR_OUT_OF_MEMORY) {
+        jitc_flush_malloc_cache(true);
+        /* Unlock while synchronizing */ {
+            unlock_guard guard(state.lock);
+            ret = cuModuleLoadData(&kernel.cuda.mod, kernel.data);
+        }
+    }
+    cuda_check(ret);
+
+    // Locate the kernel entry point
+    char name[39];
+    snprintf(name, sizeof(name), "drjit_%016llx%016llx",
+             (unsigned long long) hash.high64, (unsigned long long) hash.low64);
+    cuda_check(cuModuleGetFunction(&kernel.cuda.func, kernel.cuda.mod, name));
+
+    // Determine a suitable thread count to maximize occupancy
+    int unused, block_size;
+    cuda_check(cuOccupancyMaxPotentialBlockSize(
+        &unused, &block_size,
+        kernel.cuda.func, nullptr, 0, 0));
+    kernel.cuda.block_size = (uint32_t) block_size;
+
+    // DrJit doesn't use shared memory at all, prefer to have more L1 cache.
+    cuda_check(cuFuncSetAttribute(
+        kernel.cuda.func, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, 0));
+    cuda_check(cuFuncSetAttribute(
+        kernel.cuda.func, CU_FUNC_ATTRIBUTE_PREFERRED_SHARED_MEMORY_CARVEOUT,
+        CU_SHAREDMEM_CARVEOUT_MAX_L1));
+
+    free(kernel.data);
+    kernel.data = nullptr;
+}
+
 Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
     uint64_t flags = 0;
 
@@ -339,7 +1062,9 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
     }
 #endif
 
-    KernelKey kernel_key((char *) buffer.get(), ts->device, flags);
+    bool verify = jit_flag(JitFlag::KernelCacheVerify);
+    KernelKey kernel_key(kernel_hash, verify ? (char *) buffer.get() : nullptr,
+                         ts->device, flags);
     auto it = state.kernel_cache.find(
         kernel_key,
         KernelHash::compute_hash(kernel_hash.high64, ts->device, flags));
@@ -367,12 +1092,18 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
 #endif
                 }
             } else {
-                jitc_llvm_compile(kernel);
+                std::vector<XXH128_hash_t> callables;
+                jitc_llvm_callables(callables);
+                jitc_llvm_compile(buffer.get(), buffer.size(), kernel_name,
+                                  callables, kernel,
+                                  jit_flag(JitFlag::TieredCompile) ? 1 : 2);
             }
 
-            if (kernel.data)
-                jitc_kernel_write(buffer.get(), (uint32_t) buffer.size(),
-                                  ts->backend, kernel_hash, kernel);
+            // Tier-0 kernels are only written to disk once recompiled
+            if (kernel.data &&
+                (ts->backend == JitBackend::CUDA || kernel.llvm.tier))
+                jitc_kernel_write_async(buffer.get(), (uint32_t) buffer.size(),
+                                        ts->backend, kernel_hash, kernel);
         }
 
         ProfilerPhase profiler(profiler_region_backend_load);
@@ -380,75 +1111,29 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
         if (ts->backend == JitBackend::LLVM) {
             jitc_llvm_disasm(kernel);
         } else if (!uses_optix) {
-            CUresult ret = (CUresult) 0;
-            /* Unlock while synchronizing */ {
-                unlock_guard guard(state.lock);
-                ret = cuModuleLoadData(&kernel.cuda.mod, kernel.data);
-            }
-            if (ret == CUDA_ERROR_OUT_OF_MEMORY) {
-                jitc_flush_malloc_cache(true);
-                /* Unlock while synchronizing */ {
-                    unlock_guard guard(state.lock);
-                    ret = cuModuleLoadData(&kernel.cuda.mod, kernel.data);
-                }
-            }
-            cuda_check(ret);
-
-            // Locate the kernel entry point
-            size_t offset = buffer.size();
-            buffer.fmt_cuda(2, "drjit_$Q$Q", kernel_hash.high64,
-                            kernel_hash.low64);
-            cuda_check(cuModuleGetFunction(&kernel.cuda.func, kernel.cuda.mod,
-                                           buffer.get() + offset));
-            buffer.rewind_to(offset);
-
-            // Determine a suitable thread count to maximize occupancy
-            int unused, block_size;
-            cuda_check(cuOccupancyMaxPotentialBlockSize(
-                &unused, &block_size,
-                kernel.cuda.func, nullptr, 0, 0));
-            kernel.cuda.block_size = (uint32_t) block_size;
-
-            // DrJit doesn't use shared memory at all, prefer to have more L1 cache.
-            cuda_check(cuFuncSetAttribute(
-                kernel.cuda.func, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, 0));
-            cuda_check(cuFuncSetAttribute(
-                kernel.cuda.func, CU_FUNC_ATTRIBUTE_PREFERRED_SHARED_MEMORY_CARVEOUT,
-                CU_SHAREDMEM_CARVEOUT_MAX_L1));
-
-            free(kernel.data);
-            kernel.data = nullptr;
+            jitc_cuda_link(kernel_hash, kernel);
         }
 
         float link_time = timer();
-        jitc_log(Info, "     cache %s, %s: %s, %s.",
-                cache_hit ? "hit" : "miss",
-                cache_hit ? "load" : "build",
-                std::string(jitc_time_string(link_time)).c_str(),
-                std::string(jitc_mem_string(kernel.size)).c_str());
-
-        kernel_key.str = (char *) malloc_check(buffer.size() + 1);
-        memcpy(kernel_key.str, buffer.get(), buffer.size() + 1);
-        state.kernel_cache.emplace(kernel_key, kernel);
-
-        if (cache_hit)
-            state.kernel_soft_misses++;
-        else
-            state.kernel_hard_misses++;
-
-        if (unlikely(jit_flag(JitFlag::KernelHistory))) {
-            kernel_history_entry.cache_disk = cache_hit;
-            kernel_history_entry.cache_hit = cache_hit;
-            if (!cache_hit)
-                kernel_history_entry.backend_time = link_time * 1e-3f;
+        if (verify) {
+            kernel_key.str = (char *) malloc_check(buffer.size() + 1);
+            memcpy(kernel_key.str, buffer.get(), buffer.size() + 1);
         }
+        kernel = jitc_kernel_insert(kernel_key, kernel, cache_hit, link_time,
+                                    kernel_history_entry);
     } else {
         kernel_history_entry.cache_hit = true;
+        if (ts->backend == JitBackend::LLVM)
+            jitc_llvm_tier_up_count(it.value());
+        it.value().last_use = state.kernel_launches;
         kernel = it.value();
         state.kernel_hits++;
     }
     state.kernel_launches++;
 
+    if (ts->backend == JitBackend::LLVM)
+        kernel_history_entry.tier = kernel.llvm.tier;
+
     if (unlikely(jit_flag(JitFlag::KernelHistory) &&
                  ts->backend == JitBackend::CUDA)) {
         auto &e = kernel_history_entry;
@@ -461,7 +1146,7 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
     if (ts->backend == JitBackend::CUDA) {
 #if defined(DRJIT_ENABLE_OPTIX)
         if (unlikely(uses_optix))
-            jitc_optix_launch(ts, kernel, group.size, kernel_params_global,
+            jitc_optix_launch(ts, kernel, (uint32_t) group.size, kernel_params_global,
                               kernel_param_count);
 #endif
 
@@ -476,7 +1161,7 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
                 CU_LAUNCH_PARAM_END
             };
 
-            uint32_t block_count, thread_count, size = group.size;
+            uint32_t block_count, thread_count, size = (uint32_t) group.size;
             const Device &device = state.devices[ts->device];
             device.get_launch_config(&block_count, &thread_count, size,
                                      (uint32_t) kernel.cuda.block_size);
@@ -489,56 +1174,7 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
         if (unlikely(jit_flag(JitFlag::LaunchBlocking)))
             cuda_check(cuStreamSynchronize(ts->stream));
     } else {
-        uint32_t packets =
-            (group.size + jitc_llvm_vector_width - 1) / jitc_llvm_vector_width;
-
-        auto callback = [](uint32_t index, void *ptr) {
-            void **params = (void **) ptr;
-            LLVMKernelFunction kernel = (LLVMKernelFunction) params[0];
-            uint32_t size       = (uint32_t) (uintptr_t) params[1],
-                     block_size = (uint32_t) ((uintptr_t) params[1] >> 32),
-                     start      = index * block_size,
-                     end        = std::min(start + block_size, size);
-
-#if defined(DRJIT_ENABLE_ITTNOTIFY)
-            // Signal start of kernel
-            __itt_task_begin(drjit_domain, __itt_null, __itt_null,
-                             (__itt_string_handle *) params[2]);
-#endif
-            // Perform the main computation
-            kernel(start, end, params);
-
-#if defined(DRJIT_ENABLE_ITTNOTIFY)
-            // Signal termination of kernel
-            __itt_task_end(drjit_domain);
-#endif
-        };
-
-        uint32_t block_size = DRJIT_POOL_BLOCK_SIZE,
-                 blocks = (group.size + block_size - 1) / block_size;
-
-        kernel_params[0] = (void *) kernel.llvm.reloc[0];
-        kernel_params[1] = (void *) ((((uintptr_t) block_size) << 32) +
-                                     (uintptr_t) group.size);
-
-#if defined(DRJIT_ENABLE_ITTNOTIFY)
-        kernel_params[2] = kernel.llvm.itt;
-#endif
-
-        jitc_trace("jit_run(): scheduling %u packet%s in %u block%s ..",
-                   packets, packets == 1 ? "" : "s", blocks,
-                   blocks == 1 ? "" : "s");
-        (void) packets; // jitc_trace may be disabled
-
-        ret_task = task_submit_dep(
-            nullptr, &jitc_task, 1, blocks,
-            callback, kernel_params.data(),
-            (uint32_t) (kernel_params.size() * sizeof(void *)),
-            nullptr
-        );
-
-        if (unlikely(jit_flag(JitFlag::LaunchBlocking)))
-            task_wait(ret_task);
+        ret_task = jitc_run_llvm(kernel, group.size, n_ops_total, kernel_params);
     }
 
     if (unlikely(jit_flag(JitFlag::KernelHistory))) {
@@ -556,13 +1192,227 @@ Task *jitc_run(ThreadState *ts, ScheduledGroup group) {
     return ret_task;
 }
 
+/**
+ * \brief Variant of jitc_run() that compiles cache misses on the thread pool
+ * (LLVM only)
+ *
+ * The kernel is looked up in the in-memory and disk caches. If neither
+ * contains it, a task compiling the kernel is submitted to the thread pool.
+ * The launch is deferred until \ref jitc_run_pending(), which preserves the
+ * order in which the kernels of an evaluation are launched.
+ */
+static void jitc_run_deferred(ThreadState *ts, ScheduledGroup group) {
+    bool verify = jit_flag(JitFlag::KernelCacheVerify);
+    KernelKey kernel_key(kernel_hash, verify ? (char *) buffer.get() : nullptr,
+                         ts->device, 0);
+    auto it = state.kernel_cache.find(
+        kernel_key, KernelHash::compute_hash(kernel_hash.high64, ts->device, 0));
+
+    bool cached = it != state.kernel_cache.end();
+    if (cached && pending_kernels.empty()) {
+        // Nothing to wait for, launch right away
+        scheduled_tasks.push_back(jitc_run(ts, group));
+        return;
+    }
+
+    PendingKernel &pk = pending_kernels.emplace_back();
+    pk.group = group;
+    pk.hash = kernel_hash;
+    memcpy(pk.name, kernel_name, sizeof(kernel_name));
+    pk.params = kernel_params;
+    pk.n_ops = n_ops_total;
+    pk.history = kernel_history_entry;
+    jitc_llvm_callables(pk.callables);
+
+    if (cached) {
+        jitc_llvm_tier_up_count(it.value());
+        it.value().last_use = state.kernel_launches;
+        pk.kernel = it.value();
+        pk.cached = 1;
+        return;
+    }
+
+    // Reuse the kernel of an earlier group with the same IR (e.g. other size)
+    for (size_t i = 0; i + 1 < pending_kernels.size(); ++i) {
+        const PendingKernel &other = pending_kernels[i];
+        if (other.cached != 1 && other.shared < 0 &&
+            other.hash.high64 == pk.hash.high64 &&
+            other.hash.low64 == pk.hash.low64 &&
+            (!verify || strcmp(other.source, buffer.get()) == 0)) {
+            pk.shared = (int) i;
+            pk.cached = 1;
+            return;
+        }
+    }
+
+    pk.source_size = (uint32_t) buffer.size();
+    pk.source = (char *) malloc_check(buffer.size() + 1);
+    memcpy(pk.source, buffer.get(), buffer.size() + 1);
+
+    if (jitc_kernel_load(pk.source, pk.source_size, ts->backend, pk.hash,
+                         pk.kernel)) {
+        pk.cached = 2;
+        pk.compile_time = timer();
+        return;
+    }
+
+    pk.opt_level = jit_flag(JitFlag::TieredCompile) ? 1 : 2;
+
+    auto compile = [](uint32_t, void *payload) {
+        PendingKernel *pk2 = *(PendingKernel **) payload;
+        auto start = std::chrono::steady_clock::now();
+        jitc_llvm_compile(pk2->source, pk2->source_size, pk2->name,
+                          pk2->callables, pk2->kernel, pk2->opt_level);
+        pk2->compile_time = std::chrono::duration<float, std::micro>(
+            std::chrono::steady_clock::now() - start).count();
+    };
+
+    PendingKernel *payload = &pk;
+    pk.task = task_submit_dep(nullptr, nullptr, 0, 1, compile, &payload,
+                              (uint32_t) sizeof(PendingKernel *), nullptr,
+                              1 /* async */);
+}
+
+/// Wait for the kernels compiled by jitc_run_deferred() and launch them
+static void jitc_run_pending(ThreadState *ts) {
+    size_t i = 0;
+    try {
+        for (; i < pending_kernels.size(); ++i) {
+            PendingKernel &pk = pending_kernels[i];
+
+            // The earlier entry was already compiled and inserted
+            if (pk.shared >= 0)
+                pk.kernel = pending_kernels[pk.shared].kernel;
+
+            if (pk.task) {
+                ProfilerPhase profiler(profiler_region_backend_compile);
+                Task *task = pk.task;
+                pk.task = nullptr;
+                task_wait_and_release(task);
+                if (pk.kernel.llvm.tier)
+                    jitc_kernel_write_async(pk.source, pk.source_size,
+                                            ts->backend, pk.hash, pk.kernel);
+            }
+
+            if (pk.cached == 1) {
+                pk.history.cache_hit = true;
+                state.kernel_hits++;
+            } else {
+                ProfilerPhase profiler(profiler_region_backend_load);
+                jitc_llvm_disasm(pk.kernel);
+                bool verify = jit_flag(JitFlag::KernelCacheVerify);
+                char *source = verify ? pk.source : nullptr;
+                if (!verify)
+                    free(pk.source);
+                pk.source = nullptr;
+                pk.kernel = jitc_kernel_insert(
+                    KernelKey(pk.hash, source, ts->device, 0), pk.kernel,
+                    pk.cached == 2, pk.compile_time, pk.history);
+            }
+            state.kernel_launches++;
+            pk.history.tier = pk.kernel.llvm.tier;
+
+            Task *task = jitc_run_llvm(pk.kernel, pk.group.size, pk.n_ops,
+                                       pk.params);
+
+            if (unlikely(jit_flag(JitFlag::KernelHistory))) {
+                task_retain(task);
+                pk.history.task = task;
+                state.kernel_history.append(pk.history);
+            }
+
+            scheduled_tasks.push_back(task);
+        }
+    } catch (...) {
+        // Don't leave compilation tasks behind that reference 'pending_kernels'
+        for (; i < pending_kernels.size(); ++i) {
+            PendingKernel &pk = pending_kernels[i];
+            if (pk.task) {
+                try {
+                    task_wait_and_release(pk.task);
+                } catch (...) { }
+            }
+            if (pk.cached != 1 && pk.kernel.data)
+                jitc_kernel_free(ts->device, pk.kernel);
+            free(pk.history.ir);
+            free(pk.source);
+        }
+        pending_kernels.clear();
+        throw;
+    }
+
+    pending_kernels.clear();
+}
+
 static ProfilerRegion profiler_region_eval("jit_eval");
 
+/**
+ * Scalar outputs are often evaluated along with larger arrays (e.g., a
+ * reduction along with its input). Instead of launching a separate kernel
+ * for them, and on the LLVM backend a barrier task joining both kernels, this
+ * function merges the group of size 1 into the smallest other group. This
+ * requires recomputing the scalar variables in every thread/packet, hence it
+ * is only done when there are few of them and they have no side effects.
+ */
+static void jitc_eval_fuse_scalars() {
+    size_t n_groups = schedule_groups.size();
+    if (n_groups < 2 || schedule_groups[n_groups - 1].size != 1)
+        return;
+
+    ScheduledGroup &target = schedule_groups[n_groups - 2],
+                   &scalar = schedule_groups[n_groups - 1];
+
+    // Mark variables that are already computed by the target group
+    jitc_var_traverse_pass();
+    for (uint32_t i = target.start; i != target.end; ++i)
+        jitc_var_scratch(jitc_var(schedule[i].index)).visit_epoch = visit_epoch;
+
+    uint32_t n_ops = 0;
+    for (uint32_t i = scalar.start; i != scalar.end; ++i) {
+        const Variable *v = jitc_var(schedule[i].index);
+        if (v->side_effect)
+            return;
+        if (jitc_var_scratch(v).visit_epoch == visit_epoch)
+            continue;
+
+        /* Complex operations and lane-dependent values can't be recomputed.
+           This includes legacy statements, which may read the lane index */
+        if (v->extra || v->is_stmt() || (VarKind) v->kind == VarKind::Counter ||
+            ++n_ops > DRJIT_EVAL_FUSE_SCALAR_OPS)
+            return;
+    }
+
+    // Move the remaining scalar variables into the target group
+    uint32_t end = target.end;
+    for (uint32_t i = scalar.start; i != scalar.end; ++i) {
+        const ScheduledVariable &sv = schedule[i];
+        if (jitc_var_scratch(jitc_var(sv.index)).visit_epoch != visit_epoch)
+            schedule[end++] = sv;
+    }
+
+    schedule.erase(schedule.begin() + end, schedule.end());
+    target.end = end;
+    target.scalar_outputs = true;
+
+    std::stable_sort(schedule.begin() + target.start, schedule.end(),
+                     [](const ScheduledVariable &a, const ScheduledVariable &b) {
+                         return a.scope < b.scope;
+                     });
+
+    jitc_log(Debug,
+             "jit_eval(): recomputing %u scalar operation%s in the kernel of "
+             "size %zu.", n_ops, n_ops == 1 ? "" : "s", target.size);
+
+    schedule_groups.pop_back();
+}
+
 /// Evaluate all computation that is queued on the given ThreadState
 void jitc_eval(ThreadState *ts) {
     if (!ts || (ts->scheduled.empty() && ts->side_effects.empty()))
         return;
 
+    ts->auto_eval_ops = 0;
+
     ProfilerPhase profiler(profiler_region_eval);
 
     /* The function 'jitc_eval()' modifies several global data structures
@@ -577,33 +1427,61 @@ void jitc_eval(ThreadState *ts) {
     lock_guard guard(state.eval_lock);
     lock_acquire(state.lock);
 
+    // Swap in kernels that were recompiled at full optimization
+    if (!tier_up_jobs.empty())
+        jitc_llvm_tier_up_poll();
+
+    // Enforce the budget of the in-memory kernel cache
+    if (state.kernel_cache_limit_size || state.kernel_cache_limit_count)
+        jitc_kernel_cache_trim();
+
+    // Release chunks of the variable table that only hold a few survivors
+    if (!state.variables.sparse_chunks.empty())
+        state.variables.compact();
+
     jitc_var_loop_simplify();
 
-    visited.clear();
     schedule.clear();
+    traverse_roots.clear();
 
-    // Collect variables that must be computed along with their dependencies
+    // Collect variables that must be computed
     for (int j = 0; j < 2; ++j) {
         auto &source = j == 0 ? ts->scheduled : ts->side_effects;
         for (size_t i = 0; i < source.size(); ++i) {
             uint32_t index = source[i];
-            auto it = state.variables.find(index);
-            if (it == state.variables.end())
+            Variable *v = state.variables.find(index);
+            if (!v)
                 continue;
 
-            Variable *v = &it.value();
-
             // Skip variables that are already evaluated
             if (v->is_data())
                 continue;
 
-            jitc_var_traverse(v->size, index);
-            v->output_flag = (VarType) v->type != VarType::Void;
+            traverse_roots.emplace_back(v->size, v->scope, index);
         }
 
         source.clear();
     }
 
+    /* Visit roots of the same size in one pass. This does not change the
+       order of the schedule within groups of the same size (see below). */
+    std::stable_sort(traverse_roots.begin(), traverse_roots.end(),
+                     [](const ScheduledVariable &a, const ScheduledVariable &b) {
+                         return a.size > b.size;
+                     });
+
+    // .. and find their dependencies
+    jitc_var_traverse_begin(traverse_roots.size() + 1);
+    for (size_t i = 0; i < traverse_roots.size(); ++i) {
+        const ScheduledVariable &root = traverse_roots[i];
+        if (i == 0 || root.size != traverse_roots[i - 1].size)
+            jitc_var_traverse_pass();
+
+        jitc_var_traverse(root.size, root.index);
+        Variable *v = jitc_var(root.index);
+        jitc_var_scratch(v).output_flag = (VarType) v->type != VarType::Void;
+    }
+
     if (schedule.empty())
         return;
 
@@ -641,6 +1519,8 @@ void jitc_eval(ThreadState *ts) {
                                      cur, (uint32_t) schedule.size());
     }
 
+    jitc_eval_fuse_scalars();
+
     jitc_log(Info, "jit_eval(): launching %zu kernel%s.",
             schedule_groups.size(),
             schedule_groups.size() == 1 ? "" : "s");
@@ -648,10 +1528,22 @@ void jitc_eval(ThreadState *ts) {
     scoped_set_context_maybe guard2(ts->context);
     scheduled_tasks.clear();
 
+    /* When several kernels are generated, compile cache misses in parallel
+       instead of blocking in jitc_llvm_compile() before the next kernel
+       can even be assembled */
+    bool parallel_compile = ts->backend == JitBackend::LLVM &&
+                            schedule_groups.size() > 1 &&
+                            jit_flag(JitFlag::ParallelCompile);
+    if (parallel_compile)
+        pending_kernels.reserve(schedule_groups.size());
+
     for (ScheduledGroup &group : schedule_groups) {
         jitc_assemble(ts, group);
 
-        scheduled_tasks.push_back(jitc_run(ts, group));
+        if (parallel_compile)
+            jitc_run_deferred(ts, group);
+        else
+            scheduled_tasks.push_back(jitc_run(ts, group));
 
         if (ts->backend == JitBackend::CUDA) {
             jitc_free(kernel_params_global);
@@ -659,8 +1551,12 @@ void jitc_eval(ThreadState *ts) {
         }
     }
 
+    if (!pending_kernels.empty())
+        jitc_run_pending(ts);
+
     if (ts->backend == JitBackend::LLVM) {
         if (scheduled_tasks.size() == 1) {
+            // A single kernel, no barrier task needed
             task_release(jitc_task);
             jitc_task = scheduled_tasks[0];
         } else {
@@ -684,13 +1580,12 @@ void jitc_eval(ThreadState *ts) {
     for (ScheduledVariable sv : schedule) {
         uint32_t index = sv.index;
 
-        auto it = state.variables.find(index);
-        if (it == state.variables.end())
+        Variable *v = state.variables.find(index);
+        if (!v)
             continue;
 
-        Variable *v = &it.value();
-        v->reg_index = 0;
-        if (!(v->output_flag || v->side_effect))
+        jitc_var_scratch(v).reg_index = 0;
+        if (!(jitc_var_scratch(v).output_flag || v->side_effect))
             continue;
 
         if (unlikely(v->is_literal()))
@@ -705,10 +1600,10 @@ void jitc_eval(ThreadState *ts) {
             v->free_stmt = false;
         }
 
-        if (v->output_flag && v->size == sv.size) {
+        if (jitc_var_scratch(v).output_flag && sv.data) {
             v->kind = (uint32_t) VarKind::Data;
             v->data = sv.data;
-            v->output_flag = false;
+            jitc_var_scratch(v).output_flag = false;
             v->consumed = false;
         }
 
@@ -746,6 +1641,186 @@ void jitc_eval(ThreadState *ts) {
     jitc_log(Info, "jit_eval(): done.");
 }
 
+/**
+ * \brief Count the unevaluated operations that variable \c index depends on
+ *
+ * Marks visited variables with the current epoch and skips variables that
+ * carry the epoch \c skip. Stops early once more than \c limit operations
+ * were found.
+ */
+static uint32_t jitc_var_count_ops(uint32_t index, uint32_t skip, uint32_t limit) {
+    auto visit = [skip](uint32_t index2) {
+        if (!index2)
+            return false;
+        const Variable *v = jitc_var(index2);
+        VariableScratch &vs = jitc_var_scratch(v);
+        if (v->is_data() || v->is_literal() || vs.visit_epoch == visit_epoch ||
+            vs.visit_epoch == skip)
+            return false;
+        vs.visit_epoch = visit_epoch;
+        return true;
+    };
+
+    if (!visit(index))
+        return 0;
+
+    uint32_t n_ops = 0;
+    auto_eval_stack.clear();
+    auto_eval_stack.push_back(index);
+
+    while (!auto_eval_stack.empty() && n_ops <= limit) {
+        uint32_t index2 = auto_eval_stack.back();
+        auto_eval_stack.pop_back();
+        n_ops++;
+
+        const Variable *v = jitc_var(index2);
+        for (int i = 0; i < 4; ++i) {
+            if (visit(v->dep[i]))
+                auto_eval_stack.push_back(v->dep[i]);
+        }
+
+        if (unlikely(v->extra)) {
+            const Extra &extra = state.extra[index2];
+            for (uint32_t i = 0; i < extra.n_dep; ++i) {
+                if (visit(extra.dep[i]))
+                    auto_eval_stack.push_back(extra.dep[i]);
+            }
+        }
+    }
+
+    return n_ops;
+}
+
+/**
+ * Evaluation checkpoint for traced programs that grow very large, which is
+ * triggered by jitc_var_check() when more than 'state.auto_eval_budget'
+ * operations were traced since the last evaluation (see
+ * jit_set_auto_eval_budget()).
+ *
+ * The cut points are chosen among the unevaluated variables that are still
+ * referenced from outside of the graph (by the program, or by queued side
+ * effects), since the rest of the graph is only reachable through them.
+ * Evaluating a variable materializes 'size * type_size' bytes, while keeping
+ * it symbolic retains the operations it depends on. The function keeps the
+ * variables with the most bytes per operation symbolic as long as at most
+ * half of the budget remains unevaluated, and evaluates the others.
+ */
+void jitc_eval_auto(ThreadState *ts) {
+    if (jitc_flags() & (uint32_t) JitFlag::Recording)
+        return;
+
+    uint32_t budget = state.auto_eval_budget,
+             limit = budget / 2,
+             n_ops = 0,
+             n_kept = 0,
+             n_eval = 0;
+    size_t n_bytes = 0;
+
+    {
+        lock_release(state.lock);
+        lock_guard guard(state.eval_lock);
+        lock_acquire(state.lock);
+
+        auto_eval_refs.clear();
+        auto_eval_candidates.clear();
+
+        // Count references between unevaluated variables
+        state.variables.for_each([ts](uint32_t index, const Variable &v) {
+            if ((JitBackend) v.backend != ts->backend || v.is_data() ||
+                v.is_literal())
+                return;
+
+            for (int i = 0; i < 4; ++i) {
+                if (v.dep[i])
+                    auto_eval_refs[v.dep[i]]++;
+            }
+
+            if (unlikely(v.extra)) {
+                const Extra &extra = state.extra[index];
+                for (uint32_t i = 0; i < extra.n_dep; ++i) {
+                    if (extra.dep[i])
+                        auto_eval_refs[extra.dep[i]]++;
+                }
+            }
+        });
+
+        // Externally referenced variables are candidates for evaluation
+        state.variables.for_each([ts](uint32_t index, const Variable &v) {
+            if ((JitBackend) v.backend != ts->backend || v.is_data() ||
+                v.is_literal() || v.placeholder || v.consumed ||
+                v.write_ptr || v.vcall_iface ||
+                (VarType) v.type == VarType::Void ||
+                (VarType) v.type == VarType::Pointer)
+                return;
+
+            auto it = auto_eval_refs.find(index);
+            if (it != auto_eval_refs.end() && it.value() >= v.ref_count)
+                return;
+
+            auto_eval_candidates.push_back(AutoEvalCandidate{
+                index, 0, v.size * (size_t) type_size[v.type] });
+        });
+
+        /* Attribute each operation to the first candidate (in order of
+           creation) that depends on it, which gives an estimate of the
+           operations removed by evaluating it */
+        jitc_var_traverse_begin(auto_eval_candidates.size() + 2);
+        jitc_var_traverse_pass();
+        for (AutoEvalCandidate &c : auto_eval_candidates) {
+            c.ops = jitc_var_count_ops(c.index, visit_epoch, 0xFFFFFFFFu);
+            n_ops += c.ops;
+        }
+
+        if (n_ops > budget) {
+            // Prefer keeping variables that are expensive to store
+            std::stable_sort(
+                auto_eval_candidates.begin(), auto_eval_candidates.end(),
+                [](const AutoEvalCandidate &a, const AutoEvalCandidate &b) {
+                    return (double) a.bytes * b.ops > (double) b.bytes * a.ops;
+                });
+
+            jitc_var_traverse_pass();
+            uint32_t epoch_kept = visit_epoch;
+
+            for (const AutoEvalCandidate &c : auto_eval_candidates) {
+                // Count operations that are not yet kept symbolic by others
+                jitc_var_traverse_pass();
+                uint32_t n = jitc_var_count_ops(c.index, epoch_kept, limit - n_kept);
+
+                if (n_kept + n <= limit) {
+                    // Re-mark these operations as kept
+                    uint32_t epoch = visit_epoch;
+                    visit_epoch = epoch_kept;
+                    jitc_var_count_ops(c.index, epoch_kept, 0xFFFFFFFFu);
+                    visit_epoch = epoch;
+                    n_kept += n;
+                } else {
+                    ts->scheduled.push_back(c.index);
+                    n_bytes += c.bytes;
+                    n_eval++;
+                }
+            }
+        }
+    }
+
+    if (n_ops <= budget) {
+        /* Operations were freed in the meantime, no checkpoint needed. Wait
+           for at least budget / 2 new operations before checking again, so
+           that a graph that stays close to the budget is not scanned after
+           every operation */
+        ts->auto_eval_ops = std::min(n_ops, budget - budget / 2);
+        return;
+    }
+
+    jitc_log(Info,
+             "jit_eval(): automatic checkpoint after %u operations, evaluating "
+             "%u variable%s (%zu bytes), %u operations remain symbolic.",
+             n_ops, n_eval, n_eval == 1 ? "" : "s", n_bytes, n_kept);
+
+    jitc_eval(ts);
+    ts->auto_eval_ops = n_kept;
+}
+
 static ProfilerRegion profiler_region_assemble_func("jit_assemble_func");
 
 XXH128_hash_t
@@ -758,8 +1833,9 @@ jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
                    const uint32_t *se, bool use_self) {
     ProfilerPhase profiler(profiler_region_assemble_func);
 
-    visited.clear();
     schedule.clear();
+    jitc_var_traverse_begin(1);
+    jitc_var_traverse_pass();
 
     for (uint32_t i = 0; i < n_in; ++i) {
         if (in[i] == 0)
@@ -767,7 +1843,7 @@ jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
 
         const Variable *v = jitc_var(in[i]);
         if (!v->is_literal())
-            visited.emplace(1, in[i]);
+            jitc_var_scratch(v).visit_epoch = visit_epoch;
     }
 
     auto traverse = [](uint32_t index) {
@@ -775,7 +1851,7 @@ jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
             return;
         jitc_var_traverse(1, index);
         Variable *v = jitc_var(index);
-        v->output_flag = (VarType) v->type != VarType::Void;
+        jitc_var_scratch(v).output_flag = (VarType) v->type != VarType::Void;
     };
 
     for (uint32_t i = 0; i < n_out; ++i)
@@ -794,7 +1870,7 @@ jitc_assemble_func(ThreadState *ts, const char *name, uint32_t inst_id,
 
     for (auto &sv : schedule) {
         Variable *v = jitc_var(sv.index);
-        v->reg_index = n_regs++;
+        jitc_var_scratch(v).reg_index = n_regs++;
     }
 
     size_t kernel_offset = buffer.size();
@@ -15,23 +15,26 @@
 
 /// A single variable that is scheduled to execute for a launch with 'size' entries
 struct ScheduledVariable {
-    uint32_t size;
+    size_t size;
     uint32_t index;
     uint32_t scope;
     void *data;
 
-    ScheduledVariable(uint32_t size, uint32_t scope, uint32_t index)
+    ScheduledVariable(size_t size, uint32_t scope, uint32_t index)
         : size(size), index(index), scope(scope), data(nullptr) { }
 };
 
 /// Start and end index of a group of variables that will be merged into the same kernel
 struct ScheduledGroup {
-    uint32_t size;
+    size_t size;
     uint32_t start;
     uint32_t end;
 
-    ScheduledGroup(uint32_t size, uint32_t start, uint32_t end)
-        : size(size), start(start), end(end) { }
+    /// Does the kernel also write outputs of size 1? (see jitc_eval())
+    bool scalar_outputs;
+
+    ScheduledGroup(size_t size, uint32_t start, uint32_t end)
+        : size(size), start(start), end(end), scalar_outputs(false) { }
 };
 
 struct GlobalKey {
@@ -100,6 +103,12 @@ extern std::vector<ScheduledGroup> schedule_groups;
 /// Evaluate all computation that is queued on the current thread
 extern void jitc_eval(ThreadState *ts);
 
+/// Evaluate part of a traced graph that exceeds the budget of jit_set_auto_eval_budget()
+extern void jitc_eval_auto(ThreadState *ts);
+
+/// Load a compiled PTX kernel into the current CUDA context
+extern void jitc_cuda_link(XXH128_hash_t hash, Kernel &kernel);
+
 /// Used by jitc_eval() to generate PTX source code
 extern void jitc_cuda_assemble(ThreadState *ts, ScheduledGroup group,
                                uint32_t n_regs, uint32_t n_params);
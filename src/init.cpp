@@ -52,12 +52,12 @@ __itt_domain *drjit_domain = __itt_domain_create("drjit");
 #endif
 
 static_assert(
-    sizeof(VariableKey) == 9 * sizeof(uint32_t),
+    sizeof(VariableKey) == 10 * sizeof(uint32_t),
     "VariableKey: incorrect size, likely an issue with padding/packing!");
 
 static_assert(
-    sizeof(tsl::detail_robin_hash::bucket_entry<VariableMap::value_type, false>) == 64,
-    "VariableMap: incorrect bucket size, likely an issue with padding/packing!");
+    sizeof(Variable) == 48,
+    "Variable: incorrect size, likely an issue with padding/packing!");
 
 static ProfilerRegion profiler_region_init("jit_init");
 
@@ -65,6 +65,58 @@ static ProfilerRegion profiler_region_init("jit_init");
 extern float timer_frequency_scale;
 #endif
 
+/// Set the directory of the on-disk kernel cache, create it if needed
+void jitc_set_cache_dir(const char *path) {
+#if !defined(_WIN32)
+    struct stat st = {};
+    int rv = stat(path, &st);
+    size_t temp_path_size = (strlen(path) + 1) * sizeof(char);
+    char *temp_path = (char*) malloc(temp_path_size);
+    memcpy(temp_path, path, temp_path_size);
+#else
+    wchar_t temp_path_w[512];
+    size_t len = mbstowcs(temp_path_w, path, sizeof(temp_path_w) / sizeof(wchar_t));
+    if (len == (size_t) -1 || len == sizeof(temp_path_w) / sizeof(wchar_t))
+        jitc_raise("jit_kernel_cache_set_dir(): invalid path \"%s\"!", path);
+    struct _stat st = {};
+    int rv = _wstat(temp_path_w, &st);
+    size_t temp_path_size = (wcslen(temp_path_w) + 1) * sizeof(wchar_t);
+    wchar_t *temp_path = (wchar_t*) malloc(temp_path_size);
+    memcpy(temp_path, temp_path_w, temp_path_size);
+#endif
+
+    if (rv == -1) {
+        jitc_log(Info, "jit_init(): creating directory \"%s\" ..", path);
+#if !defined(_WIN32)
+        if (mkdir(path, 0700) == -1) {
+#else
+        if (_wmkdir(temp_path_w) == -1) {
+#endif
+            free(temp_path);
+            jitc_raise("jit_init(): creation of directory \"%s\" failed: %s",
+                       path, strerror(errno));
+        }
+    }
+
+    // Finish pending writes and close the cache at the previous location
+    jitc_kernel_write_flush();
+    jitc_kernel_cache_set_path(temp_path);
+}
+
+/// Return the directory of the on-disk kernel cache
+const char *jitc_cache_dir() {
+    if (!jitc_temp_path)
+        return nullptr;
+#if !defined(_WIN32)
+    return jitc_temp_path;
+#else
+    static char path[512];
+    if (wcstombs(path, jitc_temp_path, sizeof(path)) >= sizeof(path))
+        jitc_raise("jit_kernel_cache_dir(): path is too long!");
+    return path;
+#endif
+}
+
 /// Initialize core data structures of the JIT compiler
 void jitc_init(uint32_t backends) {
     ProfilerPhase profiler(profiler_region_init);
@@ -83,37 +135,27 @@ void jitc_init(uint32_t backends) {
     if ((backends & ~state.backends) == 0)
         return;
 
+    // The environment variable DRJIT_CACHE_DIR overrides the default location
+    if (!jitc_temp_path) {
+        const char *cache_dir = getenv("DRJIT_CACHE_DIR");
+        char temp_path[512];
 #if !defined(_WIN32)
-    char temp_path[512];
-    snprintf(temp_path, sizeof(temp_path), "%s/.drjit", getenv("HOME"));
-    struct stat st = {};
-    int rv = stat(temp_path, &st);
-    size_t temp_path_size = (strlen(temp_path) + 1) * sizeof(char);
-    jitc_temp_path = (char*) malloc(temp_path_size);
-    memcpy(jitc_temp_path, temp_path, temp_path_size);
+        if (cache_dir && *cache_dir)
+            snprintf(temp_path, sizeof(temp_path), "%s", cache_dir);
+        else
+            snprintf(temp_path, sizeof(temp_path), "%s/.drjit", getenv("HOME"));
 #else
-    wchar_t temp_path_w[512];
-    char temp_path[512];
-    if (GetTempPathW(sizeof(temp_path_w) / sizeof(wchar_t), temp_path_w) == 0)
-        jitc_fail("jit_init(): could not obtain path to temporary directory!");
-    wcsncat(temp_path_w, L"drjit", sizeof(temp_path) / sizeof(wchar_t));
-    struct _stat st = {};
-    int rv = _wstat(temp_path_w, &st);
-    size_t temp_path_size = (wcslen(temp_path_w) + 1) * sizeof(wchar_t);
-    jitc_temp_path = (wchar_t*) malloc(temp_path_size);
-    memcpy(jitc_temp_path, temp_path_w, temp_path_size);
-    wcstombs(temp_path, temp_path_w, sizeof(temp_path));
-#endif
-
-    if (rv == -1) {
-        jitc_log(Info, "jit_init(): creating directory \"%s\" ..", temp_path);
-#if !defined(_WIN32)
-        if (mkdir(temp_path, 0700) == -1)
-#else
-        if (_wmkdir(temp_path_w) == -1)
+        if (cache_dir && *cache_dir) {
+            snprintf(temp_path, sizeof(temp_path), "%s", cache_dir);
+        } else {
+            wchar_t temp_path_w[512];
+            if (GetTempPathW(sizeof(temp_path_w) / sizeof(wchar_t), temp_path_w) == 0)
+                jitc_fail("jit_init(): could not obtain path to temporary directory!");
+            wcsncat(temp_path_w, L"drjit", sizeof(temp_path) / sizeof(wchar_t));
+            wcstombs(temp_path, temp_path_w, sizeof(temp_path));
+        }
 #endif
-            jitc_fail("jit_init(): creation of directory \"%s\" failed: %s",
-                temp_path, strerror(errno));
+        jitc_set_cache_dir(temp_path);
     }
 
     // Enumerate CUDA devices and collect suitable ones
@@ -133,6 +175,7 @@ void jitc_init(uint32_t backends) {
 
     state.kernel_hard_misses = state.kernel_soft_misses = 0;
     state.kernel_hits = state.kernel_launches = 0;
+    state.kernel_evictions = 0;
 }
 
 void* jitc_cuda_stream() {
@@ -175,6 +218,8 @@ void jitc_shutdown(int light) {
         }
     }
 
+    jitc_llvm_tier_up_flush();
+
     if (!state.kernel_cache.empty()) {
         jitc_log(Info, "jit_shutdown(): releasing %zu kernel%s ..",
                 state.kernel_cache.size(),
@@ -186,9 +231,13 @@ void jitc_shutdown(int light) {
         }
 
         state.kernel_cache.clear();
+        state.kernel_cache_size = 0;
     }
 
     state.kernel_history.clear();
+    state.literal_history.clear();
+    jitc_kernel_write_flush();
+    jitc_kernel_cache_shutdown();
 
     // CUDA: Try to already free some memory asynchronously (faster)
     if (thread_state_cuda && thread_state_cuda->memory_pool) {
@@ -203,12 +252,12 @@ void jitc_shutdown(int light) {
             if (type != AllocType::Device)
                 continue;
 
-            std::vector<void *> entries;
+            std::vector<AllocFree> entries;
             entries.swap(it.value());
             state.alloc_allocated[(int) type] -= size * entries.size();
 
-            for (void *ptr : entries)
-                cuda_check(cuMemFreeAsync((CUdeviceptr) ptr, ts->stream));
+            for (const AllocFree &e : entries)
+                cuda_check(cuMemFreeAsync((CUdeviceptr) e.ptr, ts->stream));
         }
     }
 
@@ -248,7 +297,7 @@ void jitc_shutdown(int light) {
         if (state.variables.empty() && !state.lvn_map.empty()) {
             for (auto &kv: state.lvn_map)
                 jitc_log(Warn,
-                        " - id=%u: size=%u, type=%s, dep=[%u, "
+                        " - id=%u: size=%zu, type=%s, dep=[%u, "
                         "%u, %u, %u]",
                         kv.second, kv.first.size, type_name[kv.first.type],
                         kv.first.dep[0], kv.first.dep[1], kv.first.dep[2],
@@ -267,28 +316,28 @@ void jitc_shutdown(int light) {
 
     if (std::max(state.log_level_stderr, state.log_level_callback) >= LogLevel::Warn) {
         uint32_t n_leaked = 0;
-        for (auto &var : state.variables) {
+        state.variables.for_each([&](uint32_t index, const Variable &v) {
             if (n_leaked == 0)
                 jitc_log(Warn, "jit_shutdown(): detected variable leaks:");
             if (n_leaked < 10)
                 jitc_log(Warn,
                          " - variable r%u is still being referenced! "
-                         "(ref=%u, ref_se=%u, type=%s, size=%u, "
+                         "(ref=%u, ref_se=%u, type=%s, size=%zu, "
                          "stmt=\"%s\", dep=[%u, %u, %u, %u])",
-                         var.first,
-                         (uint32_t) var.second.ref_count,
-                         (uint32_t) var.second.ref_count_se,
-                         type_name[var.second.type],
-                         var.second.size,
-                         var.second.is_literal()
+                         index,
+                         (uint32_t) v.ref_count,
+                         (uint32_t) v.ref_count_se,
+                         type_name[v.type],
+                         v.size,
+                         v.is_literal()
                              ? "<value>"
-                             : (var.second.stmt ? var.second.stmt : "<null>"),
-                         var.second.dep[0], var.second.dep[1],
-                         var.second.dep[2], var.second.dep[3]);
+                             : (v.stmt ? v.stmt : "<null>"),
+                         v.dep[0], v.dep[1],
+                         v.dep[2], v.dep[3]);
             else if (n_leaked == 10)
                 jitc_log(Warn, " - (skipping remainder)");
             ++n_leaked;
-        }
+        });
 
         if (n_leaked > 0)
             jitc_log(Warn, "jit_shutdown(): %u variables are still referenced!", n_leaked);
@@ -308,6 +357,10 @@ void jitc_shutdown(int light) {
         }
     }
 
+    // Release the storage of the variable table unless there are leaks
+    if (state.variables.empty())
+        state.variables.clear();
+
     jitc_registry_shutdown();
     jitc_malloc_shutdown();
 
@@ -321,8 +374,7 @@ void jitc_shutdown(int light) {
 #endif
     }
 
-    free(jitc_temp_path);
-    jitc_temp_path = nullptr;
+    jitc_kernel_cache_set_path(nullptr);
 
     state.backends = 0;
 }
@@ -464,6 +516,10 @@ void jitc_sync_thread(ThreadState *ts) {
         if (task == jitc_task) {
             jitc_task = nullptr;
             task_release(task);
+
+            // Launches are chained, hence none of them can still use a
+            // kernel that was replaced by tiered compilation
+            jitc_llvm_tier_up_release();
         }
     }
 }
@@ -15,6 +15,7 @@
 #include "llvm.h"
 #include "alloc.h"
 #include "io.h"
+#include <algorithm>
 #include <deque>
 #include <string.h>
 #include <inttypes.h>
@@ -23,6 +24,25 @@
 /// Number of entries to process per work unit in the parallel LLVM backend
 #define DRJIT_POOL_BLOCK_SIZE 16384
 
+/// Bounds of the work unit size chosen for LLVM kernels by jitc_run()
+#define DRJIT_POOL_BLOCK_SIZE_MIN 1024
+#define DRJIT_POOL_BLOCK_SIZE_MAX 1048576
+
+/// Target duration (ns) of a work unit of an LLVM kernel
+#define DRJIT_POOL_BLOCK_TIME 50000.0
+
+/// Number of entries summed directly before jitc_reduce() splits a range in half
+#define DRJIT_REDUCE_PAIRWISE_BLOCK 1024
+
+/// Max. number of literals tracked by jit_set_literal_hoisting()
+#define DRJIT_LITERAL_HISTORY_MAX 65536
+
+/// Max. number of scalar operations that jitc_eval() recomputes in a larger kernel
+#define DRJIT_EVAL_FUSE_SCALAR_OPS 32
+
+/// Initial estimate of the cost (ns) of an IR operation per array entry
+#define DRJIT_POOL_OP_COST 0.1
+
 /// Can't pass more than 4096 bytes of parameter data to a CUDA kernel
 #define DRJIT_CUDA_ARG_LIMIT 512
 
@@ -178,10 +198,7 @@ struct Variable {
     };
 
     /// Number of entries
-    uint32_t size;
-
-    /// Unused, to be eventually used to upgrade to 64 bit array sizes
-    uint32_t unused;
+    size_t size;
 
     // ================  Essential flags used in the LVN key  =================
 
@@ -223,25 +240,11 @@ struct Variable {
     /// If set, evaluation will have side effects on other variables
     uint32_t side_effect : 1;
 
-    // =========== Entries that are temporarily used in jitc_eval() ============
-
-    /// Argument type
-    uint32_t param_type : 2;
-
-    /// Is this variable marked as an output?
-    uint32_t output_flag : 1;
-
     /// Consumed bit for operations that should only be executed once
     uint32_t consumed : 1;
 
     /// Unused for now
-    uint32_t unused_2 : 5;
-
-    /// Offset of the argument in the list of kernel parameters
-    uint32_t param_offset;
-
-    /// Register index
-    uint32_t reg_index;
+    uint32_t unused_2 : 8;
 
     // ========================  Side effect tracking  =========================
 
@@ -259,7 +262,7 @@ struct Variable {
 
 /// Abbreviated version of the Variable data structure
 struct VariableKey {
-    uint32_t size;
+    size_t size;
     uint32_t scope;
     uint32_t dep[4];
     uint32_t kind      : 8;
@@ -293,7 +296,7 @@ struct VariableKey {
     }
 
     bool operator==(const VariableKey &v) const {
-        if (memcmp(this, &v, 7 * sizeof(uint32_t)) != 0)
+        if (memcmp(this, &v, 8 * sizeof(uint32_t)) != 0)
             return false;
         if ((VarKind) kind != VarKind::Stmt)
             return literal == v.literal;
@@ -317,8 +320,8 @@ struct VariableKeyHasher {
         else
             hash_1 = hash_str(k.stmt);
 
-        uint32_t buf[7];
-        size_t size = 7 * sizeof(uint32_t);
+        uint32_t buf[8];
+        size_t size = 8 * sizeof(uint32_t);
         memcpy(buf, &k, size);
         return hash(buf, size, hash_1);
     }
@@ -470,6 +473,9 @@ struct ThreadState {
     /// Identifier associated with the current basic block
     uint32_t scope = 0;
 
+    /// Number of operations traced since the last evaluation (see jitc_eval_auto())
+    uint32_t auto_eval_ops = 0;
+
     /// Registry index of the 'self' pointer of the vcall being recorded
     uint32_t vcall_self_value = 0;
 
@@ -513,30 +519,209 @@ struct ThreadState {
 #endif
 };
 
-/// Maps from variable ID to a Variable instance
-using VariableMap =
-    tsl::robin_map<uint32_t, Variable, UInt32Hasher,
-                   std::equal_to<uint32_t>,
-                   aligned_allocator<std::pair<uint32_t, Variable>, 64>,
-                   /* StoreHash = */ false>;
+/**
+ * \brief Entries of a variable that are temporarily used in jitc_eval()
+ *
+ * These are stored separately from the \ref Variable records (see \ref
+ * VariableChunk) so that graph traversal and variable creation do not pull
+ * them into the cache. Use \ref jitc_var_scratch() to access them.
+ */
+struct VariableScratch {
+    /// Register index
+    uint32_t reg_index;
+
+    /// Offset of the argument in the list of kernel parameters
+    uint32_t param_offset : 29;
+
+    /// Argument type
+    uint32_t param_type : 2;
+
+    /// Is this variable marked as an output?
+    uint32_t output_flag : 1;
+
+    /// Traversal epoch in which the variable was last visited (see eval.cpp)
+    uint32_t visit_epoch;
+};
+
+/// Number of variables per chunk of the 'VariableTable' (must be a power of two)
+#define DRJIT_VAR_CHUNK_SIZE 1024
+#define DRJIT_VAR_CHUNK_SHIFT 10
+
+/// Chunks are aligned to this boundary, see \ref jitc_var_scratch()
+#define DRJIT_VAR_CHUNK_ALIGN 65536
+
+/// Chunks whose IDs were all handed out are compacted once at most this many
+/// of their variables remain, see \ref VariableTable::compact()
+#define DRJIT_VAR_CHUNK_SPARSE 64
+
+/// Storage for a contiguous range of variable IDs
+struct alignas(64) VariableChunk {
+    /// Variable records (must be the first member)
+    Variable vars[DRJIT_VAR_CHUNK_SIZE];
+
+    /// Associated scratch space used while assembling kernels
+    VariableScratch scratch[DRJIT_VAR_CHUNK_SIZE];
+
+    /// Bit mask of occupied entries of 'vars'
+    uint64_t used[DRJIT_VAR_CHUNK_SIZE / 64];
+
+    /// Number of occupied entries
+    uint32_t live;
+
+    /// Number of IDs in this chunk that have been handed out so far
+    uint32_t created;
+};
+
+static_assert(sizeof(VariableChunk) <= DRJIT_VAR_CHUNK_ALIGN,
+              "VariableChunk: exceeds the chunk alignment!");
+
+/// Access the scratch space of a variable stored in the variable table
+inline VariableScratch &jitc_var_scratch(const Variable *v) {
+    VariableChunk *chunk = (VariableChunk *) ((uintptr_t) v & ~(uintptr_t) (DRJIT_VAR_CHUNK_ALIGN - 1));
+    return chunk->scratch[v - chunk->vars];
+}
+
+/**
+ * \brief Maps from variable ID to a Variable instance
+ *
+ * Variables are stored in chunks of \ref DRJIT_VAR_CHUNK_SIZE entries that
+ * are directly indexed by the variable ID, so that a lookup consists of two
+ * dependent loads instead of a hash table probe. Variable IDs are not reused
+ * (except following an overflow of 'State::variable_index'), because several
+ * parts of the system hold weak references to variables and check whether
+ * they still exist. Instead, a chunk is released once all of its IDs have
+ * been handed out and the associated variables have been freed. Released
+ * chunks are kept in a free list for later reuse.
+ *
+ * A few long-lived variables would otherwise keep entire chunks alive.
+ * Chunks whose IDs were all handed out and that hold at most \ref
+ * DRJIT_VAR_CHUNK_SPARSE variables are therefore compacted: their variables
+ * move to shared "spill" chunks, where they are found through the
+ * 'relocated' map. Since this moves variables, it only happens at the
+ * beginning of \ref jitc_eval(), after which callers must look up variable
+ * pointers again anyway. Pointers remain valid when other variables are
+ * created or freed.
+ *
+ * The directory 'chunks' only covers the chunks starting at 'chunk_base',
+ * and leading entries are dropped once their chunks have been released.
+ */
+struct VariableTable {
+    /// Return a pointer to variable 'index' or \c nullptr if it does not exist
+    Variable *find(uint32_t index) const {
+        uint32_t chunk_id = (index >> DRJIT_VAR_CHUNK_SHIFT) - chunk_base,
+                 slot = index & (DRJIT_VAR_CHUNK_SIZE - 1);
+        if (unlikely(chunk_id >= chunks.size()))
+            return find_relocated(index);
+        VariableChunk *chunk = chunks[chunk_id];
+        if (unlikely(!chunk || !(chunk->used[slot / 64] & (1ull << (slot % 64)))))
+            return find_relocated(index);
+        return chunk->vars + slot;
+    }
+
+    /// Look up a variable that was moved by \ref compact()
+    Variable *find_relocated(uint32_t index) const {
+        if (likely(index > relocated_max))
+            return nullptr;
+        auto it = relocated.find(index);
+        return it != relocated.end() ? it.value() : nullptr;
+    }
+
+    /// Insert a variable. Returns \c nullptr if the ID is already occupied
+    Variable *insert(uint32_t index, const Variable &v);
+
+    /// Remove a variable, which must exist
+    void erase(uint32_t index);
+
+    /// Call func(index, Variable &) for each variable in order of increasing IDs
+    template <typename Func> void for_each(Func &&func) const {
+        std::vector<std::pair<uint32_t, Variable *>> moved(relocated.begin(),
+                                                           relocated.end());
+        std::sort(moved.begin(), moved.end());
+        auto it = moved.begin();
+
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            VariableChunk *chunk = chunks[i];
+            if (!chunk)
+                continue;
+            uint32_t base = (uint32_t) ((chunk_base + i) << DRJIT_VAR_CHUNK_SHIFT);
+            for (uint32_t j = 0; j < DRJIT_VAR_CHUNK_SIZE; ++j) {
+                if (!(chunk->used[j / 64] & (1ull << (j % 64))))
+                    continue;
+                for (; it != moved.end() && it->first < base + j; ++it)
+                    func(it->first, *it->second);
+                func(base + j, chunk->vars[j]);
+            }
+        }
+
+        for (; it != moved.end(); ++it)
+            func(it->first, *it->second);
+    }
+
+    /// Move the variables of sparse chunks into spill chunks (see above)
+    void compact();
+
+    /// Number of variables
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
 
-/// Key data structure for kernel source code & device ID
+    /// Memory usage of the table in bytes
+    size_t memory() const;
+
+    /// Release all chunks (all variables must have been freed)
+    void clear();
+
+    /// Directory of chunks, entry 'i' holds IDs starting at (chunk_base + i) * 1024
+    std::vector<VariableChunk *> chunks;
+    uint32_t chunk_base = 0;
+
+    /// Released chunks that are kept for later reuse
+    std::vector<VariableChunk *> free_chunks;
+
+    /// Chunks holding variables that were moved by compact()
+    std::vector<VariableChunk *> spill_chunks;
+
+    /// Maps the IDs of moved variables to their new location
+    tsl::robin_map<uint32_t, Variable *, UInt32Hasher> relocated;
+    uint32_t relocated_max = 0;
+
+    /// Chunk IDs that became sparse since the last call to compact()
+    std::vector<uint32_t> sparse_chunks;
+
+    size_t m_size = 0, m_chunk_count = 0;
+
+private:
+    VariableChunk *alloc_chunk();
+    void release_chunk(VariableChunk *chunk);
+    void trim();
+};
+
+/**
+ * \brief Key data structure for kernel source code & device ID
+ *
+ * Kernels are identified by the 128-bit hash of their source code. A copy of
+ * the source code is only kept when \c JitFlag::KernelCacheVerify is set, in
+ * which case lookups additionally compare the full text.
+ */
 struct KernelKey {
+    XXH128_hash_t hash;
     char *str = nullptr;
     int device = 0;
     uint64_t flags = 0;
 
-    KernelKey(char *str, int device, uint64_t flags) : str(str), device(device), flags(flags) { }
+    KernelKey(XXH128_hash_t hash, char *str, int device, uint64_t flags)
+        : hash(hash), str(str), device(device), flags(flags) { }
 
     bool operator==(const KernelKey &k) const {
-        return strcmp(k.str, str) == 0 && device == k.device && flags == k.flags;
+        return hash.high64 == k.hash.high64 && hash.low64 == k.hash.low64 &&
+               device == k.device && flags == k.flags &&
+               (!str || !k.str || strcmp(k.str, str) == 0);
     }
 };
 
 /// Helper class to hash KernelKey instances
 struct KernelHash {
     size_t operator()(const KernelKey &k) const {
-        return compute_hash(hash_kernel(k.str).high64, k.device, k.flags);
+        return compute_hash(k.hash.high64, k.device, k.flags);
     }
 
     static size_t compute_hash(size_t kernel_hash, int device, uint64_t flags) {
@@ -655,6 +840,19 @@ struct Extra {
 
 using ExtraMap = tsl::robin_map<uint32_t, Extra, UInt32Hasher>;
 
+/// Value history of a literal in a kernel, see jit_set_literal_hoisting()
+struct LiteralHistory {
+    /// Value seen in the most recent launch
+    uint64_t value;
+    /// Number of times that the value changed
+    uint32_t changes;
+    /// Value of 'State::kernel_launches' when the literal was last seen
+    uint64_t last_use;
+};
+
+using LiteralHistoryMap =
+    tsl::robin_map<uint64_t, LiteralHistory, UInt64Hasher>;
+
 /// Records the full JIT compiler state (most frequently two used entries at top)
 struct State {
     /// Must be held to access members
@@ -664,7 +862,7 @@ struct State {
     Lock alloc_free_lock;
 
     /// Stores the mapping from variable indices to variables
-    VariableMap variables;
+    VariableTable variables;
 
     /// Counter to create variable scopes that enforce a variable ordering
     uint32_t scope_ctr = 0;
@@ -707,6 +905,12 @@ struct State {
            alloc_allocated[(int) AllocType::Count] { 0 },
            alloc_watermark[(int) AllocType::Count] { 0 };
 
+    /// Bytes requested by live allocations (before rounding to a size class)
+    size_t alloc_requested[(int) AllocType::Count] { 0 };
+
+    /// Soft limit on 'alloc_allocated' (0: unlimited), see jit_malloc_set_limit()
+    size_t alloc_limit[(int) AllocType::Count] { 0 };
+
     /// Keep track of the number of created JIT variables
     uint32_t variable_watermark = 0;
 
@@ -724,10 +928,27 @@ struct State {
     size_t kernel_soft_misses = 0;
     size_t kernel_hits = 0;
     size_t kernel_launches = 0;
+    size_t kernel_evictions = 0;
 
     /// Cache of previously compiled kernels
     KernelCache kernel_cache;
 
+    /// Total size of the compiled kernels stored in 'kernel_cache'
+    size_t kernel_cache_size = 0;
+
+    /// Budget of the kernel cache in bytes and entries (0: unlimited)
+    size_t kernel_cache_limit_size = 0;
+    size_t kernel_cache_limit_count = 0;
+
+    /// Operation budget of automatic evaluation checkpoints (0: disabled)
+    uint32_t auto_eval_budget = 0;
+
+    /// Pass literals via the parameter array after this many changes (0: disabled)
+    uint32_t literal_hoisting = 0;
+
+    /// Maps kernel structure and literal position to the literal's history
+    LiteralHistoryMap literal_history;
+
     /// Kernel launch history
     KernelHistory kernel_history = KernelHistory();
 
@@ -790,6 +1011,12 @@ extern State state;
   extern wchar_t *jitc_temp_path;
 #endif
 
+/// Set the directory of the on-disk kernel cache, create it if needed
+extern void jitc_set_cache_dir(const char *path);
+
+/// Return the directory of the on-disk kernel cache
+extern const char *jitc_cache_dir();
+
 /// Initialize core data structures of the JIT compiler
 extern void jitc_init(uint32_t backends);
 
@@ -928,4 +1155,27 @@ inline bool jitc_is_one(Variable *v) {
     return v->literal == one;
 }
 
+inline bool jitc_is_minus_one(Variable *v) {
+    if (!v->is_literal())
+        return false;
+
+    uint64_t minus_one;
+    switch ((VarType) v->type) {
+        case VarType::Int8:
+        case VarType::UInt8:   minus_one = 0xffull; break;
+        case VarType::Int16:
+        case VarType::UInt16:  minus_one = 0xffffull; break;
+        case VarType::Float16: minus_one = 0xbc00ull; break;
+        case VarType::Int32:
+        case VarType::UInt32:  minus_one = 0xffffffffull; break;
+        case VarType::Float32: minus_one = 0xbf800000ull; break;
+        case VarType::Float64: minus_one = 0xbff0000000000000ull; break;
+        case VarType::Int64:
+        case VarType::UInt64:  minus_one = ~0ull; break;
+        default: return false;
+    }
+
+    return v->literal == minus_one;
+}
+
 extern const char *var_kind_name[(int) VarKind::Count];
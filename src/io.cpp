@@ -13,9 +13,20 @@
 #include "profiler.h"
 #include "cuda.h"
 #include "optix.h"
+#include "eval.h"
+#include "util.h"
 #include "../resources/kernels.h"
 #include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <tuple>
+#include <mutex>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <condition_variable>
 #include <stdio.h>
+#include <time.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <lz4.h>
@@ -25,10 +36,12 @@
 #else
 #  include <unistd.h>
 #  include <sys/mman.h>
+#  include <sys/file.h>
+#  include <sys/stat.h>
 #endif
 
 /// Version number for cache files
-#define DRJIT_CACHE_VERSION 5
+#define DRJIT_CACHE_VERSION 6
 
 // Uncomment to write out training data for creating a compression dictionary
 // #define DRJIT_CACHE_TRAIN 1
@@ -41,9 +54,15 @@ struct CacheFileHeader {
     uint32_t source_size;
     uint32_t kernel_size;
     uint32_t reloc_size;
+
+    /// XXH3 hash of the compressed payload to detect corrupt records
+    uint64_t checksum;
 };
 #pragma pack(pop)
 
+/// Maximum size of the on-disk kernel cache in bytes (0: unlimited)
+size_t jitc_kernel_cache_disk_limit = (size_t) 1 << 30;
+
 char jitc_lz4_dict[jitc_lz4_dict_size];
 static bool jitc_lz4_dict_ready = false;
 
@@ -72,106 +91,60 @@ static uint32_t compute_padding(const CacheFileHeader &header) {
     return padding_size;
 }
 
-bool jitc_kernel_load(const char *source, uint32_t source_size,
-                      JitBackend backend, XXH128_hash_t hash, Kernel &kernel) {
-    jitc_lz4_init();
-
-#if !defined(_WIN32)
-    char filename[512];
-    if (unlikely(snprintf(filename, sizeof(filename), "%s/%016llx%016llx.%s.bin",
-                          jitc_temp_path, (unsigned long long) hash.high64,
-                          (unsigned long long) hash.low64,
-                          backend == JitBackend::CUDA ? "cuda" : "llvm") < 0))
-        jitc_fail("jit_kernel_load(): scratch space for filename insufficient!");
-
-    int fd = open(filename, O_RDONLY);
-    if (fd == -1)
-        return false;
-
-    auto read_retry = [&](uint8_t* data, size_t data_size) {
-        while (data_size > 0) {
-            ssize_t n_read = read(fd, data, data_size);
-            if (n_read <= 0) {
-                if (errno == EINTR) {
-                    continue;
-                } else {
-                    jitc_raise("jit_kernel_load(): I/O error while while "
-                              "reading compiled kernel from cache "
-                              "file \"%s\": %s",
-                              filename, strerror(errno));
-                }
-            }
-            data += n_read;
-            data_size -= n_read;
-        }
-    };
-#else
-    wchar_t filename_w[512];
-    char filename[512];
-
-    int rv = _snwprintf(filename_w, sizeof(filename_w) / sizeof(wchar_t),
-                        L"%s\\%016llx%016llx.%s.bin",
-                        jitc_temp_path, (unsigned long long) hash.high64,
-                        (unsigned long long) hash.low64,
-                        backend == JitBackend::CUDA ? L"cuda" : L"llvm");
-
-    if (rv < 0 || rv == sizeof(filename) ||
-        wcstombs(filename, filename_w, sizeof(filename)) == sizeof(filename))
-        jitc_fail("jit_kernel_load(): scratch space for filename insufficient!");
-
-    HANDLE fd = CreateFileW(filename_w, GENERIC_READ,
-        FILE_SHARE_READ, nullptr, OPEN_EXISTING,
-        FILE_ATTRIBUTE_NORMAL, nullptr);
-
-    if (fd == INVALID_HANDLE_VALUE)
-        return false;
-
-    auto read_retry = [&](uint8_t* data, size_t data_size) {
-        while (data_size > 0) {
-            DWORD n_read = 0;
-            if (!ReadFile(fd, data, (DWORD) data_size, &n_read, nullptr) || n_read == 0)
-                jitc_raise("jit_kernel_load(): I/O error while while "
-                           "reading compiled kernel from cache "
-                           "file \"%s\": %u", filename, GetLastError());
-
-            data += n_read;
-            data_size -= n_read;
-        }
-    };
-#endif
-
-    char *compressed = nullptr, *uncompressed = nullptr;
+/**
+ * \brief Decode a cache record (header + LZ4-compressed payload) into 'kernel'
+ *
+ * When 'source' is \c nullptr, the record isn't checked against the kernel
+ * source. A copy of the source stored in the record is instead returned via
+ * 'source_out' (if specified).
+ */
+static bool jitc_kernel_decode(const char *filename, const uint8_t *record,
+                               size_t record_size, const char *source,
+                               uint32_t source_size, JitBackend backend,
+                               XXH128_hash_t hash, Kernel &kernel,
+                               char **source_out = nullptr) {
+    char *uncompressed = nullptr;
 
     CacheFileHeader header;
     uint32_t padding_size = 0;
     bool success = true;
-    std::vector<void *> func;
 
     try {
-        read_retry((uint8_t *) &header, sizeof(CacheFileHeader));
+        if (record_size < sizeof(CacheFileHeader))
+            jitc_raise("jit_kernel_load(): cache file \"%s\" is malformed.",
+                       filename);
+
+        memcpy(&header, record, sizeof(CacheFileHeader));
 
         if (header.version != DRJIT_CACHE_VERSION)
             jitc_raise("jit_kernel_load(): cache file \"%s\" is from an "
                        "incompatible version of Dr.Jit. You may want to wipe "
                        "your ~/.drjit directory.", filename);
 
-        if (header.source_size != source_size)
+        if (source && header.source_size != source_size)
             jitc_raise("jit_kernel_load(): cache collision in file \"%s\": size "
                        "mismatch (%u vs %u bytes).",
                        filename, header.source_size, source_size);
 
+        if (record_size - sizeof(CacheFileHeader) < header.compressed_size)
+            jitc_raise("jit_kernel_load(): cache file \"%s\" is truncated.",
+                       filename);
+
+        if (XXH3_64bits(record + sizeof(CacheFileHeader),
+                        header.compressed_size) != header.checksum)
+            jitc_raise("jit_kernel_load(): cache file \"%s\" is corrupt "
+                       "(checksum mismatch).", filename);
+
         padding_size = compute_padding(header);
         uint32_t uncompressed_size =
             header.source_size + header.kernel_size + padding_size + header.reloc_size;
 
-        compressed = (char *) malloc_check(header.compressed_size);
         uncompressed = (char *) malloc_check(size_t(uncompressed_size) + jitc_lz4_dict_size);
         memcpy(uncompressed, jitc_lz4_dict, jitc_lz4_dict_size);
 
-        read_retry((uint8_t *) compressed, header.compressed_size);
-
         uint32_t rv_2 = (uint32_t) LZ4_decompress_safe_usingDict(
-            compressed, uncompressed + jitc_lz4_dict_size,
+            (const char *) record + sizeof(CacheFileHeader),
+            uncompressed + jitc_lz4_dict_size,
             (int) header.compressed_size, (int) uncompressed_size,
             (char *) uncompressed, jitc_lz4_dict_size);
 
@@ -185,17 +158,24 @@ bool jitc_kernel_load(const char *source, uint32_t source_size,
 
     char *uncompressed_data = uncompressed + jitc_lz4_dict_size;
 
-    if (success && memcmp(uncompressed_data, source, source_size) != 0) {
+    if (success && source &&
+        memcmp(uncompressed_data, source, source_size) != 0) {
         jitc_log(Warn, "jit_kernel_load(): cache collision in file \"%s\".", filename);
         success = false;
     }
 
+    if (success && !source && source_out) {
+        *source_out = (char *) malloc_check(size_t(header.source_size) + 1);
+        memcpy(*source_out, uncompressed_data, header.source_size);
+        (*source_out)[header.source_size] = '\0';
+    }
+
     if (success) {
         jitc_log(Trace, "jit_kernel_load(\"%s\")", filename);
         kernel.size = header.kernel_size;
         if (backend == JitBackend::CUDA) {
             kernel.data = malloc_check(header.kernel_size);
-            memcpy(kernel.data, uncompressed_data + source_size, header.kernel_size);
+            memcpy(kernel.data, uncompressed_data + header.source_size, header.kernel_size);
         } else {
 #if !defined(_WIN32)
             kernel.data = mmap(nullptr, header.kernel_size, PROT_READ | PROT_WRITE,
@@ -204,12 +184,12 @@ bool jitc_kernel_load(const char *source, uint32_t source_size,
                 jitc_fail("jit_llvm_load(): could not mmap() memory: %s",
                          strerror(errno));
 
-            memcpy(kernel.data, uncompressed_data + source_size, header.kernel_size);
+            memcpy(kernel.data, uncompressed_data + header.source_size, header.kernel_size);
 #else
             kernel.data = VirtualAlloc(nullptr, header.kernel_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
             if (!kernel.data)
                 jitc_fail("jit_llvm_load(): could not VirtualAlloc() memory: %u", GetLastError());
-            memcpy(kernel.data, uncompressed_data + source_size, header.kernel_size);
+            memcpy(kernel.data, uncompressed_data + header.source_size, header.kernel_size);
 
 #endif
             uintptr_t *reloc = (uintptr_t *) (uncompressed_data + header.source_size + padding_size + header.kernel_size);
@@ -222,6 +202,11 @@ bool jitc_kernel_load(const char *source, uint32_t source_size,
             if (kernel.llvm.n_reloc > 1)
                 *((void **) kernel.llvm.reloc[1]) = kernel.llvm.reloc + 1;
 
+            // Only fully optimized kernels are written to the cache
+            kernel.llvm.tier = 1;
+            kernel.llvm.launches = 0;
+            kernel.llvm.profile = new LLVMKernelProfile();
+
 #if !defined(_WIN32)
             if (mprotect(kernel.data, header.kernel_size, PROT_READ | PROT_EXEC) == -1)
                 jitc_fail("jit_llvm_load(): mprotect() failed: %s", strerror(errno));
@@ -236,82 +221,801 @@ bool jitc_kernel_load(const char *source, uint32_t source_size,
             snprintf(name, sizeof(name), "drjit_%016llx%016llx",
                      (unsigned long long) hash.high64,
                      (unsigned long long) hash.low64);
-            kernel.llvm.itt = __itt_string_handle_create(name);
+            kernel.llvm.profile->itt = __itt_string_handle_create(name);
 #endif
         }
     }
+    (void) hash;
 
-    free(compressed);
     free(uncompressed);
 
-#if !defined(_WIN32)
-    close(fd);
+    return success;
+}
+
+/// Compress a kernel into a cache record (header + LZ4-compressed payload)
+static uint8_t *jitc_kernel_encode(const char *source, uint32_t source_size,
+                                   JitBackend backend, XXH128_hash_t hash,
+                                   const Kernel &kernel, uint32_t *record_size) {
+    CacheFileHeader header;
+    header.version = DRJIT_CACHE_VERSION;
+    header.source_size = source_size;
+    header.kernel_size = kernel.size;
+    header.reloc_size = 0;
+
+    if (backend == JitBackend::LLVM)
+        header.reloc_size = kernel.llvm.n_reloc * sizeof(void *);
+
+    uint32_t padding_size = compute_padding(header);
+    uint32_t in_size = header.source_size + header.kernel_size
+                     + padding_size + header.reloc_size,
+             out_size = LZ4_compressBound(in_size);
+
+    uint8_t *temp_in  = (uint8_t *) malloc_check(in_size),
+            *record   = (uint8_t *) malloc_check(sizeof(CacheFileHeader) + out_size);
+
+    memcpy(temp_in, source, header.source_size);
+    memcpy(temp_in + source_size, kernel.data, header.kernel_size);
+    memset(temp_in + header.source_size + header.kernel_size, 0, padding_size);
+
+    if (backend == JitBackend::LLVM) {
+        uintptr_t *reloc_out = (uintptr_t *) (temp_in + header.source_size +
+                                              header.kernel_size + padding_size);
+        for (uint32_t i = 0; i < kernel.llvm.n_reloc; ++i)
+            reloc_out[i] = (uintptr_t) kernel.llvm.reloc[i] - (uintptr_t) kernel.data;
+    }
+
+    LZ4_stream_t stream;
+    memset(&stream, 0, sizeof(LZ4_stream_t));
+    LZ4_resetStream_fast(&stream);
+    LZ4_loadDict(&stream, jitc_lz4_dict, jitc_lz4_dict_size);
+
+    header.compressed_size = (uint32_t) LZ4_compress_fast_continue(
+        &stream, (const char *) temp_in,
+        (char *) record + sizeof(CacheFileHeader), (int) in_size,
+        (int) out_size, 1);
+
+    header.checksum = XXH3_64bits(record + sizeof(CacheFileHeader),
+                                  header.compressed_size);
+
+    memcpy(record, &header, sizeof(CacheFileHeader));
+    *record_size = (uint32_t) sizeof(CacheFileHeader) + header.compressed_size;
+
+#if DRJIT_CACHE_TRAIN == 1
+    char filename[512];
+    snprintf(filename, sizeof(filename), "%s/.drjit/%016llx%016llx.%s.trn",
+             getenv("HOME"), (unsigned long long) hash.high64,
+             (unsigned long long) hash.low64,
+             backend == JitBackend::CUDA ? "cuda" : "llvm");
+    FILE *f = fopen(filename, "wb");
+    if (f) {
+        fwrite(temp_in, in_size, 1, f);
+        fclose(f);
+    }
 #else
-    CloseHandle(fd);
+    (void) hash;
 #endif
 
-    return success;
-}
+    free(temp_in);
 
-bool jitc_kernel_write(const char *source, uint32_t source_size,
-                       JitBackend backend, XXH128_hash_t hash,
-                       const Kernel &kernel) {
-    jitc_lz4_init();
+    return record;
+}
 
 #if !defined(_WIN32)
-    char filename[512], filename_tmp[512];
-    if (unlikely(snprintf(filename, sizeof(filename), "%s/%016llx%016llx.%s.bin",
-                          jitc_temp_path, (unsigned long long) hash.high64,
-                          (unsigned long long) hash.low64,
-                          backend == JitBackend::CUDA ? "cuda" : "llvm") < 0))
-        jitc_fail("jit_kernel_write(): scratch space for filename insufficient!");
 
-    if (unlikely(snprintf(filename_tmp, sizeof(filename_tmp), "%s.tmp",
-                          filename) < 0))
-        jitc_fail("jit_kernel_write(): scratch space for filename insufficient!");
+/* On POSIX systems, all cached kernels are stored in a single append-only
+   pack file "kernels-v<pack version>.<cache version>.pack", hence different
+   versions of Dr.Jit sharing a cache directory don't interfere. It begins
+   with a header and an open-addressing hash table (the index) mapping kernel
+   hashes to records. The records are appended behind it. The file is
+   memory-mapped, so that lookups don't involve any system calls. Writers
+   from multiple processes serialize using flock(). A writer publishes a
+   record by storing its offset into the index slot last. When the index
+   fills up or the file exceeds the size limit, the pack is compacted into a
+   new file with a larger index, dropping the least recently used kernels as
+   needed. The old file is then flagged as stale, which makes other processes
+   switch to the new one. A damaged pack is replaced in the same way, since
+   other processes might have mapped it. */
+
+/// Version number of the pack file layout
+#define DRJIT_PACK_VERSION 2
+
+/// Initial number of index slots of a new pack file
+#define DRJIT_PACK_CAPACITY 16384
+
+struct PackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t cache_version;
+
+    /// Number of index slots (a power of two)
+    uint32_t capacity;
+
+    /// Number of used index slots
+    uint32_t count;
+
+    /// Set to 1 once the file has been replaced by a compacted version
+    uint32_t stale;
+
+    uint32_t unused[9];
+};
+
+struct PackEntry {
+    uint64_t hash_high;
+    uint64_t hash_low;
+
+    /// Offset of the record within the file (0: unused slot)
+    uint64_t offset;
+
+    /// Size of the record
+    uint32_t size;
+
+    /// JitBackend of the kernel
+    uint32_t backend;
+
+    /// Time of the last load or write (seconds since the epoch)
+    uint64_t atime;
+
+    /// Set to 1 when the record failed to decode and should be replaced
+    uint32_t invalid;
+
+    uint32_t unused;
+};
+
+static_assert(sizeof(PackHeader) == 64 && sizeof(PackEntry) == 48,
+              "Pack file structures have an unexpected size!");
+
+static const char jitc_pack_magic[8] = { 'D', 'R', 'J', 'I', 'T', 'P', 'K', 0 };
+
+/// Process-wide state of the memory-mapped pack file
+static struct {
+    std::mutex mutex;
+    int fd = -1;
+    uint8_t *map = nullptr;
+    size_t map_size = 0;
+    char path[512];
+} pack;
+
+/// Acquire/release the inter-process lock of the pack file
+struct PackFileLock {
+    int fd;
+    PackFileLock(int fd) : fd(fd) {
+        while (flock(fd, LOCK_EX) == -1 && errno == EINTR)
+            ;
+    }
+    ~PackFileLock() { flock(fd, LOCK_UN); }
+};
+
+static PackHeader *jitc_pack_header() { return (PackHeader *) pack.map; }
+
+static PackEntry *jitc_pack_index() {
+    return (PackEntry *) (pack.map + sizeof(PackHeader));
+}
+
+static void jitc_pack_close() {
+    if (pack.map)
+        munmap(pack.map, pack.map_size);
+    if (pack.fd != -1)
+        close(pack.fd);
+    pack.fd = -1;
+    pack.map = nullptr;
+    pack.map_size = 0;
+}
+
+/// Map the current contents of the pack file into memory
+static bool jitc_pack_remap() {
+    struct stat st;
+    if (fstat(pack.fd, &st) != 0)
+        return false;
+
+    size_t size = (size_t) st.st_size;
+    if (pack.map && size == pack.map_size)
+        return true;
+
+    if (pack.map)
+        munmap(pack.map, pack.map_size);
+
+    pack.map = (uint8_t *) mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                MAP_SHARED, pack.fd, 0);
+    if (pack.map == MAP_FAILED) {
+        pack.map = nullptr;
+        pack.map_size = 0;
+        return false;
+    }
+
+    pack.map_size = size;
+    return true;
+}
+
+/// Write an empty header and index to the (locked) pack file 'fd'
+static bool jitc_pack_init_file(int fd, uint32_t capacity) {
+    size_t size = sizeof(PackHeader) + (size_t) capacity * sizeof(PackEntry);
+
+    PackHeader header;
+    memset(&header, 0, sizeof(PackHeader));
+    memcpy(header.magic, jitc_pack_magic, sizeof(jitc_pack_magic));
+    header.version = DRJIT_PACK_VERSION;
+    header.cache_version = DRJIT_CACHE_VERSION;
+    header.capacity = capacity;
+
+    return ftruncate(fd, 0) == 0 && ftruncate(fd, (off_t) size) == 0 &&
+           pwrite(fd, &header, sizeof(PackHeader), 0) ==
+               (ssize_t) sizeof(PackHeader);
+}
+
+/// Check the header of the (locked) pack file 'fd'
+static bool jitc_pack_check(int fd, bool *stale) {
+    struct stat st;
+    PackHeader header;
+    *stale = false;
+
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(PackHeader) ||
+        pread(fd, &header, sizeof(PackHeader), 0) != (ssize_t) sizeof(PackHeader) ||
+        memcmp(header.magic, jitc_pack_magic, sizeof(jitc_pack_magic)) != 0 ||
+        header.version != DRJIT_PACK_VERSION ||
+        header.cache_version != DRJIT_CACHE_VERSION)
+        return false;
+
+    *stale = header.stale != 0;
+
+    return header.stale == 0 && header.capacity != 0 &&
+           (header.capacity & (header.capacity - 1)) == 0 &&
+           (size_t) st.st_size >= sizeof(PackHeader) +
+               (size_t) header.capacity * sizeof(PackEntry);
+}
+
+/**
+ * \brief Replace the damaged (locked) pack file 'fd' by an empty one
+ *
+ * The new file is created next to the old one and renamed over it, since
+ * other processes may still access the old file through a memory mapping.
+ * These processes are told to switch over via the 'stale' field if the old
+ * header is recognizable.
+ */
+static bool jitc_pack_reset_locked(int fd) {
+    char path_tmp[520];
+    snprintf(path_tmp, sizeof(path_tmp), "%s.tmp", pack.path);
 
     mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
-    int fd = open(filename_tmp, O_CREAT | O_EXCL | O_WRONLY, mode);
-    if (fd == -1) {
-        jitc_log(Warn,
-                "jit_kernel_write(): could not write compiled kernel "
-                "to cache file \"%s\": %s", filename_tmp, strerror(errno));
+    int fd_new = open(path_tmp, O_RDWR | O_CREAT | O_TRUNC, mode);
+    bool success = fd_new != -1 &&
+                   jitc_pack_init_file(fd_new, DRJIT_PACK_CAPACITY) &&
+                   rename(path_tmp, pack.path) == 0;
+
+    if (fd_new != -1)
+        close(fd_new);
+
+    if (!success) {
+        unlink(path_tmp);
         return false;
     }
 
-    auto write_retry = [&](const uint8_t *data, size_t data_size) {
-        while (data_size > 0) {
-            ssize_t n_written = write(fd, data, data_size);
-            if (n_written <= 0) {
-                if (errno == EINTR) {
-                    continue;
+    char magic[sizeof(jitc_pack_magic)];
+    uint32_t stale = 1;
+    if (pread(fd, magic, sizeof(magic), 0) == (ssize_t) sizeof(magic) &&
+        memcmp(magic, jitc_pack_magic, sizeof(magic)) == 0 &&
+        pwrite(fd, &stale, sizeof(uint32_t), offsetof(PackHeader, stale)) !=
+            (ssize_t) sizeof(uint32_t))
+        jitc_log(Warn, "jit_kernel_load(): could not mark the old kernel cache "
+                 "as stale: %s", strerror(errno));
+
+    return true;
+}
+
+/// Open (and if necessary create) the pack file. Expects 'pack.mutex' held
+static bool jitc_pack_open() {
+    if (pack.fd != -1) {
+        // Switch to the new file if another process compacted the pack
+        if (pack.map &&
+            __atomic_load_n(&jitc_pack_header()->stale, __ATOMIC_ACQUIRE) == 0)
+            return true;
+        jitc_pack_close();
+    }
+
+    // The cache directory was released by jit_shutdown()
+    if (!jitc_temp_path)
+        return false;
+
+    if (unlikely(snprintf(pack.path, sizeof(pack.path), "%s/kernels-v%u.%u.pack",
+                          jitc_temp_path, (uint32_t) DRJIT_PACK_VERSION,
+                          (uint32_t) DRJIT_CACHE_VERSION) < 0))
+        jitc_fail("jit_kernel_load(): scratch space for filename insufficient!");
+
+    mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+
+    /* The file may be replaced by another process between open() and
+       flock(). Retry a few times in that case. */
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        pack.fd = open(pack.path, O_RDWR | O_CREAT, mode);
+        if (pack.fd == -1) {
+            jitc_log(Warn, "jit_kernel_load(): could not open kernel cache \"%s\": %s",
+                     pack.path, strerror(errno));
+            return false;
+        }
+
+        bool success, retry = false;
+        /* Lock guard */ {
+            PackFileLock guard(pack.fd);
+
+            struct stat st;
+            bool stale;
+            success = fstat(pack.fd, &st) == 0;
+
+            if (success && !jitc_pack_check(pack.fd, &stale)) {
+                if (stale) {
+                    // Replaced by another process, open the new file
+                    retry = true;
+                } else if (st.st_size == 0) {
+                    // Newly created file, nobody else can have mapped it
+                    success = jitc_pack_init_file(pack.fd, DRJIT_PACK_CAPACITY);
                 } else {
-                    jitc_raise("jit_kernel_write(): I/O error while while "
-                              "writing compiled kernel to cache "
-                              "file \"%s\": %s",
-                              filename_tmp, strerror(errno));
+                    jitc_log(Warn, "jit_kernel_load(): kernel cache \"%s\" is "
+                             "damaged, resetting it.", pack.path);
+                    success = jitc_pack_reset_locked(pack.fd);
+                    retry = success;
                 }
             }
-            data += n_written;
-            data_size -= n_written;
+
+            success = success && (retry || jitc_pack_remap());
         }
-    };
-#else
-    wchar_t filename_w[512], filename_tmp_w[512];
-    char filename[512], filename_tmp[512];
 
-    int rv = _snwprintf(filename_w, sizeof(filename_w) / sizeof(wchar_t),
-                        L"%s\\%016llx%016llx.%s.bin",
+        if (success && !retry)
+            return true;
+
+        int errno_value = errno;
+        jitc_pack_close();
+
+        if (!success) {
+            jitc_log(Warn, "jit_kernel_load(): could not initialize kernel cache \"%s\": %s",
+                     pack.path, strerror(errno_value));
+            return false;
+        }
+    }
+
+    jitc_log(Warn, "jit_kernel_load(): kernel cache \"%s\" keeps changing, "
+             "giving up.", pack.path);
+    return false;
+}
+
+/// Find the index slot of a kernel (or the empty slot where it would go)
+static PackEntry *jitc_pack_find(XXH128_hash_t hash, JitBackend backend) {
+    uint32_t capacity = jitc_pack_header()->capacity,
+             mask = capacity - 1,
+             slot = (uint32_t) hash.low64 & mask;
+
+    PackEntry *index = jitc_pack_index();
+    for (uint32_t i = 0; i < capacity; ++i) {
+        PackEntry *e = index + ((slot + i) & mask);
+        if (__atomic_load_n(&e->offset, __ATOMIC_ACQUIRE) == 0)
+            return e;
+        if (e->hash_high == hash.high64 && e->hash_low == hash.low64 &&
+            e->backend == (uint32_t) backend)
+            return e;
+    }
+
+    return nullptr;
+}
+
+/**
+ * \brief Copy all valid records referenced by the index into a new pack file
+ * with 'capacity' index slots, and replace the current one by it
+ *
+ * When 'budget' is nonzero, only the most recently used records whose total
+ * size is below this value are kept. Expects 'pack.mutex' and the
+ * inter-process lock to be held.
+ */
+static bool jitc_pack_compact_locked(uint32_t capacity, size_t budget) {
+    char path_tmp[520];
+    snprintf(path_tmp, sizeof(path_tmp), "%s.tmp", pack.path);
+
+    mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+    int fd = open(path_tmp, O_RDWR | O_CREAT | O_TRUNC, mode);
+    if (fd == -1 || !jitc_pack_init_file(fd, capacity)) {
+        jitc_log(Warn, "jit_kernel_cache_compact(): could not create \"%s\": %s",
+                 path_tmp, strerror(errno));
+        if (fd != -1)
+            close(fd);
+        return false;
+    }
+
+    const PackHeader *header = jitc_pack_header();
+    const PackEntry *index = jitc_pack_index();
+
+    std::vector<PackEntry> entries;
+    for (uint32_t i = 0; i < header->capacity; ++i) {
+        const PackEntry &e = index[i];
+        if (e.offset != 0 && !e.invalid && e.offset + e.size <= pack.map_size)
+            entries.push_back(e);
+    }
+
+    if (budget) {
+        // Most recently used first, newer records win ties
+        std::sort(entries.begin(), entries.end(),
+                  [](const PackEntry &a, const PackEntry &b) {
+                      return a.atime != b.atime ? a.atime > b.atime
+                                                : a.offset > b.offset;
+                  });
+
+        size_t total = 0, n = 0;
+        while (n < entries.size() && total + entries[n].size <= budget)
+            total += entries[n++].size;
+
+        if (n < entries.size())
+            jitc_log(Info, "jit_kernel_cache_compact(): evicting %zu least "
+                     "recently used kernel%s.", entries.size() - n,
+                     entries.size() - n > 1 ? "s" : "");
+        entries.resize(n);
+    }
+
+    std::vector<PackEntry> index_new(capacity);
+    memset(index_new.data(), 0, sizeof(PackEntry) * capacity);
+
+    uint64_t offset = sizeof(PackHeader) + (uint64_t) capacity * sizeof(PackEntry);
+    uint32_t count = 0;
+    bool success = true;
+
+    for (size_t i = 0; i < entries.size() && success; ++i) {
+        PackEntry e = entries[i];
+
+        uint32_t slot = (uint32_t) e.hash_low & (capacity - 1);
+        while (index_new[slot].offset)
+            slot = (slot + 1) & (capacity - 1);
+
+        success = pwrite(fd, pack.map + e.offset, e.size, (off_t) offset) ==
+                  (ssize_t) e.size;
+
+        e.offset = offset;
+        index_new[slot] = e;
+        offset += e.size;
+        count++;
+    }
+
+    PackHeader header_new;
+    memcpy(&header_new, header, sizeof(PackHeader));
+    header_new.capacity = capacity;
+    header_new.count = count;
+    header_new.stale = 0;
+
+    success = success &&
+        pwrite(fd, index_new.data(), sizeof(PackEntry) * capacity,
+               sizeof(PackHeader)) == (ssize_t) (sizeof(PackEntry) * capacity) &&
+        pwrite(fd, &header_new, sizeof(PackHeader), 0) == (ssize_t) sizeof(PackHeader) &&
+        rename(path_tmp, pack.path) == 0;
+
+    if (!success) {
+        jitc_log(Warn, "jit_kernel_cache_compact(): could not write \"%s\": %s",
+                 path_tmp, strerror(errno));
+        close(fd);
+        unlink(path_tmp);
+        return false;
+    }
+
+    jitc_log(Info, "jit_kernel_cache_compact(): %u kernels, %s -> %s.", count,
+             std::string(jitc_mem_string(pack.map_size)).c_str(),
+             std::string(jitc_mem_string(offset)).c_str());
+
+    // Tell other processes (and this one) to switch over to the new file
+    __atomic_store_n(&jitc_pack_header()->stale, 1u, __ATOMIC_RELEASE);
+    close(fd);
+
+    return true;
+}
+
+/// Locate the record of a kernel in the pack. Expects 'pack.mutex' held
+static const uint8_t *jitc_pack_lookup(XXH128_hash_t hash, JitBackend backend,
+                                       uint32_t *size, PackEntry **entry = nullptr) {
+    if (!jitc_pack_open())
+        return nullptr;
+
+    PackEntry *e = jitc_pack_find(hash, backend);
+    if (!e || e->offset == 0 || e->invalid)
+        return nullptr;
+
+    uint64_t offset = e->offset;
+    *size = e->size;
+
+    // The record was appended by another process after the file was mapped
+    if (offset + *size > pack.map_size && !jitc_pack_remap())
+        return nullptr;
+
+    if (offset + *size > pack.map_size) {
+        jitc_log(Warn, "jit_kernel_load(): kernel cache \"%s\" is truncated.",
+                 pack.path);
+        return nullptr;
+    }
+
+    // Record the access for LRU eviction (no lock needed, this is a hint)
+    __atomic_store_n(&e->atime, (uint64_t) time(nullptr), __ATOMIC_RELAXED);
+
+    if (entry)
+        *entry = e;
+
+    return pack.map + offset;
+}
+
+/// Flag a record that failed to decode, so that a writer replaces it
+static void jitc_pack_invalidate(PackEntry *e) {
+    __atomic_store_n(&e->invalid, 1u, __ATOMIC_RELAXED);
+}
+
+/// Space available to records in a pack file that must not exceed 'limit'
+static size_t jitc_pack_budget(uint32_t capacity, size_t limit) {
+    size_t index_size = sizeof(PackHeader) + (size_t) capacity * sizeof(PackEntry);
+    if (limit == 0)
+        return 0;
+    return limit > index_size ? limit - index_size : 1;
+}
+
+bool jitc_kernel_load(const char *source, uint32_t source_size,
+                      JitBackend backend, XXH128_hash_t hash, Kernel &kernel) {
+    jitc_lz4_init();
+
+    std::lock_guard<std::mutex> guard(pack.mutex);
+    uint32_t size = 0;
+    PackEntry *e = nullptr;
+    const uint8_t *record = jitc_pack_lookup(hash, backend, &size, &e);
+    if (!record)
+        return false;
+
+    bool success = jitc_kernel_decode(pack.path, record, size, source,
+                                      source_size, backend, hash, kernel);
+    if (!success)
+        jitc_pack_invalidate(e);
+
+    return success;
+}
+
+bool jitc_kernel_load_hash(JitBackend backend, XXH128_hash_t hash,
+                           Kernel &kernel, char **source) {
+    jitc_lz4_init();
+
+    uint8_t *record = nullptr;
+    uint32_t size = 0;
+
+    /* Copy the compressed record so that several threads can decode in parallel */ {
+        std::lock_guard<std::mutex> guard(pack.mutex);
+        const uint8_t *ptr = jitc_pack_lookup(hash, backend, &size);
+        if (!ptr)
+            return false;
+        record = (uint8_t *) malloc_check(size);
+        memcpy(record, ptr, size);
+    }
+
+    bool success = jitc_kernel_decode(pack.path, record, size, nullptr, 0,
+                                      backend, hash, kernel, source);
+    free(record);
+
+    if (!success) {
+        std::lock_guard<std::mutex> guard(pack.mutex);
+        PackEntry *e = nullptr;
+        if (jitc_pack_lookup(hash, backend, &size, &e))
+            jitc_pack_invalidate(e);
+    }
+
+    return success;
+}
+
+bool jitc_kernel_write(const char *source, uint32_t source_size,
+                       JitBackend backend, XXH128_hash_t hash,
+                       const Kernel &kernel) {
+    jitc_lz4_init();
+
+    uint32_t record_size = 0;
+    uint8_t *record = jitc_kernel_encode(source, source_size, backend, hash,
+                                         kernel, &record_size);
+
+    std::lock_guard<std::mutex> guard(pack.mutex);
+    bool success = false;
+
+    /* Retry if another process replaced the pack while we were waiting for
+       the lock, or when the index first needs to be enlarged */
+    for (int i = 0; i < 3 && !success; ++i) {
+        if (!jitc_pack_open())
+            break;
+
+        PackFileLock guard_2(pack.fd);
+        if (__atomic_load_n(&jitc_pack_header()->stale, __ATOMIC_ACQUIRE))
+            continue;
+        if (!jitc_pack_remap())
+            break;
+
+        PackHeader *header = jitc_pack_header();
+        if ((header->count + 1) * 4 > header->capacity * 3) {
+            if (!jitc_pack_compact_locked(
+                    header->capacity * 2,
+                    jitc_pack_budget(header->capacity * 2,
+                                     jitc_kernel_cache_disk_limit)))
+                break;
+            continue;
+        }
+
+        PackEntry *e = jitc_pack_find(hash, backend);
+        if (!e)
+            break;
+
+        success = true;
+        bool replace = e->offset != 0 && e->invalid;
+        if (e->offset != 0 && !replace) // Another process already wrote this kernel
+            break;
+
+        struct stat st;
+        success = fstat(pack.fd, &st) == 0 &&
+                  pwrite(pack.fd, record, record_size, st.st_size) ==
+                      (ssize_t) record_size;
+
+        if (!success) {
+            jitc_log(Warn, "jit_kernel_write(): could not append to "
+                     "kernel cache \"%s\": %s", pack.path, strerror(errno));
+            break;
+        }
+
+        e->hash_high = hash.high64;
+        e->hash_low = hash.low64;
+        e->size = record_size;
+        e->backend = (uint32_t) backend;
+        e->atime = (uint64_t) time(nullptr);
+        e->invalid = 0;
+        __atomic_store_n(&e->offset, (uint64_t) st.st_size, __ATOMIC_RELEASE);
+        if (!replace)
+            header->count++;
+
+        bool log = std::max(state.log_level_stderr,
+                            state.log_level_callback) >= LogLevel::Trace;
+        if (log)
+            jitc_trace("jit_kernel_write(\"%s\"): compressed %s to %s", pack.path,
+                      std::string(jitc_mem_string(size_t(source_size) + kernel.size)).c_str(),
+                      std::string(jitc_mem_string(record_size)).c_str());
+
+        // Evict least recently used kernels when the file is too large
+        size_t limit = jitc_kernel_cache_disk_limit;
+        if (limit && (size_t) st.st_size + record_size > limit)
+            jitc_pack_compact_locked(header->capacity,
+                                     jitc_pack_budget(header->capacity, limit / 8 * 7));
+    }
+
+    free(record);
+    return success;
+}
+
+void jitc_kernel_cache_compact() {
+    std::lock_guard<std::mutex> guard(pack.mutex);
+    if (!jitc_pack_open())
+        return;
+
+    PackFileLock guard_2(pack.fd);
+    if (__atomic_load_n(&jitc_pack_header()->stale, __ATOMIC_ACQUIRE) ||
+        !jitc_pack_remap())
+        return;
+
+    const PackHeader *header = jitc_pack_header();
+    uint32_t capacity = header->capacity;
+
+    // Resize the index to a load factor between 1/4 and 1/2
+    while (capacity > DRJIT_PACK_CAPACITY && header->count * 4 < capacity)
+        capacity /= 2;
+    while (header->count * 2 > capacity)
+        capacity *= 2;
+
+    jitc_pack_compact_locked(
+        capacity, jitc_pack_budget(capacity, jitc_kernel_cache_disk_limit));
+}
+
+void jitc_kernel_cache_shutdown() {
+    std::lock_guard<std::mutex> guard(pack.mutex);
+    jitc_pack_close();
+}
+
+void jitc_kernel_cache_set_path(char *path) {
+    // Prefetch workers access the path while holding 'pack.mutex'
+    std::lock_guard<std::mutex> guard(pack.mutex);
+    jitc_pack_close();
+    free(jitc_temp_path);
+    jitc_temp_path = path;
+}
+
+#else // _WIN32: one file per kernel
+
+/// Protects 'jitc_temp_path' against concurrent changes
+static std::mutex temp_path_mutex;
+
+static bool jitc_kernel_filename(JitBackend backend, XXH128_hash_t hash,
+                                 wchar_t *filename_w, char *filename) {
+    std::lock_guard<std::mutex> guard(temp_path_mutex);
+    if (!jitc_temp_path)
+        return false;
+    int rv = _snwprintf(filename_w, 512, L"%s\\%016llx%016llx.%s.bin",
                         jitc_temp_path, (unsigned long long) hash.high64,
                         (unsigned long long) hash.low64,
                         backend == JitBackend::CUDA ? L"cuda" : L"llvm");
 
-    if (rv < 0 || rv == sizeof(filename) ||
-        wcstombs(filename, filename_w, sizeof(filename)) == sizeof(filename))
+    return !(rv < 0 || rv == 512 || wcstombs(filename, filename_w, 512) == 512);
+}
+
+/// Read the cache file of a kernel into memory
+static uint8_t *jitc_kernel_read(JitBackend backend, XXH128_hash_t hash,
+                                 char *filename, uint32_t *size) {
+    wchar_t filename_w[512];
+    if (!jitc_kernel_filename(backend, hash, filename_w, filename))
+        jitc_fail("jit_kernel_load(): scratch space for filename insufficient!");
+
+    HANDLE fd = CreateFileW(filename_w, GENERIC_READ,
+        FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (fd == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER file_size;
+    uint8_t *record = nullptr;
+    DWORD record_size = 0, n_read = 0;
+    bool success = GetFileSizeEx(fd, &file_size) != 0;
+
+    if (success) {
+        record_size = (DWORD) file_size.QuadPart;
+        record = (uint8_t *) malloc_check(record_size);
+        success = ReadFile(fd, record, record_size, &n_read, nullptr) &&
+                  n_read == record_size;
+        if (!success)
+            jitc_log(Warn, "jit_kernel_load(): I/O error while while "
+                     "reading compiled kernel from cache "
+                     "file \"%s\": %u", filename, GetLastError());
+    }
+
+    CloseHandle(fd);
+
+    if (!success) {
+        free(record);
+        return nullptr;
+    }
+
+    *size = (uint32_t) record_size;
+    return record;
+}
+
+bool jitc_kernel_load(const char *source, uint32_t source_size,
+                      JitBackend backend, XXH128_hash_t hash, Kernel &kernel) {
+    jitc_lz4_init();
+
+    char filename[512];
+    uint32_t size = 0;
+    uint8_t *record = jitc_kernel_read(backend, hash, filename, &size);
+    if (!record)
+        return false;
+
+    bool success = jitc_kernel_decode(filename, record, size, source,
+                                      source_size, backend, hash, kernel);
+    free(record);
+    return success;
+}
+
+bool jitc_kernel_load_hash(JitBackend backend, XXH128_hash_t hash,
+                           Kernel &kernel, char **source) {
+    jitc_lz4_init();
+
+    char filename[512];
+    uint32_t size = 0;
+    uint8_t *record = jitc_kernel_read(backend, hash, filename, &size);
+    if (!record)
+        return false;
+
+    bool success = jitc_kernel_decode(filename, record, size, nullptr, 0,
+                                      backend, hash, kernel, source);
+    free(record);
+    return success;
+}
+
+bool jitc_kernel_write(const char *source, uint32_t source_size,
+                       JitBackend backend, XXH128_hash_t hash,
+                       const Kernel &kernel) {
+    jitc_lz4_init();
+
+    wchar_t filename_w[512], filename_tmp_w[512];
+    char filename[512], filename_tmp[512];
+
+    if (!jitc_kernel_filename(backend, hash, filename_w, filename))
         jitc_fail("jit_kernel_write(): scratch space for filename insufficient!");
 
-    rv = _snwprintf(filename_tmp_w, sizeof(filename_tmp_w) / sizeof(wchar_t),
-                    L"%s.tmp", filename_w);
+    int rv = _snwprintf(filename_tmp_w, sizeof(filename_tmp_w) / sizeof(wchar_t),
+                        L"%s.tmp", filename_w);
 
     if (rv < 0 || rv == sizeof(filename_tmp) ||
         wcstombs(filename_tmp, filename_tmp_w, sizeof(filename_tmp)) == sizeof(filename_tmp))
@@ -328,123 +1032,304 @@ bool jitc_kernel_write(const char *source, uint32_t source_size,
         return false;
     }
 
-    auto write_retry = [&](const uint8_t* data, size_t data_size) {
-        while (data_size > 0) {
-            DWORD n_written = 0;
-            if (!WriteFile(fd, data, (DWORD) data_size, &n_written, nullptr))
-                jitc_raise("jit_kernel_write(): I/O error while while "
-                          "writing compiled kernel to cache "
-                          "file \"%s\": %u",
-                          filename_tmp, GetLastError());
+    uint32_t record_size = 0;
+    uint8_t *record = jitc_kernel_encode(source, source_size, backend, hash,
+                                         kernel, &record_size);
+
+    DWORD n_written = 0;
+    bool success = WriteFile(fd, record, record_size, &n_written, nullptr) &&
+                   n_written == record_size;
+    if (!success)
+        jitc_log(Warn, "jit_kernel_write(): I/O error while while "
+                 "writing compiled kernel to cache "
+                 "file \"%s\": %u", filename_tmp, GetLastError());
+
+    CloseHandle(fd);
+
+    // Replace existing files, which may be corrupt
+    if (success && MoveFileExW(filename_tmp_w, filename_w,
+                               MOVEFILE_REPLACE_EXISTING) == 0)
+        jitc_log(Warn,
+                "jit_kernel_write(): could not link cache "
+                "file \"%s\" into file system: %u",
+                filename, GetLastError());
+
+    free(record);
+    return success;
+}
+
+void jitc_kernel_cache_compact() { }
+void jitc_kernel_cache_shutdown() { }
+
+void jitc_kernel_cache_set_path(wchar_t *path) {
+    std::lock_guard<std::mutex> guard(temp_path_mutex);
+    free(jitc_temp_path);
+    jitc_temp_path = path;
+}
 
-            data += n_written;
-            data_size -= n_written;
-        }
-    };
 #endif
 
-    CacheFileHeader header;
-    header.version = DRJIT_CACHE_VERSION;
-    header.source_size = source_size;
-    header.kernel_size = kernel.size;
-    header.reloc_size = 0;
+/// Maximum number of kernels waiting to be written by the background thread
+#define DRJIT_CACHE_WRITE_QUEUE 64
 
-    if (backend == JitBackend::LLVM)
-        header.reloc_size = kernel.llvm.n_reloc * sizeof(void *);
+/// Kernel waiting to be written to disk by the background writer thread
+struct KernelWriteJob {
+    char *source;
+    uint32_t source_size;
+    JitBackend backend;
+    XXH128_hash_t hash;
 
-    uint32_t padding_size = compute_padding(header);
-    uint32_t in_size = header.source_size + header.kernel_size
-                     + padding_size + header.reloc_size,
-             out_size = LZ4_compressBound(in_size);
+    /// Private copy of the kernel (the original may be evicted meanwhile)
+    Kernel kernel;
+};
 
-    uint8_t *temp_in  = (uint8_t *) malloc_check(in_size),
-            *temp_out = (uint8_t *) malloc_check(out_size);
+struct KernelWriter {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<KernelWriteJob> queue;
+    std::thread thread;
+    bool stop = false;
+};
 
-    memcpy(temp_in, source, header.source_size);
-    memcpy(temp_in + source_size, kernel.data, header.kernel_size);
-    memset(temp_in + header.source_size + header.kernel_size, 0, padding_size);
+/* Intentionally leaked: a pending write must not race with the destruction
+   of the queue when the application exits without calling jit_shutdown() */
+static KernelWriter &writer = *new KernelWriter();
+
+static void jitc_kernel_writer_run() {
+    std::unique_lock<std::mutex> guard(writer.mutex);
+
+    while (true) {
+        writer.cv.wait(guard, [] { return writer.stop || !writer.queue.empty(); });
+        if (writer.queue.empty())
+            break;
+
+        KernelWriteJob job = writer.queue.front();
+        writer.queue.pop_front();
+
+        /* Unlock while compressing and writing */ {
+            guard.unlock();
+            jitc_kernel_write(job.source, job.source_size, job.backend,
+                              job.hash, job.kernel);
+            free(job.source);
+            free(job.kernel.data);
+            if (job.backend == JitBackend::LLVM)
+                free(job.kernel.llvm.reloc);
+            guard.lock();
+        }
+    }
+}
+
+void jitc_kernel_write_async(const char *source, uint32_t source_size,
+                             JitBackend backend, XXH128_hash_t hash,
+                             const Kernel &kernel) {
+    bool full;
+    /* Lock guard */ {
+        std::lock_guard<std::mutex> guard(writer.mutex);
+        full = writer.queue.size() >= DRJIT_CACHE_WRITE_QUEUE;
+        if (!writer.thread.joinable()) {
+            writer.stop = false;
+            writer.thread = std::thread(jitc_kernel_writer_run);
+        }
+    }
+
+    // Apply backpressure when the disk can't keep up
+    if (full) {
+        jitc_log(Debug, "jit_kernel_write(): queue is full, writing synchronously.");
+        jitc_kernel_write(source, source_size, backend, hash, kernel);
+        return;
+    }
+
+    KernelWriteJob job;
+    job.source = (char *) malloc_check(source_size);
+    memcpy(job.source, source, source_size);
+    job.source_size = source_size;
+    job.backend = backend;
+    job.hash = hash;
+
+    memset(&job.kernel, 0, sizeof(Kernel));
+    job.kernel.size = kernel.size;
+    job.kernel.data = malloc_check(kernel.size);
+    memcpy(job.kernel.data, kernel.data, kernel.size);
 
     if (backend == JitBackend::LLVM) {
-        uintptr_t *reloc_out = (uintptr_t *) (temp_in + header.source_size +
-                                              header.kernel_size + padding_size);
-        for (uint32_t i = 0; i < kernel.llvm.n_reloc; ++i)
-            reloc_out[i] = (uintptr_t) kernel.llvm.reloc[i] - (uintptr_t) kernel.data;
+        // Relocations are stored relative to the kernel, rebase them
+        uint32_t n_reloc = kernel.llvm.n_reloc;
+        job.kernel.llvm.n_reloc = n_reloc;
+        job.kernel.llvm.reloc = (void **) malloc_check(sizeof(void *) * n_reloc);
+        for (uint32_t i = 0; i < n_reloc; ++i)
+            job.kernel.llvm.reloc[i] =
+                (uint8_t *) job.kernel.data +
+                ((uint8_t *) kernel.llvm.reloc[i] - (uint8_t *) kernel.data);
     }
 
-    LZ4_stream_t stream;
-    memset(&stream, 0, sizeof(LZ4_stream_t));
-    LZ4_resetStream_fast(&stream);
-    LZ4_loadDict(&stream, jitc_lz4_dict, jitc_lz4_dict_size);
+    std::lock_guard<std::mutex> guard(writer.mutex);
+    writer.queue.push_back(job);
+    writer.cv.notify_one();
+}
 
-    header.compressed_size = (uint32_t) LZ4_compress_fast_continue(
-        &stream, (const char *) temp_in, (char *) temp_out, (int) in_size,
-        (int) out_size, 1);
+void jitc_kernel_write_flush() {
+    /* Lock guard */ {
+        std::lock_guard<std::mutex> guard(writer.mutex);
+        if (!writer.thread.joinable())
+            return;
+        writer.stop = true;
+        writer.cv.notify_one();
+    }
 
-    bool success = true;
-    try {
-        write_retry((const uint8_t *) &header, sizeof(CacheFileHeader));
-        write_retry(temp_out, header.compressed_size);
-    } catch (const std::exception &e) {
-        jitc_log(Warn, "%s", e.what());
-        success = false;
+    // The thread exits once the queue is empty
+    writer.thread.join();
+}
+
+/// Kernel requested by jitc_kernel_prefetch()
+struct PrefetchJob {
+    JitBackend backend;
+    XXH128_hash_t hash;
+    Kernel kernel;
+    char *source;
+    bool success;
+};
+
+uint32_t jitc_kernel_prefetch(const char *manifest) {
+    std::vector<PrefetchJob> jobs;
+
+    // Parse the manifest, skip kernels of missing backends and cached kernels
+    for (const char *line = manifest; line && *line; ) {
+        const char *next = strchr(line, '\n');
+        size_t length = next ? (size_t) (next - line) : strlen(line);
+
+        char backend_str[8];
+        unsigned long long high, low;
+        PrefetchJob job;
+        memset(&job, 0, sizeof(PrefetchJob));
+
+        if (length > 0 && line[0] != '#' &&
+            sscanf(line, "%7s %16llx%16llx", backend_str, &high, &low) == 3) {
+            if (strcmp(backend_str, "cuda") == 0)
+                job.backend = JitBackend::CUDA;
+            else if (strcmp(backend_str, "llvm") == 0)
+                job.backend = JitBackend::LLVM;
+            else
+                jitc_raise("jit_kernel_cache_prefetch(): unknown backend \"%s\"!",
+                           backend_str);
+            job.hash.high64 = (uint64_t) high;
+            job.hash.low64 = (uint64_t) low;
+
+            if (state.backends & (uint32_t) job.backend) {
+                int device = thread_state(job.backend)->device;
+                auto it = state.kernel_cache.find(
+                    KernelKey(job.hash, nullptr, device, 0),
+                    KernelHash::compute_hash(job.hash.high64, device, 0));
+                if (it == state.kernel_cache.end())
+                    jobs.push_back(job);
+            }
+        } else if (length > 0 && line[0] != '#') {
+            jitc_raise("jit_kernel_cache_prefetch(): malformed manifest entry "
+                       "\"%.*s\"!", (int) length, line);
+        }
+
+        line = next ? next + 1 : nullptr;
     }
 
-    bool log = std::max(state.log_level_stderr,
-                        state.log_level_callback) >= LogLevel::Trace;
-    if (success && log)
-        jitc_trace("jit_kernel_write(\"%s\"): compressed %s to %s", filename,
-                  std::string(jitc_mem_string(size_t(source_size) + kernel.size)).c_str(),
-                  std::string(jitc_mem_string(header.compressed_size)).c_str());
+    if (jobs.empty())
+        return 0;
 
-#if !defined(_WIN32)
-    close(fd);
+    auto start = std::chrono::steady_clock::now();
 
-    if (link(filename_tmp, filename) != 0) {
-        jitc_log(Warn,
-            "jit_kernel_write(): could not link cache "
-            "file \"%s\" into file system: %s",
-            filename, strerror(errno));
-        success = false;
+    // Decompress and relocate the kernels in parallel
+    auto load = [](uint32_t index, void *payload) {
+        PrefetchJob &job = (*(PrefetchJob **) payload)[index];
+        job.success = jitc_kernel_load_hash(job.backend, job.hash, job.kernel,
+                                            &job.source);
+    };
+
+    PrefetchJob *payload = jobs.data();
+    jitc_lz4_init();
+
+    /* Unlock while loading */ {
+        unlock_guard guard(state.lock);
+        Task *task = task_submit_dep(nullptr, nullptr, 0, (uint32_t) jobs.size(),
+                                     load, &payload, (uint32_t) sizeof(PrefetchJob *));
+        task_wait_and_release(task);
     }
 
-    if (unlink(filename_tmp) != 0) {
-        jitc_raise("jit_kernel_write(): could not unlink temporary "
-            "file \"%s\": %s",
-            filename_tmp, strerror(errno));
-        success = false;
+    bool verify = jit_flag(JitFlag::KernelCacheVerify);
+    uint32_t loaded = 0;
+
+    for (PrefetchJob &job : jobs) {
+        if (!job.success)
+            continue;
+
+        ThreadState *ts = thread_state(job.backend);
+        KernelKey key(job.hash, verify ? job.source : nullptr, ts->device, 0);
+
+        // Another thread may have compiled the kernel in the meantime
+        auto it = state.kernel_cache.find(
+            key, KernelHash::compute_hash(job.hash.high64, ts->device, 0));
+
+        if (it != state.kernel_cache.end()) {
+            if (job.backend == JitBackend::CUDA)
+                free(job.kernel.data); // not yet loaded into a CUmodule
+            else
+                jitc_kernel_free(-1, job.kernel);
+            free(job.source);
+            continue;
+        }
+
+        if (job.backend == JitBackend::CUDA) {
+            scoped_set_context guard(ts->context);
+            jitc_cuda_link(job.hash, job.kernel);
+        }
+
+        Kernel &kernel = state.kernel_cache.emplace(key, job.kernel).first.value();
+        kernel.last_use = state.kernel_launches;
+        state.kernel_cache_size += kernel.size;
+
+        if (!verify)
+            free(job.source);
+        loaded++;
     }
-#else
-    CloseHandle(fd);
 
-    if (MoveFileW(filename_tmp_w, filename_w) == 0)
-        jitc_log(Warn,
-                "jit_kernel_write(): could not link cache "
-                "file \"%s\" into file system: %u",
-                filename, GetLastError());
-#endif
+    float duration = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
 
-#if DRJIT_CACHE_TRAIN == 1
-    snprintf(filename, sizeof(filename), "%s/.drjit/%016llx%016llx.%s.trn",
-             getenv("HOME"), (unsigned long long) hash.high64,
-             (unsigned long long) hash.low64,
-             backend == JitBackend::CUDA ? "cuda" : "llvm");
-    fd = open(filename, O_CREAT | O_WRONLY, mode);
-    if (fd) {
-        write_retry(temp_in, in_size);
-        close(fd);
+    jitc_log(Info, "jit_kernel_cache_prefetch(): loaded %u/%zu kernels (%s).",
+             loaded, jobs.size(),
+             std::string(jitc_time_string(duration)).c_str());
+
+    return loaded;
+}
+
+char *jitc_kernel_manifest(const KernelHistoryEntry *history) {
+    using Entry = std::tuple<uint32_t, uint64_t, uint64_t>;
+    std::vector<Entry> entries;
+
+    for (const KernelHistoryEntry *e = history; e && e->ir; ++e) {
+        // Only JIT kernels are stored in the disk cache (without OptiX)
+        if (e->type != KernelType::JIT || e->uses_optix)
+            continue;
+        entries.emplace_back((uint32_t) e->backend, e->hash[1], e->hash[0]);
     }
-#endif
 
-    free(temp_out);
-    free(temp_in);
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
 
-    return success;
+    StringBuffer result(64);
+    for (const Entry &e : entries)
+        result.fmt("%s %016llx%016llx\n",
+                   std::get<0>(e) == (uint32_t) JitBackend::CUDA ? "cuda" : "llvm",
+                   (unsigned long long) std::get<1>(e),
+                   (unsigned long long) std::get<2>(e));
+
+    char *str = (char *) malloc_check(result.size() + 1);
+    memcpy(str, result.get(), result.size() + 1);
+    return str;
 }
 
 void jitc_kernel_free(int device_id, const Kernel &kernel) {
     if (device_id == -1) {
         if (kernel.llvm.n_reloc)
             free(kernel.llvm.reloc);
+        delete kernel.llvm.profile;
 #if !defined(_WIN32)
         if (munmap((void *) kernel.data, kernel.size) == -1)
             jitc_fail("jit_kernel_free(): munmap() failed!");
@@ -471,10 +1356,71 @@ void jitc_flush_kernel_cache() {
             state.kernel_cache.size(),
             state.kernel_cache.size() > 1 ? "s" : "");
 
+    jitc_llvm_tier_up_flush();
+    jitc_kernel_write_flush();
+
     for (auto &v : state.kernel_cache) {
         jitc_kernel_free(v.first.device, v.second);
         free(v.first.str);
     }
 
     state.kernel_cache.clear();
+    state.kernel_cache_size = 0;
+    state.literal_history.clear();
+}
+
+void jitc_kernel_cache_trim() {
+    size_t limit_size = state.kernel_cache_limit_size,
+           limit_count = state.kernel_cache_limit_count;
+
+    auto over_budget = [&](size_t size, size_t count) {
+        return (limit_size && size > limit_size) ||
+               (limit_count && count > limit_count);
+    };
+
+    if (!over_budget(state.kernel_cache_size, state.kernel_cache.size()))
+        return;
+
+    /* Evicted kernels may still be referenced by queued launches, which
+       requires a synchronization below. Trim to 7/8 of the budget so that
+       this doesn't happen on every evaluation. */
+    limit_size -= limit_size / 8;
+    limit_count -= limit_count / 8;
+
+    std::vector<std::pair<uint64_t, KernelKey>> entries;
+    entries.reserve(state.kernel_cache.size());
+    for (auto &kv : state.kernel_cache)
+        entries.emplace_back(kv.second.last_use, kv.first);
+
+    std::sort(entries.begin(), entries.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    size_t size = state.kernel_cache_size,
+           count = state.kernel_cache.size(),
+           n_evict = 0;
+
+    while (n_evict < entries.size() && over_budget(size, count)) {
+        auto it = state.kernel_cache.find(entries[n_evict++].second);
+        size -= it.value().size;
+        count--;
+    }
+
+    jitc_log(Info, "jit_kernel_cache_trim(): evicting %zu kernel%s (%s) ..",
+             n_evict, n_evict > 1 ? "s" : "",
+             std::string(jitc_mem_string(state.kernel_cache_size - size)).c_str());
+
+    jitc_sync_all_devices();
+
+    for (size_t i = 0; i < n_evict; ++i) {
+        // The cache could have been flushed while synchronizing
+        auto it = state.kernel_cache.find(entries[i].second);
+        if (it == state.kernel_cache.end())
+            continue;
+
+        state.kernel_cache_size -= it.value().size;
+        jitc_kernel_free(it.key().device, it.value());
+        free(it.key().str);
+        state.kernel_cache.erase(it);
+        state.kernel_evictions++;
+    }
 }
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "hash.h"
+#include <atomic>
 
 using LLVMKernelFunction = void (*)(uint64_t start, uint64_t end, void **ptr);
 using CUmodule = struct CUmod_st *;
@@ -17,12 +18,28 @@ using CUfunction = struct CUfunc_st *;
 using OptixModule = void*;
 using OptixProgramGroup = void*;
 using OptixPipeline = void*;
+struct KernelHistoryEntry;
 enum class JitBackend: uint32_t;
 
+/// Execution time measurements of an LLVM kernel (see jitc_llvm_block_size())
+struct LLVMKernelProfile {
+    /// Accumulated execution time (ns) and size of the measured work units
+    std::atomic<uint64_t> time { 0 };
+    std::atomic<uint64_t> elements { 0 };
+
+#if defined(DRJIT_ENABLE_ITTNOTIFY)
+    void *itt = nullptr;
+#endif
+};
+
 /// Represents a compiled kernel for the three different backends
 struct Kernel {
     void *data;
     uint32_t size;
+
+    /// Value of 'state.kernel_launches' when the kernel was last used (LRU)
+    uint64_t last_use;
+
     union {
         /// 1. CUDA
         struct {
@@ -44,9 +61,14 @@ struct Kernel {
             /// Length of the 'reloc' table
             uint32_t n_reloc;
 
-#if defined(DRJIT_ENABLE_ITTNOTIFY)
-            void *itt;
-#endif
+            /// Optimization tier (0: quick compile, 1: fully optimized)
+            uint32_t tier;
+
+            /// Number of launches of a tier-0 kernel (JitFlag::TieredCompile)
+            uint32_t launches;
+
+            /// Measured cost used to choose the work unit size
+            LLVMKernelProfile *profile;
         } llvm;
 
 #if defined(DRJIT_ENABLE_OPTIX)
@@ -61,6 +83,9 @@ struct Kernel {
     };
 };
 
+/// Maximum size of the on-disk kernel cache in bytes (0: unlimited)
+extern size_t jitc_kernel_cache_disk_limit;
+
 // LZ4 compression dictionary
 static const int jitc_lz4_dict_size = 65536;
 extern char jitc_lz4_dict[];
@@ -72,10 +97,50 @@ extern bool jitc_kernel_load(const char *source, uint32_t source_size,
                              JitBackend backend, XXH128_hash_t hash,
                              Kernel &kernel);
 
+/**
+ * \brief Load a kernel from the disk cache given only its hash
+ *
+ * Returns a copy of the kernel source via 'source' (to be released using
+ * free()). Unlike the other cache functions, this one may be called from
+ * several threads in parallel.
+ */
+extern bool jitc_kernel_load_hash(JitBackend backend, XXH128_hash_t hash,
+                                  Kernel &kernel, char **source);
+
 extern bool jitc_kernel_write(const char *source, uint32_t source_size,
                               JitBackend backend, XXH128_hash_t hash,
                               const Kernel &kernel);
 
+/// Queue a kernel for being written to disk by a background thread
+extern void jitc_kernel_write_async(const char *source, uint32_t source_size,
+                                    JitBackend backend, XXH128_hash_t hash,
+                                    const Kernel &kernel);
+
+/// Wait until all queued kernels have been written to disk
+extern void jitc_kernel_write_flush();
+
 extern void jitc_kernel_free(int device_id, const Kernel &kernel);
 
 extern void jitc_flush_kernel_cache();
+
+/// Evict least recently used kernels when the cache exceeds its budget
+extern void jitc_kernel_cache_trim();
+
+/// Load the kernels listed in a manifest from the disk cache
+extern uint32_t jitc_kernel_prefetch(const char *manifest);
+
+/// Create a manifest listing the kernels of a kernel history
+extern char *jitc_kernel_manifest(const KernelHistoryEntry *history);
+
+/// Rewrite the on-disk kernel cache without unreferenced records
+extern void jitc_kernel_cache_compact();
+
+/// Release the memory mapping of the on-disk kernel cache
+extern void jitc_kernel_cache_shutdown();
+
+/// Switch the on-disk kernel cache to a new directory (takes ownership of 'path')
+#if !defined(_WIN32)
+extern void jitc_kernel_cache_set_path(char *path);
+#else
+extern void jitc_kernel_cache_set_path(wchar_t *path);
+#endif
@@ -12,10 +12,12 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <vector>
+#include "hash.h"
 
 // Forward declarations
 struct Task;
 struct Kernel;
+struct LLVMCompileContext;
 
 /// Current top-level task in the task queue
 extern Task *jitc_task;
@@ -52,6 +54,9 @@ extern uint32_t jitc_llvm_vector_width;
 /// Should the LLVM IR use typed (e.g., "i8*") or untyped ("ptr") pointers?
 extern bool jitc_llvm_opaque_pointers;
 
+/// Number of launches before a tier-0 kernel is recompiled (JitFlag::TieredCompile)
+extern uint32_t jitc_llvm_tier_threshold;
+
 /// LLVM version (parts can equal -1, which means: not sure)
 extern int jitc_llvm_version_major;
 extern int jitc_llvm_version_minor;
@@ -66,22 +71,52 @@ extern bool jitc_llvm_init();
 /// Shut down the LLVM backend
 extern void jitc_llvm_shutdown();
 
-/// Initialize the MCJIT/ORCv2-specific parts of the LLVM backend
-extern bool jitc_llvm_mcjit_init();
-extern bool jitc_llvm_orcv2_init();
+/// Initialize the MCJIT-specific parts of the LLVM backend using a first context
+extern bool jitc_llvm_mcjit_init(LLVMCompileContext *ctx);
 
-/// Shut down the MCJIT/ORCv2-specific parts of the LLVM backend
+/// Shut down the MCJIT-specific parts of the LLVM backend
 extern void jitc_llvm_mcjit_shutdown();
-extern void jitc_llvm_orcv2_shutdown();
+
+/// Set up/release the MCJIT/ORCv2-specific parts of a compilation context
+extern bool jitc_llvm_mcjit_context_init(LLVMCompileContext *ctx);
+extern bool jitc_llvm_orcv2_context_init(LLVMCompileContext *ctx);
+extern void jitc_llvm_mcjit_context_free(LLVMCompileContext *ctx);
+extern void jitc_llvm_orcv2_context_free(LLVMCompileContext *ctx);
 
 /// Run the MCJIT/ORCv2-based compiler on the given module
-extern void jitc_llvm_mcjit_compile(void *llvm_module,
+extern void jitc_llvm_mcjit_compile(LLVMCompileContext *ctx, void *llvm_module,
+                                    const char *kernel_name, int opt_level,
+                                    const std::vector<XXH128_hash_t> &callables,
                                     std::vector<uint8_t *> &symbols);
-extern void jitc_llvm_orcv2_compile(void *llvm_module,
+extern void jitc_llvm_orcv2_compile(LLVMCompileContext *ctx, void *llvm_module,
+                                    const char *kernel_name,
+                                    const std::vector<XXH128_hash_t> &callables,
                                     std::vector<uint8_t *> &symbols);
 
-/// Compile the current IR string and store the resulting kernel into `kernel`
-extern void jitc_llvm_compile(Kernel &kernel);
+/**
+ * \brief Compile the given IR string and store the resulting kernel into `kernel`
+ *
+ * \c callables lists the hashes of the callables referenced by the kernel in
+ * the order expected by its \c @callables table. The function does not access
+ * the global code generation state (\c buffer, \c globals_map, etc.) and
+ * borrows a private \ref LLVMCompileContext, hence several threads may call
+ * it at the same time.
+ *
+ * \c opt_level (1-3) selects the optimization pipeline. Level 1 produces a
+ * tier-0 kernel for \c JitFlag::TieredCompile, higher levels are final.
+ */
+extern void jitc_llvm_compile(const char *buf, size_t buf_size,
+                              const char *kernel_name,
+                              const std::vector<XXH128_hash_t> &callables,
+                              Kernel &kernel, int opt_level = 2);
+
+/// Wait for background recompilations (JitFlag::TieredCompile) and release
+/// the kernels that they replaced
+extern void jitc_llvm_tier_up_flush();
+
+/// Release the tier-0 kernels replaced by recompilations. Expects that no
+/// queued launches remain, see \ref jitc_sync_thread()
+extern void jitc_llvm_tier_up_release();
 
 /// Dump disassembly for the given kernel
 extern void jitc_llvm_disasm(const Kernel &kernel);
@@ -111,6 +111,8 @@ bool jitc_llvm_api_init() {
     LOAD(core, LLVMGetHostCPUName);
     LOAD(core, LLVMGetHostCPUFeatures);
     LOAD(core, LLVMGetGlobalContext);
+    LOAD(core, LLVMContextCreate);
+    LOAD(core, LLVMContextDispose);
     LOAD(core, LLVMCreateDisasm);
     LOAD(core, LLVMDisasmDispose);
     LOAD(core, LLVMSetDisasmOptions);
@@ -139,7 +141,7 @@ bool jitc_llvm_api_init() {
     LOAD(pb_new, LLVMDisposePassBuilderOptions);
     LOAD(pb_new, LLVMRunPasses);
 
-    LOAD(mcjit, LLVMModuleCreateWithName);
+    LOAD(mcjit, LLVMModuleCreateWithNameInContext);
     LOAD(mcjit, LLVMGetExecutionEngineTargetMachine);
     LOAD(mcjit, LLVMCreateMCJITCompilerForModule);
     LOAD(mcjit, LLVMCreateSimpleMCJITMemoryManager);
@@ -252,6 +254,8 @@ void jitc_llvm_api_shutdown() {
     CLEAR(LLVMGetHostCPUName);
     CLEAR(LLVMGetHostCPUFeatures);
     CLEAR(LLVMGetGlobalContext);
+    CLEAR(LLVMContextCreate);
+    CLEAR(LLVMContextDispose);
     CLEAR(LLVMCreateDisasm);
     CLEAR(LLVMDisasmDispose);
     CLEAR(LLVMSetDisasmOptions);
@@ -284,7 +288,7 @@ void jitc_llvm_api_shutdown() {
     CLEAR(LLVMRunPasses);
 
     // MCJIT
-    CLEAR(LLVMModuleCreateWithName);
+    CLEAR(LLVMModuleCreateWithNameInContext);
     CLEAR(LLVMGetExecutionEngineTargetMachine);
     CLEAR(LLVMCreateMCJITCompilerForModule);
     CLEAR(LLVMCreateSimpleMCJITMemoryManager);
@@ -43,6 +43,7 @@
 #  define LLVMDisassembler_Option_PrintImmHex       2
 #  define LLVMDisassembler_Option_AsmPrinterVariant 4
 #  define LLVMReturnStatusAction 2
+#  define LLVMCodeGenLevelLess 1
 #  define LLVMCodeGenLevelAggressive 3
 #  define LLVMRelocPIC 2
 #  define LLVMCodeModelSmall 3
@@ -109,6 +110,8 @@ DR_LLVM_SYM(char *(*LLVMGetDefaultTargetTriple)());
 DR_LLVM_SYM(char *(*LLVMGetHostCPUName)());
 DR_LLVM_SYM(char *(*LLVMGetHostCPUFeatures)());
 DR_LLVM_SYM(LLVMContextRef (*LLVMGetGlobalContext)());
+DR_LLVM_SYM(LLVMContextRef (*LLVMContextCreate)());
+DR_LLVM_SYM(void (*LLVMContextDispose)(LLVMContextRef));
 DR_LLVM_SYM(LLVMDisasmContextRef (*LLVMCreateDisasm)(const char *, void *, int,
                                                      void *, void *));
 DR_LLVM_SYM(void (*LLVMDisasmDispose)(LLVMDisasmContextRef));
@@ -149,7 +152,8 @@ DR_LLVM_SYM(LLVMErrorRef (*LLVMRunPasses)(LLVMModuleRef, const char *,
                                           LLVMPassBuilderOptionsRef));
 
 // API for MCJIT interface
-DR_LLVM_SYM(LLVMModuleRef (*LLVMModuleCreateWithName)(const char *));
+DR_LLVM_SYM(LLVMModuleRef (*LLVMModuleCreateWithNameInContext)(const char *,
+                                                           LLVMContextRef));
 DR_LLVM_SYM(LLVMTargetMachineRef (*LLVMGetExecutionEngineTargetMachine)(
     LLVMExecutionEngineRef));
 DR_LLVM_SYM(LLVMBool (*LLVMCreateMCJITCompilerForModule)(
@@ -22,13 +22,17 @@
 #include "var.h"
 #include "eval.h"
 #include "profiler.h"
+#include <mutex>
 
 static bool jitc_llvm_init_attempted  = false;
 static bool jitc_llvm_init_success    = false;
 static bool jitc_llvm_use_orcv2       = false;
 
 static LLVMDisasmContextRef jitc_llvm_disasm_ctx = nullptr;
-static LLVMContextRef jitc_llvm_context = nullptr;
+
+/// Idle compilation contexts, see jitc_llvm_context_acquire()
+static std::vector<LLVMCompileContext *> jitc_llvm_contexts;
+static std::mutex jitc_llvm_contexts_mutex;
 
 /// String describing the LLVM target
 char *jitc_llvm_target_triple = nullptr;
@@ -45,17 +49,59 @@ uint32_t jitc_llvm_vector_width = 0;
 /// Should the LLVM IR use typed (e.g., "i8*") or untyped ("ptr") pointers?
 bool jitc_llvm_opaque_pointers = false;
 
+/// Number of launches before a tier-0 kernel is recompiled (JitFlag::TieredCompile)
+uint32_t jitc_llvm_tier_threshold = 16;
+
 /// Strings related to the vector width, used by template engine
 char **jitc_llvm_ones_str = nullptr;
 
 /// Current top-level task in the task queue
 Task *jitc_task = nullptr;
 
-/// Reference to the target machine used for compilation
-LLVMTargetMachineRef jitc_llvm_tm = nullptr;
-
 void jitc_llvm_update_strings();
 
+/// Release a compilation context along with its LLVM state
+static void jitc_llvm_context_free(LLVMCompileContext *ctx) {
+    if (jitc_llvm_use_orcv2)
+        jitc_llvm_orcv2_context_free(ctx);
+    else
+        jitc_llvm_mcjit_context_free(ctx);
+    jitc_llvm_memmgr_free(&ctx->memmgr);
+    if (ctx->context)
+        LLVMContextDispose(ctx->context);
+    delete ctx;
+}
+
+/// Fetch an idle compilation context or create a new one
+static LLVMCompileContext *jitc_llvm_context_acquire() {
+    /* Lock guard */ {
+        std::lock_guard<std::mutex> guard(jitc_llvm_contexts_mutex);
+        if (!jitc_llvm_contexts.empty()) {
+            LLVMCompileContext *ctx = jitc_llvm_contexts.back();
+            jitc_llvm_contexts.pop_back();
+            return ctx;
+        }
+    }
+
+    LLVMCompileContext *ctx = new LLVMCompileContext();
+    ctx->context = LLVMContextCreate();
+
+    bool success = jitc_llvm_use_orcv2 ? jitc_llvm_orcv2_context_init(ctx)
+                                       : jitc_llvm_mcjit_context_init(ctx);
+    if (!success) {
+        jitc_llvm_context_free(ctx);
+        jitc_raise("jit_llvm_compile(): could not create a compilation context!");
+    }
+
+    return ctx;
+}
+
+/// Return a compilation context to the pool
+static void jitc_llvm_context_release(LLVMCompileContext *ctx) {
+    std::lock_guard<std::mutex> guard(jitc_llvm_contexts_mutex);
+    jitc_llvm_contexts.push_back(ctx);
+}
+
 bool jitc_llvm_init() {
     if (jitc_llvm_init_attempted)
         return jitc_llvm_init_success;
@@ -89,7 +135,6 @@ bool jitc_llvm_init() {
     jitc_llvm_target_triple = LLVMGetDefaultTargetTriple();
     jitc_llvm_target_cpu = LLVMGetHostCPUName();
     jitc_llvm_target_features = LLVMGetHostCPUFeatures();
-    jitc_llvm_context = LLVMGetGlobalContext();
 
     jitc_llvm_disasm_ctx =
         LLVMCreateDisasm(jitc_llvm_target_triple, nullptr, 0, nullptr, nullptr);
@@ -137,17 +182,27 @@ bool jitc_llvm_init() {
         jitc_llvm_shutdown();
     }
 
-    if (jitc_llvm_api_has_orcv2() && jitc_llvm_orcv2_init()) {
+    // Create a first compilation context to determine the usable JIT interface
+    LLVMCompileContext *ctx = new LLVMCompileContext();
+    ctx->context = LLVMContextCreate();
+
+    if (jitc_llvm_api_has_orcv2() && jitc_llvm_orcv2_context_init(ctx)) {
         jitc_llvm_use_orcv2 = true;
-    } else if (jitc_llvm_api_has_mcjit() && jitc_llvm_mcjit_init()) {
-        jitc_llvm_use_orcv2 = false;
     } else {
-        jitc_log(Warn, "jit_llvm_init(): ORCv2/MCJIT could not be initialized, "
-                       "shutting down LLVM backend..");
-        jitc_llvm_shutdown();
-        return false;
+        jitc_llvm_orcv2_context_free(ctx);
+        jitc_llvm_use_orcv2 = false;
+
+        if (!jitc_llvm_api_has_mcjit() || !jitc_llvm_mcjit_init(ctx)) {
+            jitc_llvm_context_free(ctx);
+            jitc_log(Warn, "jit_llvm_init(): ORCv2/MCJIT could not be initialized, "
+                           "shutting down LLVM backend..");
+            jitc_llvm_shutdown();
+            return false;
+        }
     }
 
+    jitc_llvm_contexts.push_back(ctx);
+
     jitc_llvm_opaque_pointers = jitc_llvm_version_major >= 15;
 
     jitc_llvm_update_strings();
@@ -178,8 +233,9 @@ void jitc_llvm_shutdown() {
 
     jitc_log(Info, "jit_llvm_shutdown()");
 
-    jitc_llvm_memmgr_shutdown();
-    jitc_llvm_orcv2_shutdown();
+    for (LLVMCompileContext *ctx : jitc_llvm_contexts)
+        jitc_llvm_context_free(ctx);
+    jitc_llvm_contexts.clear();
     jitc_llvm_mcjit_shutdown();
 
     LLVMDisposeMessage(jitc_llvm_target_triple);
@@ -193,7 +249,6 @@ void jitc_llvm_shutdown() {
     jitc_llvm_target_cpu = nullptr;
     jitc_llvm_target_features = nullptr;
     jitc_llvm_vector_width = 0;
-    jitc_llvm_context = nullptr;
 
     if (jitc_llvm_ones_str) {
         for (uint32_t i = 0; i < (uint32_t) VarType::Count; ++i)
@@ -317,23 +372,34 @@ void jitc_llvm_disasm(const Kernel &kernel) {
 
 static ProfilerRegion profiler_region_llvm_compile("jit_llvm_compile");
 
-void jitc_llvm_compile(Kernel &kernel) {
+void jitc_llvm_compile(const char *buf, size_t buf_size,
+                       const char *kernel_name,
+                       const std::vector<XXH128_hash_t> &callables,
+                       Kernel &kernel, int opt_level) {
     ProfilerPhase phase(profiler_region_llvm_compile);
 
-    jitc_llvm_memmgr_prepare(buffer.size());
+    LLVMCompileContext *ctx = jitc_llvm_context_acquire();
+    LLVMMemoryManager *mm = &ctx->memmgr;
+
+    struct ContextGuard {
+        LLVMCompileContext *ctx;
+        ~ContextGuard() { jitc_llvm_context_release(ctx); }
+    } ctx_guard { ctx };
+
+    jitc_llvm_memmgr_prepare(mm, buf_size);
 
     LLVMMemoryBufferRef llvm_buf = LLVMCreateMemoryBufferWithMemoryRange(
-        buffer.get(), buffer.size(), kernel_name, 0);
+        buf, buf_size, kernel_name, 0);
     if (unlikely(!llvm_buf))
         jitc_fail("jit_run_compile(): could not create memory buffer!");
 
     // 'buf' is consumed by this function.
     LLVMModuleRef llvm_module = nullptr;
     char *error = nullptr;
-    LLVMParseIRInContext(jitc_llvm_context, llvm_buf, &llvm_module, &error);
+    LLVMParseIRInContext(ctx->context, llvm_buf, &llvm_module, &error);
     if (unlikely(error))
         jitc_fail("jit_llvm_compile(): parsing failed. Please see the LLVM "
-                  "IR and error message below:\n\n%s\n\n%s", buffer.get(), error);
+                  "IR and error message below:\n\n%s\n\n%s", buf, error);
     LLVMDisposeMessage(error);
 
 #if !defined(NDEBUG)
@@ -341,7 +407,7 @@ void jitc_llvm_compile(Kernel &kernel) {
     if (unlikely(status))
         jitc_fail("jit_llvm_compile(): module could not be verified! Please "
                   "see the LLVM IR and error message below:\n\n%s\n\n%s",
-                  buffer.get(), error);
+                  buf, error);
 #endif
     LLVMDisposeMessage(error);
 
@@ -359,8 +425,10 @@ void jitc_llvm_compile(Kernel &kernel) {
         LLVMPassBuilderOptionsSetLoopUnrolling(pb_opt, 0);                    \
         LLVMPassBuilderOptionsSetLoopVectorization(pb_opt, 0);                \
         LLVMPassBuilderOptionsSetSLPVectorization(pb_opt, 0);                 \
+        char passes[16];                                                      \
+        snprintf(passes, sizeof(passes), "default<O%i>", opt_level);          \
         LLVMErrorRef error_ref =                                              \
-            LLVMRunPasses(llvm_module, "default<O2>", jitc_llvm_tm, pb_opt);  \
+            LLVMRunPasses(llvm_module, passes, ctx->tm, pb_opt);              \
         if (error_ref)                                                        \
             jitc_fail(                                                        \
                 "jit_llvm_compile(): failed to run optimization passes: %s!", \
@@ -387,59 +455,63 @@ void jitc_llvm_compile(Kernel &kernel) {
 #endif
 
     std::vector<uint8_t *> reloc(
-        callable_count_unique ? (callable_count_unique + 2) : 1);
+        callables.empty() ? 1 : (callables.size() + 2));
 
     if (jitc_llvm_use_orcv2)
-        jitc_llvm_orcv2_compile(llvm_module, reloc);
+        jitc_llvm_orcv2_compile(ctx, llvm_module, kernel_name, callables, reloc);
     else
-        jitc_llvm_mcjit_compile(llvm_module, reloc);
+        jitc_llvm_mcjit_compile(ctx, llvm_module, kernel_name, opt_level,
+                                callables, reloc);
 
-    if (jitc_llvm_memmgr_got)
+    if (mm->got)
         jitc_fail(
             "jit_llvm_compile(): a global offset table was generated by LLVM, "
             "which typically means that a compiler intrinsic was not supported "
             "by the target architecture. DrJit cannot handle this case "
             "and will terminate the application now. For reference, the "
             "following kernel code was responsible for this problem:\n\n%s",
-            buffer.get());
+            buf);
 
 #if !defined(_WIN32)
-    void *ptr = mmap(nullptr, jitc_llvm_memmgr_offset, PROT_READ | PROT_WRITE,
+    void *ptr = mmap(nullptr, mm->offset, PROT_READ | PROT_WRITE,
                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
     if (ptr == MAP_FAILED)
         jitc_fail("jit_llvm_compile(): could not mmap() memory: %s",
                   strerror(errno));
 #else
-    void *ptr = VirtualAlloc(nullptr, jitc_llvm_memmgr_offset,
+    void *ptr = VirtualAlloc(nullptr, mm->offset,
                              MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
     if (!ptr)
         jitc_fail("jit_llvm_compile(): could not VirtualAlloc() memory: %u", GetLastError());
 #endif
-    memcpy(ptr, jitc_llvm_memmgr_data, jitc_llvm_memmgr_offset);
+    memcpy(ptr, mm->data, mm->offset);
 
     kernel.data = ptr;
-    kernel.size = (uint32_t) jitc_llvm_memmgr_offset;
+    kernel.size = (uint32_t) mm->offset;
     kernel.llvm.n_reloc = (uint32_t) reloc.size();
+    kernel.llvm.tier = opt_level > 1 ? 1 : 0;
+    kernel.llvm.launches = 0;
+    kernel.llvm.profile = new LLVMKernelProfile();
     kernel.llvm.reloc = (void **) malloc_check(sizeof(void *) * reloc.size());
 
     // Relocate function pointers
     for (size_t i = 0; i < reloc.size(); ++i)
-        kernel.llvm.reloc[i] = (uint8_t *) ptr + (reloc[i] - jitc_llvm_memmgr_data);
+        kernel.llvm.reloc[i] = (uint8_t *) ptr + (reloc[i] - mm->data);
 
     // Write address of @callables
     if (kernel.llvm.n_reloc > 1)
         *((void **) kernel.llvm.reloc[1]) = kernel.llvm.reloc + 1;
 
 #if defined(DRJIT_ENABLE_ITTNOTIFY)
-    kernel.llvm.itt = __itt_string_handle_create(kernel_name);
+    kernel.llvm.profile->itt = __itt_string_handle_create(kernel_name);
 #endif
 
 #if !defined(_WIN32)
-    if (mprotect(ptr, jitc_llvm_memmgr_offset, PROT_READ | PROT_EXEC) == -1)
+    if (mprotect(ptr, mm->offset, PROT_READ | PROT_EXEC) == -1)
         jitc_fail("jit_llvm_compile(): mprotect() failed: %s", strerror(errno));
 #else
     DWORD unused;
-    if (VirtualProtect(ptr, jitc_llvm_memmgr_offset, PAGE_EXECUTE_READ, &unused) == 0)
+    if (VirtualProtect(ptr, mm->offset, PAGE_EXECUTE_READ, &unused) == 0)
         jitc_fail("jit_llvm_compile(): VirtualProtect() failed: %u", GetLastError());
 #endif
 }
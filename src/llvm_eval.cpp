@@ -114,7 +114,7 @@ void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group) {
         Variable *v = jitc_var(index);
         uint32_t vti = v->type;
         VarType vt = (VarType) vti;
-        uint32_t size = v->size;
+        size_t size = v->size;
 
         /// If a variable has a custom code generation hook, call it
         if (unlikely(v->extra)) {
@@ -136,27 +136,40 @@ void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group) {
         }
 
         /// Determine source/destination address of input/output parameters
-        if (v->param_type == ParamType::Input && size == 1 && vt == VarType::Pointer) {
+        if (jitc_var_scratch(v).param_type == ParamType::Input && size == 1 && vt == VarType::Pointer) {
             // Case 1: load a pointer address from the parameter array
             fmt("    $v_p1 = getelementptr inbounds {i8*}, {i8**} %params, i32 $o\n"
                 "    $v = load {i8*}, {i8**} $v_p1, align 8, !alias.scope !2\n",
                 v, v, v, v);
-        } else if (v->param_type != ParamType::Register) {
-            // Case 2: read an input/output parameter
+        } else if (jitc_var_scratch(v).param_type == ParamType::Input && v->is_literal()) {
+            // Case 2: load a hoisted literal from the parameter array and broadcast it
+            fmt( "    $v_p1 = getelementptr inbounds {i8*}, {i8**} %params, i32 $o\n"
+                "{    $v_p2 = bitcast i8** $v_p1 to $t*\n|}"
+                 "    $v_0 = load $t, {$t*} $v_p{2|1}, align 8, !alias.scope !2\n"
+                 "    $v_1 = insertelement $T undef, $t $v_0, i32 0\n"
+                 "    $v = shufflevector $T $v_1, $T undef, <$w x i32> $z\n",
+                v, v,
+                v, v, v,
+                v, v, v, v,
+                v, v, v, v,
+                v, v, v, v);
+        } else if (jitc_var_scratch(v).param_type != ParamType::Register) {
+            // Case 3: read an input/output parameter
 
             fmt( "    $v_p1 = getelementptr inbounds {i8*}, {i8**} %params, i32 $o\n"
                  "    $v_p{2|3} = load {i8*}, {i8**} $v_p1, align 8, !alias.scope !2\n"
                 "{    $v_p3 = bitcast i8* $v_p2 to $m*\n|}",
                 v, v, v, v, v, v, v);
 
-            // For output parameters and non-scalar inputs
-            if (v->param_type != ParamType::Input || size != 1)
+            // For non-scalar parameters and outputs of scalar kernels
+            if (size != 1 || (jitc_var_scratch(v).param_type == ParamType::Output &&
+                              group.size == 1))
                 fmt( "    $v_p{4|5} = getelementptr inbounds $m, {$m*} $v_p3, i64 %index\n"
                     "{    $v_p5 = bitcast $m* $v_p4 to $M*\n|}",
                     v, v, v, v, v, v, v, v);
         }
 
-        if (likely(v->param_type == ParamType::Input)) {
+        if (likely(jitc_var_scratch(v).param_type == ParamType::Input)) {
             if (v->is_literal())
                 continue;
 
@@ -195,7 +208,17 @@ void jitc_llvm_assemble(ThreadState *ts, ScheduledGroup group) {
 
         v = jitc_var(index); // `v` might have been invalidated during its assembly
 
-        if (v->param_type == ParamType::Output) {
+        if (jitc_var_scratch(v).param_type == ParamType::Output && size != group.size) {
+            /* Scalar output of a larger kernel (see jitc_eval_fuse_scalars()).
+               All lanes compute the same value, store the first one. */
+            if (vt != VarType::Bool)
+                fmt("    $v_e = extractelement $V, i32 0\n", v, v);
+            else
+                fmt("    $v_b = extractelement $V, i32 0\n"
+                    "    $v_e = zext i1 $v_b to i8\n", v, v, v, v);
+            fmt("    store atomic $m $v_e, {$m*} $v_p3 unordered, align $a, !noalias !2\n",
+                v, v, v, v, v);
+        } else if (jitc_var_scratch(v).param_type == ParamType::Output) {
             if (vt != VarType::Bool) {
                 fmt("    store $V, {$T*} $v_p5, align $A, !noalias !2, !nontemporal !3\n",
                     v, v, v, v);
@@ -324,7 +347,7 @@ void jitc_llvm_assemble_func(const char *name, uint32_t inst_id,
             fmt( "    $v_i{0|1} = getelementptr inbounds i8, {i8*} %params, i64 $u\n"
                 "{    $v_i1 = bitcast i8* $v_i0 to $M*\n|}"
                  "    $v$s = load $M, {$M*} $v_i1, align $A\n",
-                v, v->param_offset * width,
+                v, jitc_var_scratch(v).param_offset * width,
                 v, v, v,
                 v, vt == VarType::Bool ? "_i2" : "", v, v, v, v);
 
@@ -772,7 +795,7 @@ static void jitc_llvm_render_var(uint32_t index, Variable *v) {
 
                 if (is_bool) { // Restore
                     v->type = (uint32_t) VarType::Bool;
-                    fmt("    $v = trunc <$w x i8> %b$u_2 to <$w x i1>\n", v, v->reg_index);
+                    fmt("    $v = trunc <$w x i8> %b$u_2 to <$w x i1>\n", v, jitc_var_scratch(v).reg_index);
                 }
             }
             break;
@@ -808,11 +831,17 @@ static void jitc_llvm_render_var(uint32_t index, Variable *v) {
             break;
 
         case VarKind::DefaultMask:
-            fmt("    $v_0 = trunc i64 %end to i32\n"
-                "    $v_1 = insertelement <$w x i32> undef, i32 $v_0, i32 0\n"
-                "    $v_2 = shufflevector <$w x i32> $v_1, <$w x i32> undef, <$w x i32> zeroinitializer\n"
-                "    $v = icmp ult <$w x i32> $v, $v_2\n",
-                v, v, v, v, v, v, a0, v);
+            // Compare 64-bit lane indices, the array size may exceed 2^32
+            fmt("    $v_0 = insertelement <$w x i64> undef, i64 %index, i32 0\n"
+                "    $v_1 = shufflevector <$w x i64> $v_0, <$w x i64> undef, <$w x i32> zeroinitializer\n"
+                "    $v_2 = add <$w x i64> $v_1, <",
+                v, v, v, v, v);
+            for (uint32_t i = 0; i < jitc_llvm_vector_width; ++i)
+                fmt("i64 $u$s", i, i + 1 < jitc_llvm_vector_width ? ", " : ">\n");
+            fmt("    $v_3 = insertelement <$w x i64> undef, i64 %end, i32 0\n"
+                "    $v_4 = shufflevector <$w x i64> $v_3, <$w x i64> undef, <$w x i32> zeroinitializer\n"
+                "    $v = icmp ult <$w x i64> $v_2, $v_4\n",
+                v, v, v, v, v, v);
             break;
 
         case VarKind::Printf:
@@ -821,8 +850,8 @@ static void jitc_llvm_render_var(uint32_t index, Variable *v) {
 
         case VarKind::Dispatch:
             jitc_var_vcall_assemble((VCall *) state.extra[index].callback_data,
-                                    a0->reg_index, a1->reg_index, a2->reg_index,
-                                    a3 ? a3->reg_index : 0);
+                                    jitc_var_scratch(a0).reg_index, jitc_var_scratch(a1).reg_index, jitc_var_scratch(a2).reg_index,
+                                    a3 ? jitc_var_scratch(a3).reg_index : 0);
             break;
 
         case VarKind::TraceRay:
@@ -1105,7 +1134,7 @@ static void jitc_llvm_render_printf(uint32_t index, const Variable *v,
     jitc_register_global(buffer.get() + buffer_offset);
     buffer.rewind_to(buffer_offset);
 
-    uint32_t idx = v->reg_index;
+    uint32_t idx = jitc_var_scratch(v).reg_index;
 
     fmt("    br label %l$u_start\n\n"
         "l$u_start: ; ---- printf_async() ----\n"
@@ -1228,7 +1257,7 @@ static void jitc_llvm_render_stmt(uint32_t index, const Variable *v, bool in_fun
             }
 
             if (tname == 'r' || tname == 'i')
-                buffer.put_u32(dep->reg_index);
+                buffer.put_u32(jitc_var_scratch(dep).reg_index);
         }
     } while (c != '\0');
 
@@ -1247,7 +1276,7 @@ void jitc_llvm_ray_trace(uint32_t func, uint32_t scene, int shadow_ray,
                      VarType::UInt32, VarType::UInt32 };
 
     bool placeholder = false, dirty = false;
-    uint32_t size = 0;
+    size_t size = 0;
     for (uint32_t i = 0; i < n_args; ++i) {
         const Variable *v = jitc_var(in[i]);
         if ((VarType) v->type != types[i])
@@ -1293,7 +1322,7 @@ void jitc_llvm_ray_trace(uint32_t func, uint32_t scene, int shadow_ray,
         valid = steal(jitc_var_select(valid, minus_one, zero));
     }
 
-    jitc_log(InfoSym, "jitc_llvm_ray_trace(): tracing %u %sray%s%s", size,
+    jitc_log(InfoSym, "jitc_llvm_ray_trace(): tracing %zu %sray%s%s", size,
              shadow_ray ? "shadow " : "", size != 1 ? "s" : "",
              placeholder ? " (part of a recorded computation)" : "");
 
@@ -1444,9 +1473,9 @@ static void jitc_llvm_render_trace(uint32_t index, const Variable *v,
              "    $v_func_ptr = inttoptr i64 $v_func_i64 to {i8*}\n"
              "    $v_tfar_{0|1} = getelementptr inbounds i8, {i8*} %buffer, i32 $u\n"
             "{    $v_tfar_1 = bitcast i8* $v_tfar_0 to <$w x $s> *\n|}",
-            v->reg_index,
-            v->reg_index,
-            v, func->reg_index,
+            jitc_var_scratch(v).reg_index,
+            jitc_var_scratch(v).reg_index,
+            v, jitc_var_scratch(func).reg_index,
             v, v,
             v, offset_tfar,
             v, v, tname_tfar);
@@ -1459,7 +1488,7 @@ static void jitc_llvm_render_trace(uint32_t index, const Variable *v,
         // Get original mask, to be overwritten at every iteration
         fmt("    $v_mask_value = load <$w x i32>, {<$w x i32>*} $v_in_0_1, align 64\n"
             "    br label %l$u_check\n",
-            v, v, v->reg_index);
+            v, v, jitc_var_scratch(v).reg_index);
 
         // =====================================================
         // 2. Move on to the next instance & check if finished
@@ -1472,13 +1501,13 @@ static void jitc_llvm_render_trace(uint32_t index, const Variable *v,
             "    $v_next = inttoptr i64 $v_next_i64 to {i8*}\n"
             "    $v_valid = icmp ne {i8*} $v_next, null\n"
             "    br i1 $v_valid, label %l$u_call, label %l$u_end\n",
-            v->reg_index,
-            v, scene->reg_index, v->reg_index, v, v->reg_index,
+            jitc_var_scratch(v).reg_index,
+            v, jitc_var_scratch(scene).reg_index, jitc_var_scratch(v).reg_index, v, jitc_var_scratch(v).reg_index,
             v, v,
             v, v,
             v, v,
             v, v,
-            v, v->reg_index, v->reg_index);
+            v, jitc_var_scratch(v).reg_index, jitc_var_scratch(v).reg_index);
 
         // =====================================================
         // 3. Perform ray tracing call to each unique instance
@@ -1492,7 +1521,7 @@ static void jitc_llvm_render_trace(uint32_t index, const Variable *v,
             "    $v_active = icmp eq <$w x {i8*}> $v_scene, $v_bcast_2\n"
             "    $v_active_2 = select <$w x i1> $v_active, <$w x i32> $v_mask_value, <$w x i32> $z\n"
             "    store <$w x i32> $v_active_2, {<$w x i32>*} $v_in_0_1, align 64\n",
-            v->reg_index,
+            jitc_var_scratch(v).reg_index,
             v, tname_tfar, tname_tfar, v, float_size * width,
             v, v,
             v, v,
@@ -1518,7 +1547,7 @@ static void jitc_llvm_render_trace(uint32_t index, const Variable *v,
             v, v, tname_tfar, v, tname_tfar, v,
             tname_tfar, v, tname_tfar, v, float_size * width,
             v, v, v,
-            v->reg_index, v->reg_index);
+            jitc_var_scratch(v).reg_index, jitc_var_scratch(v).reg_index);
     }
 
     offset = (8 * float_size + 4) * width;
@@ -1604,10 +1633,9 @@ void jitc_var_vcall_assemble_llvm(VCall *vcall, uint32_t vcall_reg,
     uint32_t offset = 0;
     for (uint32_t i = 0; i < (uint32_t) vcall->in.size(); ++i) {
         uint32_t index = vcall->in[i];
-        auto it = state.variables.find(index);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(index);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
 
         fmt(
              "    %u$u_in_$u_{0|1} = getelementptr inbounds i8, {i8*} %buffer, i32 $u\n"
@@ -1636,10 +1664,9 @@ void jitc_var_vcall_assemble_llvm(VCall *vcall, uint32_t vcall_reg,
     offset = 0;
     for (uint32_t i = 0; i < n_out; ++i) {
         uint32_t index = vcall->out_nested[i];
-        auto it = state.variables.find(index);
-        if (it == state.variables.end())
+        const Variable *v2 = state.variables.find(index);
+        if (!v2)
             continue;
-        const Variable *v2 = &it->second;
 
         fmt( "    %u$u_tmp_$u_{0|1} = getelementptr inbounds i8, {i8*} %u$u_out, i64 $u\n"
             "{    %u$u_tmp_$u_1 = bitcast i8* %u$u_tmp_$u_0 to $M*\n|}"
@@ -1725,20 +1752,19 @@ void jitc_var_vcall_assemble_llvm(VCall *vcall, uint32_t vcall_reg,
     for (uint32_t i = 0; i < n_out; ++i) {
         uint32_t index = vcall->out_nested[i],
                  index_2 = vcall->out[i];
-        auto it = state.variables.find(index);
-        if (it == state.variables.end())
+        const Variable *v = state.variables.find(index);
+        if (!v)
             continue;
-        uint32_t size = type_size[it->second.type],
+        uint32_t size = type_size[v->type],
                  load_offset = offset;
         offset += size * width;
 
         // Skip if outer access expired
-        auto it2 = state.variables.find(index_2);
-        if (it2 == state.variables.end())
+        const Variable *v2 = state.variables.find(index_2);
+        if (!v2)
             continue;
 
-        const Variable *v2 = &it2.value();
-        if (v2->reg_index == 0 || v2->param_type == ParamType::Input)
+        if (jitc_var_scratch(v2).reg_index == 0 || jitc_var_scratch(v2).param_type == ParamType::Input)
             continue;
 
         VarType vt = (VarType) v2->type;
@@ -4,18 +4,18 @@
 #include "log.h"
 
 static uint32_t jitc_llvm_patch_loc = 0;
-static LLVMExecutionEngineRef m_jitc_llvm_engine = nullptr;
-extern LLVMTargetMachineRef jitc_llvm_tm;
 
 /// Create a MCJIT compilation engine configured for use with Dr.Jit
-LLVMExecutionEngineRef jitc_llvm_engine_create(LLVMModuleRef mod_) {
+LLVMExecutionEngineRef jitc_llvm_engine_create(LLVMCompileContext *ctx,
+                                               LLVMModuleRef mod_,
+                                               unsigned opt_level) {
     LLVMMCJITCompilerOptions options;
-    options.OptLevel = LLVMCodeGenLevelAggressive;
+    options.OptLevel = opt_level;
     options.CodeModel = LLVMCodeModelSmall;
     options.NoFramePointerElim = false;
     options.EnableFastISel = false;
     options.MCJMM = LLVMCreateSimpleMCJITMemoryManager(
-        nullptr,
+        &ctx->memmgr,
         jitc_llvm_memmgr_allocate,
         jitc_llvm_memmgr_allocate_data,
         jitc_llvm_memmgr_finalize,
@@ -23,7 +23,7 @@ LLVMExecutionEngineRef jitc_llvm_engine_create(LLVMModuleRef mod_) {
 
     LLVMModuleRef mod = mod_;
     if (mod == nullptr)
-        mod = LLVMModuleCreateWithName("drjit");
+        mod = LLVMModuleCreateWithNameInContext("drjit", ctx->context);
 
     LLVMExecutionEngineRef engine = nullptr;
     char *error = nullptr;
@@ -33,7 +33,7 @@ LLVMExecutionEngineRef jitc_llvm_engine_create(LLVMModuleRef mod_) {
         return nullptr;
     }
 
-    jitc_llvm_tm = LLVMGetExecutionEngineTargetMachine(engine);
+    ctx->tm = LLVMGetExecutionEngineTargetMachine(engine);
 
     if (jitc_llvm_patch_loc) {
         uint32_t *base = (uint32_t *) LLVMGetExecutionEngineTargetMachine(engine);
@@ -43,12 +43,25 @@ LLVMExecutionEngineRef jitc_llvm_engine_create(LLVMModuleRef mod_) {
     return engine;
 }
 
-bool jitc_llvm_mcjit_init() {
-#if defined(DRJIT_DYNAMIC_LLVM) && !defined(__aarch64__)
-    m_jitc_llvm_engine = jitc_llvm_engine_create(nullptr);
-    if (!m_jitc_llvm_engine)
+bool jitc_llvm_mcjit_context_init(LLVMCompileContext *ctx) {
+    ctx->engine = jitc_llvm_engine_create(ctx, nullptr,
+                                          LLVMCodeGenLevelAggressive);
+    return ctx->engine != nullptr;
+}
+
+void jitc_llvm_mcjit_context_free(LLVMCompileContext *ctx) {
+    if (ctx->engine) {
+        LLVMDisposeExecutionEngine(ctx->engine);
+        ctx->engine = nullptr;
+    }
+    ctx->tm = nullptr;
+}
+
+bool jitc_llvm_mcjit_init(LLVMCompileContext *ctx) {
+    if (!jitc_llvm_mcjit_context_init(ctx))
         return false;
 
+#if defined(DRJIT_DYNAMIC_LLVM) && !defined(__aarch64__)
     /**
        The following is horrible, but it works and was without alternative.
 
@@ -76,7 +89,7 @@ bool jitc_llvm_mcjit_init() {
     */
 
     uint32_t *base =
-        (uint32_t *) LLVMGetExecutionEngineTargetMachine(m_jitc_llvm_engine);
+        (uint32_t *) LLVMGetExecutionEngineTargetMachine(ctx->engine);
     jitc_llvm_patch_loc = 142 - 16;
 
     int key[3] = { 0, 1, 3 };
@@ -100,23 +113,25 @@ bool jitc_llvm_mcjit_init() {
 }
 
 void jitc_llvm_mcjit_shutdown() {
-    if (m_jitc_llvm_engine) {
-        LLVMDisposeExecutionEngine(m_jitc_llvm_engine);
-        m_jitc_llvm_engine = nullptr;
-    }
     jitc_llvm_patch_loc = 0;
-    jitc_llvm_tm = nullptr;
 }
 
-void jitc_llvm_mcjit_compile(void *llvm_module,
+void jitc_llvm_mcjit_compile(LLVMCompileContext *ctx, void *llvm_module,
+                             const char *kernel_name, int opt_level,
+                             const std::vector<XXH128_hash_t> &callables,
                              std::vector<uint8_t*> &symbols) {
-    if (m_jitc_llvm_engine)
-        LLVMDisposeExecutionEngine(m_jitc_llvm_engine);
+    if (ctx->engine)
+        LLVMDisposeExecutionEngine(ctx->engine);
 
-    m_jitc_llvm_engine = jitc_llvm_engine_create((LLVMModuleRef) llvm_module);
+    // Tier-0 kernels (see JitFlag::TieredCompile) use a cheaper code generator
+    ctx->engine = jitc_llvm_engine_create(
+        ctx, (LLVMModuleRef) llvm_module,
+        opt_level > 1 ? LLVMCodeGenLevelAggressive : LLVMCodeGenLevelLess);
+    if (unlikely(!ctx->engine))
+        jitc_fail("jit_llvm_compile(): could not create MCJIT engine!");
 
     auto resolve = [&](const char *name) -> uint8_t * {
-        uint8_t *p = (uint8_t *) LLVMGetFunctionAddress(m_jitc_llvm_engine, name);
+        uint8_t *p = (uint8_t *) LLVMGetFunctionAddress(ctx->engine, name);
         if (unlikely(!p))
             jitc_fail("jit_llvm_compile(): internal error: could not resolve "
                       "symbol \"%s\"!\n", name);
@@ -127,18 +142,14 @@ void jitc_llvm_mcjit_compile(void *llvm_module,
     symbols[symbol_pos++] = resolve(kernel_name);
 
     /// Does the kernel perform virtual function calls via @callables?
-    if (callable_count_unique) {
+    if (!callables.empty()) {
         symbols[symbol_pos++] = resolve("callables");
 
-        for (auto const &kv: globals_map) {
-            if (!kv.first.callable)
-                continue;
-
+        for (const XXH128_hash_t &hash : callables) {
             char name_buf[38];
             snprintf(name_buf, sizeof(name_buf), "func_%016llx%016llx",
-                     (unsigned long long) kv.first.hash.high64,
-                     (unsigned long long) kv.first.hash.low64);
-
+                     (unsigned long long) hash.high64,
+                     (unsigned long long) hash.low64);
             symbols[symbol_pos++] = resolve(name_buf);
         }
     }
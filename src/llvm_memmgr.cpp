@@ -2,21 +2,11 @@
 #include "log.h"
 #include <cstring>
 
-/// Internal storage used by the memory manager
-uint8_t *jitc_llvm_memmgr_data = nullptr;
-
-/// Was a global offset table (GOT) generated?
-bool jitc_llvm_memmgr_got = false;
-
-/// Current position within 'jitc_llvm_memmgr_data'
-size_t jitc_llvm_memmgr_offset = 0;
-
-/// Size of the buffer backing 'jitc_llvm_memmgr_data'
-static size_t jitc_llvm_memmgr_size = 0;
-
-uint8_t *jitc_llvm_memmgr_allocate(void * /* opaque */, uintptr_t size,
+uint8_t *jitc_llvm_memmgr_allocate(void *opaque, uintptr_t size,
                                    unsigned align, unsigned /* id */,
                                    const char *name) {
+    LLVMMemoryManager *mm = (LLVMMemoryManager *) opaque;
+
     if (align == 0)
         align = 16;
 
@@ -28,20 +18,21 @@ uint8_t *jitc_llvm_memmgr_allocate(void * /* opaque */, uintptr_t size,
        instruction, and a function call to an external library was generated
        along with a relocation, which we don't support. */
     if (strncmp(name, ".got", 4) == 0)
-        jitc_llvm_memmgr_got = true;
+        mm->got = true;
 
-    size_t offset_align = (jitc_llvm_memmgr_offset + (align - 1)) / align * align;
+    size_t offset_align = (mm->offset + (align - 1)) / align * align;
 
-    // Zero-fill including padding region
-    memset(jitc_llvm_memmgr_data + jitc_llvm_memmgr_offset, 0,
-           offset_align - jitc_llvm_memmgr_offset);
+    if (offset_align + size > mm->size) {
+        mm->offset = offset_align + size;
+        return nullptr;
+    }
 
-    jitc_llvm_memmgr_offset = offset_align + size;
+    // Zero-fill including padding region
+    memset(mm->data + mm->offset, 0, offset_align - mm->offset);
 
-    if (jitc_llvm_memmgr_offset > jitc_llvm_memmgr_size)
-        return nullptr;
+    mm->offset = offset_align + size;
 
-    return jitc_llvm_memmgr_data + offset_align;
+    return mm->data + offset_align;
 }
 
 uint8_t *jitc_llvm_memmgr_allocate_data(void *opaque, uintptr_t size,
@@ -58,40 +49,47 @@ LLVMBool jitc_llvm_memmgr_finalize(void * /* opaque */, char ** /* err */) {
 void jitc_llvm_memmgr_destroy(void * /* opaque */) { }
 
 
-void jitc_llvm_memmgr_prepare(size_t size) {
+void jitc_llvm_memmgr_prepare(LLVMMemoryManager *mm, size_t size) {
     // Central assumption: LLVM text IR is much larger than the resulting generated code.
     size_t target_size = size * 10;
 
-    if (jitc_llvm_memmgr_size <= target_size) {
+    if (mm->size <= target_size) {
 #if !defined(_WIN32)
-        free(jitc_llvm_memmgr_data);
-        if (posix_memalign((void **) &jitc_llvm_memmgr_data, 4096, target_size))
+        free(mm->data);
+        if (posix_memalign((void **) &mm->data, 4096, target_size)) {
+            mm->data = nullptr;
+            mm->size = 0;
             jitc_raise("jit_llvm_compile(): could not allocate %zu bytes of memory!", target_size);
+        }
 #else
-        _aligned_free(jitc_llvm_memmgr_data);
-        jitc_llvm_memmgr_data = (uint8_t *) _aligned_malloc(target_size, 4096);
-        if (!jitc_llvm_memmgr_data)
+        _aligned_free(mm->data);
+        mm->data = (uint8_t *) _aligned_malloc(target_size, 4096);
+        if (!mm->data) {
+            mm->size = 0;
             jitc_raise("jit_llvm_compile(): could not allocate %zu bytes of memory!", target_size);
+        }
 #endif
-        jitc_llvm_memmgr_size = target_size;
+        mm->size = target_size;
     }
 
-    jitc_llvm_memmgr_offset = 0;
+    mm->offset = 0;
+    mm->got = false;
 }
 
-void jitc_llvm_memmgr_shutdown() {
+void jitc_llvm_memmgr_free(LLVMMemoryManager *mm) {
 #if !defined(_WIN32)
-    free(jitc_llvm_memmgr_data);
+    free(mm->data);
 #else
-    _aligned_free(jitc_llvm_memmgr_data);
+    _aligned_free(mm->data);
 #endif
 
-    jitc_llvm_memmgr_data = nullptr;
-    jitc_llvm_memmgr_size = 0;
-    jitc_llvm_memmgr_offset = 0;
-    jitc_llvm_memmgr_got = false;
+    mm->data = nullptr;
+    mm->size = 0;
+    mm->offset = 0;
+    mm->got = false;
 }
 
-void* jitc_llvm_memmgr_create_context(void *) { return nullptr; }
+/// ORCv2 passes the 'LLVMMemoryManager' pointer through this callback
+void* jitc_llvm_memmgr_create_context(void *opaque) { return opaque; }
 
 void jitc_llvm_memmgr_notify_terminating(void *) { }
@@ -2,22 +2,55 @@
 
 #include "llvm_api.h"
 
-/// Internal storage used by the memory manager
-extern uint8_t *jitc_llvm_memmgr_data;
-
-/// Current position within 'jitc_llvm_memmgr_data'
-extern size_t jitc_llvm_memmgr_offset;
-
-/// Was a global offset table (GOT) generated?
-extern bool jitc_llvm_memmgr_got;
+/// Memory arena into which LLVM writes the sections of a compiled kernel
+struct LLVMMemoryManager {
+    /// Internal storage used by the memory manager
+    uint8_t *data = nullptr;
+
+    /// Size of the buffer backing 'data'
+    size_t size = 0;
+
+    /// Current position within 'data'
+    size_t offset = 0;
+
+    /// Was a global offset table (GOT) generated?
+    bool got = false;
+};
+
+/**
+ * \brief State needed to compile LLVM IR on one thread at a time
+ *
+ * LLVM contexts, JIT instances, and target machines must not be used by
+ * multiple threads at once. Each compilation therefore borrows a context from
+ * a pool (see \ref jitc_llvm_compile()), which allows several kernels to be
+ * compiled concurrently.
+ */
+struct LLVMCompileContext {
+    /// LLVM context owning the parsed modules
+    LLVMContextRef context = nullptr;
+
+    /// Target machine used by the optimization pass pipeline
+    LLVMTargetMachineRef tm = nullptr;
+
+    /// Arena receiving the generated machine code
+    LLVMMemoryManager memmgr;
+
+    /// ORCv2: JIT instance and its main dylib
+    LLVMOrcLLJITRef lljit = nullptr;
+    LLVMOrcJITDylibRef lljit_dylib = nullptr;
+
+    /// MCJIT: execution engine of the most recently compiled module
+    LLVMExecutionEngineRef engine = nullptr;
+};
 
 /// Prepare the LLVM compilation memory manager for IR of a given size
-extern void jitc_llvm_memmgr_prepare(size_t size);
+extern void jitc_llvm_memmgr_prepare(LLVMMemoryManager *mm, size_t size);
 
 /// Release resources held by the LLVM compilation memory manager
-extern void jitc_llvm_memmgr_shutdown();
+extern void jitc_llvm_memmgr_free(LLVMMemoryManager *mm);
 
 /// -------------- LLVM C-API memory manager callbacks --------------
+/// (the opaque pointer always refers to an 'LLVMMemoryManager' instance)
 
 extern uint8_t *jitc_llvm_memmgr_allocate(void *, uintptr_t, unsigned, unsigned, const char *);
 extern uint8_t *jitc_llvm_memmgr_allocate_data(void *, uintptr_t, unsigned,
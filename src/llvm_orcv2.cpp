@@ -4,17 +4,13 @@
 #include "log.h"
 #include "eval.h"
 
-static LLVMOrcLLJITRef jitc_llvm_lljit = nullptr;
-static LLVMOrcJITDylibRef jitc_llvm_lljit_dylib = nullptr;
-extern LLVMTargetMachineRef jitc_llvm_tm;
-
-LLVMOrcObjectLayerRef oll_creator(void *, LLVMOrcExecutionSessionRef es, const char *) {
+LLVMOrcObjectLayerRef oll_creator(void *mm, LLVMOrcExecutionSessionRef es, const char *) {
 #if defined(LLVM_VERSION_MAJOR) && LLVM_VERSION_MAJOR < 16
-    (void) es;
+    (void) mm; (void) es;
     jitc_fail("OrcV2 interface is not usable in LLVM versions < 16");
 #else
     return LLVMOrcCreateRTDyldObjectLinkingLayerWithMCJITMemoryManagerLikeCallbacks(
-        es, nullptr,
+        es, mm,
         jitc_llvm_memmgr_create_context,
         jitc_llvm_memmgr_notify_terminating,
         jitc_llvm_memmgr_allocate,
@@ -25,17 +21,14 @@ LLVMOrcObjectLayerRef oll_creator(void *, LLVMOrcExecutionSessionRef es, const c
 #endif
 }
 
-bool jitc_llvm_orcv2_init() {
-    if (jitc_llvm_lljit)
-        return true;
-
+bool jitc_llvm_orcv2_context_init(LLVMCompileContext *ctx) {
     LLVMTargetRef target_ref;
     char *err_str = nullptr;
     if (LLVMGetTargetFromTriple(jitc_llvm_target_triple, &target_ref, &err_str)) {
-        LLVMDisposeMessage(err_str);
         jitc_log(Warn,
                  "jitc_llvm_init(): could not obtain target, ORCv2 "
                  "initialization failed: %s", err_str);
+        LLVMDisposeMessage(err_str);
         return false;
     }
 
@@ -47,7 +40,7 @@ bool jitc_llvm_orcv2_init() {
             jitc_llvm_target_features, LLVMCodeGenLevelAggressive, LLVMRelocPIC,
             LLVMCodeModelSmall);
         if (i == 0)
-            jitc_llvm_tm = tm;
+            ctx->tm = tm;
     }
 
     LLVMOrcJITTargetMachineBuilderRef machine_builder =
@@ -59,36 +52,38 @@ bool jitc_llvm_orcv2_init() {
                                                   machine_builder);
 
     LLVMOrcLLJITBuilderSetObjectLinkingLayerCreator(lljit_builder, oll_creator,
-                                                    (void *) NULL);
+                                                    (void *) &ctx->memmgr);
 
-    LLVMErrorRef err = LLVMOrcCreateLLJIT(&jitc_llvm_lljit, lljit_builder);
+    LLVMErrorRef err = LLVMOrcCreateLLJIT(&ctx->lljit, lljit_builder);
     if (err)
         jitc_fail("jit_llvm_compile(): could not create LLJIT: %s",
                   LLVMGetErrorMessage(err));
 
-    jitc_llvm_lljit_dylib = LLVMOrcLLJITGetMainJITDylib(jitc_llvm_lljit);
+    ctx->lljit_dylib = LLVMOrcLLJITGetMainJITDylib(ctx->lljit);
 
     return true;
 }
 
-void jitc_llvm_orcv2_shutdown() {
-    if (!jitc_llvm_lljit)
-        return;
-
-    LLVMErrorRef err = LLVMOrcDisposeLLJIT(jitc_llvm_lljit);
-    if (err)
-        jitc_fail("jit_llvm_orcv2_shutdown(): could not dispose LLJIT: %s",
-                  LLVMGetErrorMessage(err));
-    LLVMDisposeTargetMachine(jitc_llvm_tm);
+void jitc_llvm_orcv2_context_free(LLVMCompileContext *ctx) {
+    if (ctx->lljit) {
+        LLVMErrorRef err = LLVMOrcDisposeLLJIT(ctx->lljit);
+        if (err)
+            jitc_fail("jit_llvm_shutdown(): could not dispose LLJIT: %s",
+                      LLVMGetErrorMessage(err));
+    }
+    if (ctx->tm)
+        LLVMDisposeTargetMachine(ctx->tm);
 
-    jitc_llvm_lljit = nullptr;
-    jitc_llvm_lljit_dylib = nullptr;
-    jitc_llvm_tm = nullptr;
+    ctx->lljit = nullptr;
+    ctx->lljit_dylib = nullptr;
+    ctx->tm = nullptr;
 }
 
-void jitc_llvm_orcv2_compile(void *llvm_module,
+void jitc_llvm_orcv2_compile(LLVMCompileContext *ctx, void *llvm_module,
+                             const char *kernel_name,
+                             const std::vector<XXH128_hash_t> &callables,
                              std::vector<uint8_t*> &symbols) {
-    LLVMErrorRef err = LLVMOrcJITDylibClear(jitc_llvm_lljit_dylib);
+    LLVMErrorRef err = LLVMOrcJITDylibClear(ctx->lljit_dylib);
     if (err)
         jitc_fail("jit_llvm_compile(): could not clear dylib: %s",
                   LLVMGetErrorMessage(err));
@@ -98,8 +93,7 @@ void jitc_llvm_orcv2_compile(void *llvm_module,
         LLVMOrcCreateNewThreadSafeModule((LLVMModuleRef) llvm_module, ts_ctx);
     LLVMOrcDisposeThreadSafeContext(ts_ctx);
 
-    err = LLVMOrcLLJITAddLLVMIRModule(jitc_llvm_lljit, jitc_llvm_lljit_dylib,
-                                      ts_mod);
+    err = LLVMOrcLLJITAddLLVMIRModule(ctx->lljit, ctx->lljit_dylib, ts_mod);
 
     if (err)
         jitc_fail("jit_llvm_compile(): could not add module: %s",
@@ -107,7 +101,7 @@ void jitc_llvm_orcv2_compile(void *llvm_module,
 
     auto resolve = [&](const char *name) -> uint8_t * {
         LLVMOrcExecutorAddress p;
-        LLVMErrorRef err = LLVMOrcLLJITLookup(jitc_llvm_lljit, &p, name);
+        LLVMErrorRef err = LLVMOrcLLJITLookup(ctx->lljit, &p, name);
         if (err)
             jitc_fail("jit_llvm_compile(): could not resolve symbol: %s",
                       LLVMGetErrorMessage(err));
@@ -118,17 +112,14 @@ void jitc_llvm_orcv2_compile(void *llvm_module,
     symbols[symbol_pos++] = resolve(kernel_name);
 
     /// Does the kernel perform virtual function calls via @callables?
-    if (callable_count_unique) {
+    if (!callables.empty()) {
         symbols[symbol_pos++] = resolve("callables");
 
-        for (auto const &kv: globals_map) {
-            if (!kv.first.callable)
-                continue;
-
+        for (const XXH128_hash_t &hash : callables) {
             char name_buf[38];
             snprintf(name_buf, sizeof(name_buf), "func_%016llx%016llx",
-                     (unsigned long long) kv.first.hash.high64,
-                     (unsigned long long) kv.first.hash.low64);
+                     (unsigned long long) hash.high64,
+                     (unsigned long long) hash.low64);
             symbols[symbol_pos++] = resolve(name_buf);
         }
     }
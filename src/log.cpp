@@ -18,8 +18,9 @@
 #  include <windows.h>
 #endif
 
-static StringBuffer log_buffer;
-static char jitc_string_buf[64];
+// Thread-local, since kernels are compiled and written to disk asynchronously
+static thread_local StringBuffer log_buffer;
+static thread_local char jitc_string_buf[64];
 
 void jitc_log(LogLevel log_level, const char* fmt, ...) {
     if (unlikely(log_level <= state.log_level_stderr)) {
@@ -66,15 +66,15 @@ uint32_t jitc_var_loop_init(size_t n_indices, uint32_t **indices) {
 
     // Determine the variable size
     JitBackend backend = (JitBackend) jitc_var(*indices[0])->backend;
-    uint32_t size = 0;
+    size_t size = 0;
     bool dirty = false;
 
     for (size_t i = 0; i < n_indices; ++i) {
         const Variable *v = jitc_var(*indices[i]);
-        uint32_t vsize = v->size;
+        size_t vsize = v->size;
         if (size != 0 && vsize != 1 && size != 1 && vsize != size)
             jitc_raise("jit_var_loop_init(): loop state variables have an "
-                       "inconsistent size (%u vs %u)!", vsize, size);
+                       "inconsistent size (%zu vs %zu)!", vsize, size);
         if (vsize > size)
             size = vsize;
 
@@ -125,7 +125,7 @@ uint32_t jitc_var_loop_init(size_t n_indices, uint32_t **indices) {
     }
 
 
-    jitc_log(Debug, "jit_var_loop_init(r%u, n_indices=%zu, size=%u)",
+    jitc_log(Debug, "jit_var_loop_init(r%u, n_indices=%zu, size=%zu)",
              (uint32_t) result, n_indices, size);
 
     return result.release();
@@ -133,7 +133,7 @@ uint32_t jitc_var_loop_init(size_t n_indices, uint32_t **indices) {
 
 uint32_t jitc_var_loop_cond(uint32_t loop_init, uint32_t cond,
                             size_t n_indices, uint32_t **indices) {
-    uint32_t size;
+    size_t size;
     JitBackend backend;
     {
         Variable *v = jitc_var(loop_init);
@@ -208,7 +208,8 @@ uint32_t jitc_var_loop(const char *name, uint32_t loop_init,
     // =====================================================
 
     bool placeholder = false;
-    uint32_t size = 1, n_invariant = 0;
+    size_t size = 1;
+    uint32_t n_invariant = 0;
     {
         const Variable *v = jitc_var(loop->cond);
         if ((VarType) v->type != VarType::Bool)
@@ -262,14 +263,14 @@ uint32_t jitc_var_loop(const char *name, uint32_t loop_init,
 
         if (size != v1->size && size != 1 && v1->size != 1)
             jitc_raise("jit_var_loop(): initial shape of loop state variable %zu (r%u) "
-                       "is incompatible with the loop (%u vs %u entries)!",
+                       "is incompatible with the loop (%zu vs %zu entries)!",
                        i, index_1, size, v1->size);
 
         size = std::max(size, v1->size);
 
         if (size != vo->size && size != 1 && vo->size != 1)
             jitc_raise("jit_var_loop(): final shape of loop state variable %zu (r%u) "
-                       "is incompatible with the loop (%u vs %u entries)!",
+                       "is incompatible with the loop (%zu vs %zu entries)!",
                        i, index_o, size, vo->size);
         size = std::max(size, vo->size);
 
@@ -308,7 +309,7 @@ uint32_t jitc_var_loop(const char *name, uint32_t loop_init,
 
     jitc_log(InfoSym,
              "jit_var_loop(loop_init=r%u, loop_cond=r%u): loop (\"%s\") with "
-             "%zu loop variable%s, %u side effect%s, %u elements%s%s",
+             "%zu loop variable%s, %u side effect%s, %zu elements%s%s",
              loop_init, loop_cond, name, n_indices, n_indices == 1 ? "" : "s",
              loop->se_count, loop->se_count == 1 ? "" : "s", size, temp,
              placeholder ? " (part of a recorded computation)" : "");
@@ -593,7 +594,7 @@ static void jitc_var_loop_dfs(tsl::robin_set<uint32_t, UInt32Hasher> &set, uint3
 static size_t jitc_var_loop_simplify(Loop *loop, tsl::robin_set<uint32_t, UInt32Hasher> &visited) {
     loop->simplify = false;
 
-    if (state.variables.find(loop->end) == state.variables.end())
+    if (!state.variables.find(loop->end))
         return 0;
 
     const uint32_t n = (uint32_t) loop->in.size();
@@ -706,7 +707,7 @@ void jitc_var_loop_simplify() {
 
 static void jitc_var_loop_assemble_init(const Variable *, const Extra &extra) {
     Loop *loop = (Loop *) extra.callback_data;
-    uint32_t loop_reg = jitc_var(loop->init)->reg_index;
+    uint32_t loop_reg = jitc_var_scratch(jitc_var(loop->init)).reg_index;
 
     if (loop->backend == JitBackend::LLVM) {
         buffer.fmt("    br label %%l_%u_start\n", loop_reg);
@@ -721,8 +722,8 @@ static void jitc_var_loop_assemble_init(const Variable *, const Extra &extra) {
 
 static void jitc_var_loop_assemble_cond(const Variable *, const Extra &extra) {
     Loop *loop = (Loop *) extra.callback_data;
-    uint32_t loop_reg = jitc_var(loop->init)->reg_index,
-             mask_reg = jitc_var(loop->cond)->reg_index,
+    uint32_t loop_reg = jitc_var_scratch(jitc_var(loop->init)).reg_index,
+             mask_reg = jitc_var_scratch(jitc_var(loop->cond)).reg_index,
              width = jitc_llvm_vector_width;
 
     if (loop->backend == JitBackend::CUDA) {
@@ -745,8 +746,8 @@ static void jitc_var_loop_assemble_cond(const Variable *, const Extra &extra) {
 
 static void jitc_var_loop_assemble_end(const Variable *, const Extra &extra) {
     Loop *loop = (Loop *) extra.callback_data;
-    uint32_t loop_reg = jitc_var(loop->init)->reg_index,
-             mask_reg = jitc_var(loop->cond)->reg_index;
+    uint32_t loop_reg = jitc_var_scratch(jitc_var(loop->init)).reg_index,
+             mask_reg = jitc_var_scratch(jitc_var(loop->cond)).reg_index;
 
     if (loop->backend == JitBackend::LLVM)
         buffer.fmt("    br label %%l_%u_tail\n"
@@ -757,29 +758,27 @@ static void jitc_var_loop_assemble_end(const Variable *, const Extra &extra) {
 
     uint32_t width = jitc_llvm_vector_width;
     for (size_t i = 0; i < loop->in_body.size(); ++i) {
-        auto it_in = state.variables.find(loop->in_cond[i]),
-             it_out = state.variables.find(loop->out_body[i]);
+        const Variable *v_in = state.variables.find(loop->in_cond[i]),
+                       *v_out = state.variables.find(loop->out_body[i]);
 
-        if (it_in == state.variables.end())
+        if (!v_in)
             continue;
-        else if (it_out == state.variables.end())
+        else if (!v_out)
             jitc_fail("jit_var_loop_assemble_end(): internal error!");
 
-        const Variable *v_in = &it_in->second,
-                       *v_out = &it_out->second;
-        uint32_t vti = it_in->second.type;
+        uint32_t vti = v_in->type;
 
         if (loop->backend == JitBackend::LLVM) {
             buffer.fmt("    %s%u_final = select <%u x i1> %%p%u, <%u x %s> %s%u, "
                        "<%u x %s> %s%u\n",
-                       type_prefix[vti], v_in->reg_index, width, mask_reg, width,
-                       type_name_llvm[vti], type_prefix[vti], v_out->reg_index,
+                       type_prefix[vti], jitc_var_scratch(v_in).reg_index, width, mask_reg, width,
+                       type_name_llvm[vti], type_prefix[vti], jitc_var_scratch(v_out).reg_index,
                        width, type_name_llvm[vti], type_prefix[vti],
-                       v_in->reg_index);
+                       jitc_var_scratch(v_in).reg_index);
         } else {
             buffer.fmt("    mov.%s %s%u, %s%u;\n", type_name_ptx[vti],
-                       type_prefix[vti], v_in->reg_index, type_prefix[vti],
-                       v_out->reg_index);
+                       type_prefix[vti], jitc_var_scratch(v_in).reg_index, type_prefix[vti],
+                       jitc_var_scratch(v_out).reg_index);
         }
 
         n_variables++;
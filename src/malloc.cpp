@@ -11,11 +11,17 @@
 #include "log.h"
 #include "util.h"
 #include "profiler.h"
+#include <atomic>
 
 #if !defined(_WIN32)
 #  include <sys/mman.h>
 #endif
 
+#if defined(__linux__)
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
 // Try to use huge pages for allocations > 2M (only on Linux)
 #if defined(__linux__)
 #  define DRJIT_HUGEPAGE 1
@@ -25,8 +31,21 @@
 
 #define DRJIT_HUGEPAGE_SIZE (2 * 1024 * 1024)
 
+/// Allocations up to this size are rounded to a power of two
+#define DRJIT_MALLOC_SMALL 4096
+
+/// Allocations from this size onward use finer size classes
+#define DRJIT_MALLOC_LARGE (64 * 1024 * 1024)
+
+/// Number of size classes per power of two for regular and large allocations
+#define DRJIT_MALLOC_CLASSES 4
+#define DRJIT_MALLOC_CLASSES_LARGE 8
+
+/// Number of larger size classes that are searched to reuse a large allocation
+#define DRJIT_MALLOC_BEST_FIT 2
+
 static_assert(
-    sizeof(tsl::detail_robin_hash::bucket_entry<AllocUsedMap::value_type, false>) == 24,
+    sizeof(tsl::detail_robin_hash::bucket_entry<AllocUsedMap::value_type, false>) == 32,
     "AllocUsedMap: incorrect bucket size, likely an issue with padding/packing!");
 
 const char *alloc_type_name[(int) AllocType::Count] = {
@@ -40,6 +59,9 @@ const char *alloc_type_name_short[(int) AllocType::Count] = {
     "device     "
 };
 
+/// Counter used to order the entries of the allocation cache by age
+static std::atomic<uint64_t> alloc_free_time { 0 };
+
 // Round an unsigned integer up to a power of two
 size_t round_pow2(size_t x) {
     x -= 1;
@@ -57,6 +79,88 @@ uint32_t round_pow2(uint32_t x) {
     return x + 1;
 }
 
+/* Round up to the next size class. Small sizes are rounded to a power of two.
+   Every larger power-of-two interval is split into DRJIT_MALLOC_CLASSES
+   (or DRJIT_MALLOC_CLASSES_LARGE) classes, which bounds the waste to 25%
+   (12.5%) while keeping the number of distinct sizes small to facilitate
+   re-use. */
+size_t jitc_malloc_class(size_t size) {
+    if (size <= DRJIT_MALLOC_SMALL)
+        return round_pow2(size);
+
+    size_t classes = size >= DRJIT_MALLOC_LARGE ? DRJIT_MALLOC_CLASSES_LARGE
+                                                : DRJIT_MALLOC_CLASSES,
+           step = round_pow2(size) / 2 / classes;
+
+    return (size + step - 1) / step * step;
+}
+
+
+/// Policy for large host allocations, see \ref jit_malloc_set_policy()
+uint32_t jitc_malloc_policy = (uint32_t) MallocPolicy::Default;
+
+#if defined(__linux__)
+#  define DRJIT_MPOL_INTERLEAVE 3
+#  define DRJIT_MPOL_F_MEMS_ALLOWED 4
+#  define DRJIT_NUMA_MAX_NODES 1024
+
+/// Interleave the pages of a memory region across all permitted NUMA nodes
+static void numa_interleave(void *ptr, size_t size) {
+    static unsigned long mask[DRJIT_NUMA_MAX_NODES / (8 * sizeof(long))];
+    static int node_count = -1;
+
+    if (node_count < 0) {
+        int mode = 0;
+        if (syscall(SYS_get_mempolicy, &mode, mask,
+                    (unsigned long) DRJIT_NUMA_MAX_NODES, nullptr,
+                    (unsigned long) DRJIT_MPOL_F_MEMS_ALLOWED) != 0) {
+            node_count = 0;
+        } else {
+            int count = 0;
+            for (unsigned long m : mask)
+                count += __builtin_popcountl(m);
+            node_count = count;
+        }
+    }
+
+    // Nothing to do on machines with a single NUMA node
+    if (node_count <= 1)
+        return;
+
+    syscall(SYS_mbind, ptr, size, DRJIT_MPOL_INTERLEAVE, mask,
+            (unsigned long) DRJIT_NUMA_MAX_NODES, 0u);
+}
+#endif
+
+#if !defined(_WIN32)
+/* Fault in the pages of a new memory region using all workers of the thread
+   pool. Each worker touches one contiguous chunk, mirroring how jitc_run()
+   partitions kernels into contiguous blocks, so that the operating system's
+   first-touch policy spreads the region over the NUMA nodes of the workers */
+static void numa_first_touch(void *ptr, size_t size) {
+    uint32_t workers = pool_size();
+    if (workers <= 1)
+        return;
+
+    size_t chunk = (size + workers - 1) / workers;
+    chunk = (chunk + DRJIT_HUGEPAGE_SIZE - 1) / DRJIT_HUGEPAGE_SIZE * DRJIT_HUGEPAGE_SIZE;
+
+    struct Payload { uint8_t *ptr; size_t size, chunk; };
+    Payload payload{ (uint8_t *) ptr, size, chunk };
+
+    Task *task = task_submit_dep(
+        nullptr, nullptr, 0, (uint32_t) ((size + chunk - 1) / chunk),
+        [](uint32_t index, void *p) {
+            Payload *payload = (Payload *) p;
+            size_t start = (size_t) index * payload->chunk,
+                   end = std::min(start + payload->chunk, payload->size);
+            memset(payload->ptr + start, 0, end - start);
+        },
+        &payload, sizeof(Payload), nullptr, 1);
+
+    task_wait_and_release(task);
+}
+#endif
 
 static void *aligned_malloc(size_t size) {
 #if !defined(_WIN32)
@@ -66,25 +170,55 @@ static void *aligned_malloc(size_t size) {
         int rv = posix_memalign(&ptr, 64, size);
         return rv == 0 ? ptr : nullptr;
     } else {
-        void *ptr;
+        uint32_t policy = jitc_malloc_policy;
+        void *ptr = MAP_FAILED;
 
 #if DRJIT_HUGEPAGE
-        // Attempt to allocate a 2M page directly
-        ptr = mmap(0, size, PROT_READ | PROT_WRITE,
-                   MAP_PRIVATE | MAP_ANON | MAP_HUGETLB, -1, 0);
-        if (ptr != MAP_FAILED)
-            return ptr;
+        bool huge_pages = policy & (uint32_t) MallocPolicy::HugePages;
+
+        /* Attempt to allocate 2M pages directly. This is limited to size
+           classes that are a multiple of 2M, since the mapping would
+           otherwise be larger than the size recorded by the allocator */
+        if (huge_pages && size % DRJIT_HUGEPAGE_SIZE == 0)
+            ptr = mmap(0, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANON | MAP_HUGETLB, -1, 0);
+
+        if (ptr == MAP_FAILED && huge_pages) {
+            /* Otherwise, map a slightly larger region of 4K pages and trim it
+               to a 2M-aligned range that transparent huge pages can back */
+            uint8_t *base = (uint8_t *) mmap(0, size + DRJIT_HUGEPAGE_SIZE,
+                                             PROT_READ | PROT_WRITE,
+                                             MAP_PRIVATE | MAP_ANON, -1, 0);
+            if (base != (uint8_t *) MAP_FAILED) {
+                uintptr_t offset = (uintptr_t) base % DRJIT_HUGEPAGE_SIZE;
+                size_t head = offset ? (DRJIT_HUGEPAGE_SIZE - offset) : 0,
+                       tail = DRJIT_HUGEPAGE_SIZE - head;
+                if (head)
+                    munmap(base, head);
+                if (tail)
+                    munmap(base + head + size, tail);
+                ptr = base + head;
+
+                // .. and advise the OS to convert to 2M pages
+                madvise(ptr, size, MADV_HUGEPAGE);
+            }
+        }
 #endif
 
         // Allocate 4K pages
-        ptr = mmap(0, size, PROT_READ | PROT_WRITE,
-                   MAP_PRIVATE | MAP_ANON, -1, 0);
+        if (ptr == MAP_FAILED)
+            ptr = mmap(0, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANON, -1, 0);
 
-#if DRJIT_HUGEPAGE
-        // .. and advise the OS to convert to 2M pages
-        if (ptr != MAP_FAILED)
-            madvise(ptr, size, MADV_HUGEPAGE);
+        if (ptr == MAP_FAILED)
+            return nullptr;
+
+#if defined(__linux__)
+        if (policy & (uint32_t) MallocPolicy::NumaInterleave)
+            numa_interleave(ptr, size);
 #endif
+        if (policy & (uint32_t) MallocPolicy::NumaFirstTouch)
+            numa_first_touch(ptr, size);
 
         return ptr;
     }
@@ -105,10 +239,14 @@ static void aligned_free(void *ptr, size_t size) {
 #endif
 }
 
+static void jitc_malloc_trim(AllocType type, size_t amount);
+
 void* jitc_malloc(AllocType type, size_t size) {
     if (size == 0)
         return nullptr;
 
+    size_t requested = size;
+
     if ((type != AllocType::Host && type != AllocType::HostAsync) ||
         jitc_llvm_vector_width < 16) {
         // Round up to the next multiple of 64 bytes
@@ -118,10 +256,7 @@ void* jitc_malloc(AllocType type, size_t size) {
         size = (size + packet_size - 1) / packet_size * packet_size;
     }
 
-    /* Round 'size' to the next larger power of two. This is somewhat
-       wasteful, but reduces the number of different sizes that an allocation
-       can have to a manageable amount that facilitates re-use. */
-    size = round_pow2(size);
+    size = jitc_malloc_class(size);
 
     JitBackend backend =
         (type == AllocType::Device || type == AllocType::HostPinned)
@@ -139,22 +274,43 @@ void* jitc_malloc(AllocType type, size_t size) {
     const char *descr = nullptr;
     void *ptr = nullptr;
 
-    /* Try to reuse a freed allocation */ {
+    /* Try to reuse a freed allocation. Large allocations may also reuse a
+       slightly larger block (best fit) */ {
         lock_guard guard(state.alloc_free_lock);
-        auto it = state.alloc_free.find(ai);
-
-        if (it != state.alloc_free.end()) {
-            std::vector<void *> &list = it.value();
-            if (!list.empty()) {
-                ptr = list.back();
-                list.pop_back();
-                descr = "reused";
+        int attempts = size >= DRJIT_MALLOC_LARGE ? 1 + DRJIT_MALLOC_BEST_FIT : 1;
+        size_t size_i = size;
+
+        for (int i = 0; i < attempts; ++i) {
+            auto it = state.alloc_free.find(alloc_info_encode(size_i, type, device));
+
+            if (it != state.alloc_free.end()) {
+                std::vector<AllocFree> &list = it.value();
+                if (!list.empty()) {
+                    ptr = list.back().ptr;
+                    list.pop_back();
+                    descr = "reused";
+                    size = size_i;
+                    ai = alloc_info_encode(size, type, device);
+                    break;
+                }
             }
+
+            size_i = jitc_malloc_class(size_i + 1);
         }
     }
 
     // Otherwise, allocate memory
     if (unlikely(!ptr)) {
+        /* Stay below the soft memory limit by trimming the allocation cache.
+           Trim down to 7/8 of the limit so that this happens infrequently */
+        size_t limit = state.alloc_limit[(int) type],
+               target = state.alloc_allocated[(int) type] + size,
+               cached = state.alloc_allocated[(int) type] -
+                        state.alloc_usage[(int) type];
+        if (unlikely(limit && target > limit && cached > 0))
+            jitc_malloc_trim(
+                type, std::min(cached, target - std::min(target, limit / 8 * 7)));
+
         for (int i = 0; i < 2; ++i) {
             unlock_guard guard(state.lock);
             /* Temporarily release the main lock */ {
@@ -193,8 +349,9 @@ void* jitc_malloc(AllocType type, size_t size) {
         jitc_raise("jit_malloc(): out of memory! Could not allocate %zu bytes "
                    "of %s memory.", size, alloc_type_name[(int) type]);
 
-    state.alloc_used.emplace((uintptr_t) ptr, ai);
+    state.alloc_used.emplace((uintptr_t) ptr, AllocUsed{ ai, requested });
     state.alloc_usage[(int) type] += size;
+    state.alloc_requested[(int) type] += requested;
 
     (void) descr; // don't warn if tracing is disabled
     if (ts)
@@ -214,15 +371,17 @@ void jitc_free(void *ptr) {
     auto it = state.alloc_used.find((uintptr_t) ptr);
     if (unlikely(it == state.alloc_used.end()))
         jitc_raise("jit_free(): unknown address " DRJIT_PTR "!", (uintptr_t) ptr);
-    AllocInfo info = it->second;
+    AllocInfo info = it->second.info;
+    size_t requested = it->second.requested;
     state.alloc_used.erase(it);
 
     auto [size, type, device] = alloc_info_decode(info);
     state.alloc_usage[(int) type] -= size;
+    state.alloc_requested[(int) type] -= requested;
 
     if (type != AllocType::HostPinned) {
         lock_guard guard(state.alloc_free_lock);
-        state.alloc_free[info].push_back(ptr);
+        state.alloc_free[info].push_back({ ptr, alloc_free_time++ });
     } else {
         /* Host-pinned memory is released asynchronously by inserting
            an event into the CUDA stream */
@@ -240,7 +399,7 @@ void jitc_free(void *ptr) {
                 ReleaseRecord *r2 = (ReleaseRecord *) p;
                 {
                     lock_guard guard(state.alloc_free_lock);
-                    state.alloc_free[r2->info].push_back(r2->ptr);
+                    state.alloc_free[r2->info].push_back({ r2->ptr, alloc_free_time++ });
                 }
                 free(r2);
             },
@@ -268,7 +427,8 @@ void* jitc_malloc_migrate(void *ptr, AllocType dst_type, int move) {
     if (unlikely(it == state.alloc_used.end()))
         jitc_raise("jit_malloc_migrate(): unknown address " DRJIT_PTR "!", (uintptr_t) ptr);
 
-    auto [size, src_type, device] = alloc_info_decode(it->second);
+    auto [size, src_type, device] = alloc_info_decode(it->second.info);
+    size_t requested = it->second.requested;
 
     JitBackend src_backend =
         (src_type == AllocType::Device || src_type == AllocType::HostPinned)
@@ -282,11 +442,11 @@ void* jitc_malloc_migrate(void *ptr, AllocType dst_type, int move) {
         if (move) {
             return ptr;
         } else {
-            void *ptr_new = jitc_malloc(dst_type, size);
+            void *ptr_new = jitc_malloc(dst_type, requested);
             if (dst_type == AllocType::Host)
-                memcpy(ptr_new, ptr, size);
+                memcpy(ptr_new, ptr, requested);
             else
-                jitc_memcpy_async(src_backend, ptr_new, ptr, size);
+                jitc_memcpy_async(src_backend, ptr_new, ptr, requested);
             return ptr_new;
         }
     }
@@ -298,11 +458,13 @@ void* jitc_malloc_migrate(void *ptr, AllocType dst_type, int move) {
             state.alloc_usage[(int) dst_type] += size;
             state.alloc_allocated[(int) src_type] -= size;
             state.alloc_allocated[(int) dst_type] += size;
-            it.value() = alloc_info_encode(size, dst_type, device);
+            state.alloc_requested[(int) src_type] -= requested;
+            state.alloc_requested[(int) dst_type] += requested;
+            it.value().info = alloc_info_encode(size, dst_type, device);
             return ptr;
         } else {
-            void *ptr_new = jitc_malloc(dst_type, size);
-            jitc_memcpy_async(src_backend, ptr_new, ptr, size);
+            void *ptr_new = jitc_malloc(dst_type, requested);
+            jitc_memcpy_async(src_backend, ptr_new, ptr, requested);
 
             // When copying from the host, wait for the operation to finish
             if (src_type == AllocType::Host)
@@ -321,7 +483,7 @@ void* jitc_malloc_migrate(void *ptr, AllocType dst_type, int move) {
     if (dst_type == AllocType::Host) // Upgrade from host to host-pinned memory
         dst_type = AllocType::HostPinned;
 
-    void *ptr_new = jitc_malloc(dst_type, size);
+    void *ptr_new = jitc_malloc(dst_type, requested);
     jitc_trace("jit_malloc_migrate(" DRJIT_PTR " -> " DRJIT_PTR ", %s -> %s)",
               (uintptr_t) ptr, (uintptr_t) ptr_new,
               alloc_type_name[(int) src_type],
@@ -330,15 +492,15 @@ void* jitc_malloc_migrate(void *ptr, AllocType dst_type, int move) {
     scoped_set_context guard(ts->context);
     if (src_type == AllocType::Host) {
         // Host -> Device memory, create an intermediate host-pinned array
-        void *tmp = jitc_malloc(AllocType::HostPinned, size);
-        memcpy(tmp, ptr, size);
+        void *tmp = jitc_malloc(AllocType::HostPinned, requested);
+        memcpy(tmp, ptr, requested);
         cuda_check(cuMemcpyAsync((CUdeviceptr) ptr_new,
-                                 (CUdeviceptr) tmp, size,
+                                 (CUdeviceptr) tmp, requested,
                                  ts->stream));
         jitc_free(tmp);
     } else {
         cuda_check(cuMemcpyAsync((CUdeviceptr) ptr_new,
-                                 (CUdeviceptr) ptr, size,
+                                 (CUdeviceptr) ptr, requested,
                                  ts->stream));
     }
 
@@ -348,44 +510,15 @@ void* jitc_malloc_migrate(void *ptr, AllocType dst_type, int move) {
     return ptr_new;
 }
 
-static bool jitc_flush_malloc_cache_warned = false;
-
-static ProfilerRegion profiler_region_flush_malloc_cache("jit_flush_malloc_cache");
-
-/// Release all unused memory to the GPU / OS
-void jitc_flush_malloc_cache(bool warn) {
-    if (warn && !jitc_flush_malloc_cache_warned) {
-        jitc_log(
-            Warn,
-            "jit_flush_malloc_cache(): Dr.Jit exhausted the available memory and had "
-            "to flush its allocation cache to free up additional memory. This "
-            "is an expensive operation and will have a negative effect on "
-            "performance. You may want to change your computation so that it "
-            "uses less memory. This warning will only be displayed once.");
-
-        jitc_flush_malloc_cache_warned = true;
-    }
-    ProfilerPhase profiler(profiler_region_flush_malloc_cache);
-
-    AllocInfoMap alloc_free;
-
-    // Another synchronization to be sure that 'alloc_free' can be released
-    jitc_sync_all_devices();
-
-    /* Critical section */ {
-        lock_guard guard(state.alloc_free_lock);
-        alloc_free.swap(state.alloc_free);
-    }
-
-    size_t trim_count[(int) AllocType::Count] = { 0 },
-           trim_size [(int) AllocType::Count] = { 0 };
-
+/// Return the blocks in 'release' to the GPU / OS (temporarily releases 'state.lock')
+static void jitc_malloc_release(const AllocInfoMap &release, size_t *trim_count,
+                                size_t *trim_size) {
     /* Temporarily release the main lock */ {
         unlock_guard guard(state.lock);
 
-        for (auto& kv : alloc_free) {
+        for (auto& kv : release) {
             auto [size, type, device] = alloc_info_decode(kv.first);
-            const std::vector<void *> &entries = kv.second;
+            const std::vector<AllocFree> &entries = kv.second;
 
             trim_count[(int) type] += entries.size();
             trim_size[(int) type] += size * entries.size();
@@ -396,11 +529,11 @@ void jitc_flush_malloc_cache(bool warn) {
                         const Device &dev = state.devices[device];
                         scoped_set_context guard2(dev.context);
                         if (dev.memory_pool) {
-                            for (void *ptr : entries)
-                                cuda_check(cuMemFreeAsync((CUdeviceptr) ptr, dev.stream));
+                            for (const AllocFree &e : entries)
+                                cuda_check(cuMemFreeAsync((CUdeviceptr) e.ptr, dev.stream));
                         } else {
-                            for (void *ptr : entries)
-                                cuda_check(cuMemFree((CUdeviceptr) ptr));
+                            for (const AllocFree &e : entries)
+                                cuda_check(cuMemFree((CUdeviceptr) e.ptr));
                         }
                     }
                     break;
@@ -409,22 +542,131 @@ void jitc_flush_malloc_cache(bool warn) {
                     if (state.backends & (uint32_t) JitBackend::CUDA) {
                         const Device &dev = state.devices[device];
                         scoped_set_context guard2(dev.context);
-                        for (void *ptr : entries)
-                            cuda_check(cuMemFreeHost(ptr));
+                        for (const AllocFree &e : entries)
+                            cuda_check(cuMemFreeHost(e.ptr));
                     }
                     break;
 
                 case AllocType::Host:
                 case AllocType::HostAsync:
-                    for (void *ptr : entries)
-                        aligned_free(ptr, size);
+                    for (const AllocFree &e : entries)
+                        aligned_free(e.ptr, size);
                     break;
 
                 default:
-                    jitc_fail("jit_flush_malloc_cache(): unsupported allocation type!");
+                    jitc_fail("jitc_malloc_release(): unsupported allocation type!");
             }
         }
     }
+}
+
+/**
+ * Release at least 'amount' bytes of cached blocks of the given type to the
+ * GPU / OS. Blocks are processed in the order in which they were freed, so
+ * that recently used size classes remain in the cache.
+ */
+static void jitc_malloc_trim(AllocType type, size_t amount) {
+    struct Cursor {
+        AllocInfo info;
+        std::vector<AllocFree> *list;
+        size_t size, pos;
+    };
+
+    AllocInfoMap release;
+    std::vector<Cursor> cursors;
+
+    /* Critical section */ {
+        lock_guard guard(state.alloc_free_lock);
+
+        for (auto it = state.alloc_free.begin(); it != state.alloc_free.end(); ++it) {
+            auto [size, type_i, device] = alloc_info_decode(it->first);
+            (void) device;
+            if (type_i == type && !it->second.empty())
+                cursors.push_back(Cursor{ it->first, &it.value(), size, 0 });
+        }
+
+        // Merge the per-class free lists (each ordered by age) using a min-heap
+        auto newer = [](const Cursor *a, const Cursor *b) {
+            return (*a->list)[a->pos].time > (*b->list)[b->pos].time;
+        };
+
+        std::vector<Cursor *> heap;
+        heap.reserve(cursors.size());
+        for (Cursor &c : cursors)
+            heap.push_back(&c);
+        std::make_heap(heap.begin(), heap.end(), newer);
+
+        size_t released = 0;
+        while (released < amount && !heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), newer);
+            Cursor *c = heap.back();
+            released += c->size;
+            if (++c->pos < c->list->size())
+                std::push_heap(heap.begin(), heap.end(), newer);
+            else
+                heap.pop_back();
+        }
+
+        for (Cursor &c : cursors) {
+            if (c.pos == 0)
+                continue;
+            std::vector<AllocFree> &list = *c.list;
+            release[c.info].assign(list.begin(), list.begin() + c.pos);
+            list.erase(list.begin(), list.begin() + c.pos);
+        }
+    }
+
+    if (release.empty())
+        return;
+
+    // Blocks may still be referenced by running kernels
+    jitc_sync_all_devices();
+
+    size_t trim_count[(int) AllocType::Count] = { 0 },
+           trim_size [(int) AllocType::Count] = { 0 };
+
+    jitc_malloc_release(release, trim_count, trim_size);
+    state.alloc_allocated[(int) type] -= trim_size[(int) type];
+
+    jitc_log(Debug, "jit_malloc(): %s memory limit reached, released %s in "
+             "%zu allocation%s.", alloc_type_name[(int) type],
+             jitc_mem_string(trim_size[(int) type]), trim_count[(int) type],
+             trim_count[(int) type] != 1 ? "s" : "");
+}
+
+static bool jitc_flush_malloc_cache_warned = false;
+
+static ProfilerRegion profiler_region_flush_malloc_cache("jit_flush_malloc_cache");
+
+/// Release all unused memory to the GPU / OS
+void jitc_flush_malloc_cache(bool warn) {
+    if (warn && !jitc_flush_malloc_cache_warned) {
+        jitc_log(
+            Warn,
+            "jit_flush_malloc_cache(): Dr.Jit exhausted the available memory and had "
+            "to flush its allocation cache to free up additional memory. This "
+            "is an expensive operation and will have a negative effect on "
+            "performance. You may want to change your computation so that it "
+            "uses less memory. This warning will only be displayed once.");
+
+        jitc_flush_malloc_cache_warned = true;
+    }
+    ProfilerPhase profiler(profiler_region_flush_malloc_cache);
+
+    AllocInfoMap alloc_free;
+
+    // Another synchronization to be sure that 'alloc_free' can be released
+    jitc_sync_all_devices();
+
+    /* Critical section */ {
+        lock_guard guard(state.alloc_free_lock);
+        alloc_free.swap(state.alloc_free);
+    }
+
+    size_t trim_count[(int) AllocType::Count] = { 0 },
+           trim_size [(int) AllocType::Count] = { 0 };
+
+    jitc_malloc_release(alloc_free, trim_count, trim_size);
 
     for (int i = 0; i < (int) AllocType::Count; ++i)
         state.alloc_allocated[i] -= trim_size[i];
@@ -450,7 +692,7 @@ AllocType jitc_malloc_type(void *ptr) {
     auto it = state.alloc_used.find((uintptr_t) ptr);
     if (unlikely(it == state.alloc_used.end()))
         jitc_raise("jit_malloc_type(): unknown address " DRJIT_PTR "!", (uintptr_t) ptr);
-    auto [size, type, device] = alloc_info_decode(it->second);
+    auto [size, type, device] = alloc_info_decode(it->second.info);
     (void) size; (void) device;
     return type;
 }
@@ -460,7 +702,7 @@ int jitc_malloc_device(void *ptr) {
     auto it = state.alloc_used.find((uintptr_t) ptr);
     if (unlikely(it == state.alloc_used.end()))
         jitc_raise("jitc_malloc_device(): unknown address " DRJIT_PTR "!", (uintptr_t) ptr);
-    auto [size, type, device] = alloc_info_decode(it->second);
+    auto [size, type, device] = alloc_info_decode(it->second.info);
     (void) size;
 
     if (type == AllocType::Host || type == AllocType::HostAsync)
@@ -475,7 +717,7 @@ void jitc_malloc_shutdown() {
     size_t leak_count[(int) AllocType::Count] = { 0 },
            leak_size [(int) AllocType::Count] = { 0 };
     for (auto kv : state.alloc_used) {
-        auto [size, type, device] = alloc_info_decode(kv.second);
+        auto [size, type, device] = alloc_info_decode(kv.second.info);
         (void) device;
         leak_count[(int) type]++;
         leak_size[(int) type] += size;
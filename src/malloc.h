@@ -26,13 +26,33 @@ inline drjit::dr_tuple<size_t, AllocType, int> alloc_info_decode(AllocInfo value
                            (int) (value & 0xFF));
 }
 
-using AllocInfoMap = tsl::robin_map<AllocInfo, std::vector<void *>, UInt64Hasher>;
-using AllocUsedMap = tsl::robin_map<uintptr_t, AllocInfo, UInt64Hasher>;
+/// Bookkeeping information about an allocation that is currently in use
+struct AllocUsed {
+    /// Size class, type, and device of the allocation
+    AllocInfo info;
+
+    /// Number of bytes requested by the caller of jitc_malloc()
+    size_t requested;
+};
+
+/// Unused memory region in the allocation cache
+struct AllocFree {
+    void *ptr;
+
+    /// Sequence number of the jitc_free() call that released the region
+    uint64_t time;
+};
+
+using AllocInfoMap = tsl::robin_map<AllocInfo, std::vector<AllocFree>, UInt64Hasher>;
+using AllocUsedMap = tsl::robin_map<uintptr_t, AllocUsed, UInt64Hasher>;
 
 /// Round to the next power of two
 extern size_t round_pow2(size_t x);
 extern uint32_t round_pow2(uint32_t x);
 
+/// Round to the next size class of the memory allocator
+extern size_t jitc_malloc_class(size_t size);
+
 /// Descriptive names for the various allocation types
 extern const char *alloc_type_name[(int) AllocType::Count];
 extern const char *alloc_type_name_short[(int) AllocType::Count];
@@ -49,6 +69,9 @@ extern void* jitc_malloc_migrate(void *ptr, AllocType type, int move);
 /// Release all unused memory to the GPU / OS
 extern void jitc_flush_malloc_cache(bool warn);
 
+/// Policy for large host allocations, see \ref jit_malloc_set_policy()
+extern uint32_t jitc_malloc_policy;
+
 /// Shut down the memory allocator (calls \ref jitc_flush_malloc_cache() and reports leaks)
 extern void jitc_malloc_shutdown();
 
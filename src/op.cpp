@@ -31,7 +31,7 @@ struct VarInfo {
     VarType type;
 
     /// Output size given the size of the operands
-    uint32_t size;
+    size_t size;
 
     /// Should Dr.Jit try to simplify the operation? (if some operands are literals)
     bool simplify;
@@ -76,7 +76,7 @@ auto jitc_var_check_impl(const char *name, std::index_sequence<Is...>, Args... a
 
     JitBackend backend = JitBackend::Invalid;
     VarType type = VarType::Void;
-    uint32_t size = 0;
+    size_t size = 0;
     const char *err = nullptr;
 
     for (uint32_t i = 0; i < Size; ++i) {
@@ -164,13 +164,27 @@ auto jitc_var_check_impl(const char *name, std::index_sequence<Is...>, Args... a
         for (uint32_t i = 0; i < Size; ++i) {
             if (unlikely(v[i]->size != size && v[i]->size != 1)) {
                 err = "operands have incompatible sizes";
-                size = (uint32_t) -1;
+                size = (size_t) -1;
                 goto fail;
             }
         }
 
         if (simplify)
             simplify = jitc_flags() & (uint32_t) JitFlag::ConstProp;
+
+        // Insert an evaluation checkpoint if the traced graph has grown too large
+        if (unlikely(state.auto_eval_budget) && !placeholder) {
+            ThreadState *ts = thread_state(backend);
+            if (ts->auto_eval_ops > state.auto_eval_budget) {
+                jitc_eval_auto(ts);
+
+                // Evaluation may have changed the operand records
+                for (uint32_t i = 0; i < Size; ++i) {
+                    if (dep[i])
+                        v[i] = jitc_var(dep[i]);
+                }
+            }
+        }
     }
 
     return drjit::dr_tuple(
@@ -185,10 +199,10 @@ fail:
         buffer.fmt("r%u%s", dep[i], i + 1 < Size ? ", " : "");
     buffer.fmt("): %s!", err);
 
-    if (size == (uint32_t) -1) {
+    if (size == (size_t) -1) {
         buffer.put(" (sizes: ");
         for (uint32_t i = 0; i < Size; ++i)
-            buffer.fmt("%u%s", dep[i] ? jitc_var(dep[i])->size : 0,
+            buffer.fmt("%zu%s", dep[i] ? jitc_var(dep[i])->size : 0,
                        i + 1 < Size ? ", " : "");
         buffer.put(")");
     }
@@ -297,6 +311,42 @@ uint32_t jitc_var_shift(const VarInfo &info, uint32_t index, uint64_t amount) {
                : jitc_var_shr(index, shift);
 }
 
+/**
+ * \brief Unsigned 32 bit division by a constant that is not a power of two
+ *
+ * Replaces the division by a multiplication with a precomputed reciprocal,
+ * followed by a correction step and a shift (Granlund and Montgomery,
+ * "Division by invariant integers using multiplication", Fig. 4.1).
+ */
+static uint32_t jitc_var_div_const(const VarInfo &info, uint32_t index,
+                                   uint64_t divisor) {
+    // l = ceil(log2(divisor)), m = floor(2^32 * (2^l - divisor) / divisor) + 1
+    uint64_t l = 64 - jitc_clz(divisor - 1),
+             rem = (1ull << l) - divisor,
+             m = (((rem << 32) / divisor) + 1) & 0xFFFFFFFFull,
+             one = 1, shift = l - 1;
+
+    Ref m_v     = steal(jitc_var_literal(info.backend, info.type, &m, info.size, 0)),
+        one_v   = steal(jitc_var_literal(info.backend, info.type, &one, info.size, 0)),
+        shift_v = steal(jitc_var_literal(info.backend, info.type, &shift, info.size, 0)),
+        q       = steal(jitc_var_mulhi(index, m_v)),
+        t0      = steal(jitc_var_sub(index, q)),
+        t1      = steal(jitc_var_shr(t0, one_v)),
+        t2      = steal(jitc_var_add(t1, q));
+
+    return jitc_var_shr(t2, shift_v);
+}
+
+/// Should builders rewrite operations based on how their operands were computed?
+static bool jitc_rewrite() {
+    return jitc_flags() & (uint32_t) JitFlag::ConstProp;
+}
+
+/// Was 'v' computed by an operation of the given kind?
+static bool jitc_is_kind(const Variable *v, VarKind kind) {
+    return (VarKind) v->kind == kind;
+}
+
 // --------------------------------------------------------------------------
 
 template <typename T, enable_if_t<!std::is_signed_v<T>> = 0>
@@ -313,6 +363,8 @@ uint32_t jitc_var_neg(uint32_t a0) {
     uint32_t result = 0;
     if (info.simplify && info.literal)
         result = jitc_eval_literal(info, [](auto l0) { return eval_neg(l0); }, v0);
+    else if (jitc_is_kind(v0, VarKind::Neg) && jitc_rewrite())
+        result = jitc_var_new_ref(v0->dep[0]); // -(-x) -> x
 
     if (!result && info.size)
         result = jitc_var_new_node_1(info.backend, VarKind::Neg, info.type,
@@ -337,6 +389,8 @@ uint32_t jitc_var_not(uint32_t a0) {
     uint32_t result = 0;
     if (info.simplify && info.literal)
         result = jitc_eval_literal(info, [](auto l0) { return eval_not(l0); }, v0);
+    else if (jitc_is_kind(v0, VarKind::Not) && jitc_rewrite())
+        result = jitc_var_new_ref(v0->dep[0]); // ~~x -> x
 
     if (!result && info.size)
         result = jitc_var_new_node_1(info.backend, VarKind::Not, info.type,
@@ -387,6 +441,13 @@ uint32_t jitc_var_abs(uint32_t a0) {
     if (!result && jitc_is_uint(info.type))
         result = jitc_var_new_ref(a0);
 
+    if (!result && info.size && jitc_rewrite()) {
+        if (jitc_is_kind(v0, VarKind::Abs))
+            result = jitc_var_new_ref(a0); // ||x|| -> |x|
+        else if (jitc_is_kind(v0, VarKind::Neg))
+            result = jitc_var_abs(v0->dep[0]); // |-x| -> |x|
+    }
+
     if (!result && info.size)
         result = jitc_var_new_node_1(info.backend, VarKind::Abs, info.type,
                                      info.size, info.placeholder, a0, v0);
@@ -411,6 +472,13 @@ uint32_t jitc_var_add(uint32_t a0, uint32_t a1) {
             result = jitc_var_resize(a0, info.size);
     }
 
+    if (!result && info.size && jitc_rewrite()) {
+        if (jitc_is_kind(v1, VarKind::Neg))
+            result = jitc_var_sub(a0, v1->dep[0]); // a + (-b) -> a - b
+        else if (jitc_is_kind(v0, VarKind::Neg))
+            result = jitc_var_sub(a1, v0->dep[0]); // (-a) + b -> b - a
+    }
+
     if (!result && info.size)
         result = jitc_var_new_node_2(info.backend, VarKind::Add, info.type,
                                      info.size, info.placeholder, a0, v0, a1, v1);
@@ -433,6 +501,13 @@ uint32_t jitc_var_sub(uint32_t a0, uint32_t a1) {
             result = jitc_var_resize(a0, info.size);
         else if (a0 == a1 && !jitc_is_float(v0))
             result = jitc_make_zero(info);
+        else if (jitc_is_zero(v0) && !jitc_is_float(v0))
+            result = jitc_var_neg(a1); // 0 - b -> -b (not for floats: signed zeros)
+    }
+
+    if (!result && info.size && jitc_rewrite()) {
+        if (jitc_is_kind(v1, VarKind::Neg))
+            result = jitc_var_add(a0, v1->dep[0]); // a - (-b) -> a + b
     }
 
     if (!result && info.size)
@@ -457,10 +532,14 @@ uint32_t jitc_var_mul(uint32_t a0, uint32_t a1) {
             result = jitc_var_resize(a1, info.size);
         else if (jitc_is_one(v1) || (jitc_is_zero(v0) && jitc_is_int(v0)))
             result = jitc_var_resize(a0, info.size);
-        else if (jitc_is_uint(info.type) && v0->is_literal() && jitc_is_pow2(v0->literal))
+        else if (jitc_is_int(info.type) && v0->is_literal() && jitc_is_pow2(v0->literal))
             result = jitc_var_shift<true>(info, a1, v0->literal);
-        else if (jitc_is_uint(info.type) && v1->is_literal() && jitc_is_pow2(v1->literal))
+        else if (jitc_is_int(info.type) && v1->is_literal() && jitc_is_pow2(v1->literal))
             result = jitc_var_shift<true>(info, a0, v1->literal);
+        else if (jitc_is_minus_one(v0))
+            result = jitc_var_neg(a1);
+        else if (jitc_is_minus_one(v1))
+            result = jitc_var_neg(a0);
     }
 
     if (!result && info.size)
@@ -489,6 +568,8 @@ uint32_t jitc_var_div(uint32_t a0, uint32_t a1) {
             result = jitc_var_resize(a0, info.size);
         } else if (jitc_is_uint(info.type) && v1->is_literal() && jitc_is_pow2(v1->literal)) {
             result = jitc_var_shift<false>(info, a0, v1->literal);
+        } else if (info.type == VarType::UInt32 && v1->is_literal() && v1->literal != 0) {
+            result = jitc_var_div_const(info, a0, v1->literal);
         } else if (jitc_is_float(info.type) && v1->is_literal()) {
             uint32_t recip = jitc_var_rcp(a1);
             result = jitc_var_mul(a0, recip);
@@ -520,9 +601,17 @@ uint32_t jitc_var_mod(uint32_t a0, uint32_t a1) {
     auto [info, v0, v1] = jitc_var_check<IsIntOrBool>("jit_var_mod", a0, a1);
 
     uint32_t result = 0;
-    if (info.simplify && info.literal)
-        result = jitc_eval_literal(
-            info, [](auto l0, auto l1) { return eval_mod(l0, l1); }, v0, v1);
+    if (info.simplify) {
+        if (info.literal) {
+            result = jitc_eval_literal(
+                info, [](auto l0, auto l1) { return eval_mod(l0, l1); }, v0, v1);
+        } else if (jitc_is_uint(info.type) && v1->is_literal() && jitc_is_pow2(v1->literal)) {
+            // x % 2^k -> x & (2^k - 1)
+            uint64_t mask = v1->literal - 1;
+            Ref mask_v = steal(jitc_var_literal(info.backend, info.type, &mask, info.size, 0));
+            result = jitc_var_and(a0, mask_v);
+        }
+    }
 
     if (!result && info.size)
         result = jitc_var_new_node_2(info.backend, VarKind::Mod, info.type,
@@ -607,8 +696,9 @@ uint32_t jitc_var_fma(uint32_t a0, uint32_t a1, uint32_t a2) {
                 tmp = jitc_var_add(a0, a2);
             else if (jitc_is_zero(v2))
                 tmp = jitc_var_mul(a0, a1);
-            else if (jitc_is_zero(v0) && jitc_is_zero(v1))
-                tmp = jitc_var_new_ref(a2);
+            else if ((jitc_is_zero(v0) && jitc_is_zero(v1)) ||
+                     ((jitc_is_zero(v0) || jitc_is_zero(v1)) && jitc_is_int(v0)))
+                tmp = jitc_var_new_ref(a2); // Floats: 0 * inf is NaN
 
             if (tmp) {
                 result = jitc_var_resize(tmp, info.size);
@@ -797,7 +887,7 @@ uint32_t jitc_var_neq(uint32_t a0, uint32_t a1) {
         if (info.literal)
             result = jitc_eval_literal(
                 info, [](auto l0, auto l1) { return l0 != l1; }, v0, v1);
-        else if (a0 == a1)
+        else if (a0 == a1 && !jitc_is_float(v0))
             result = jitc_make_zero(info);
     }
 
@@ -919,6 +1009,9 @@ uint32_t jitc_var_select(uint32_t a0, uint32_t a1, uint32_t a2) {
             return jitc_var_resize(a2, info.size);
     }
 
+    if (info.size && jitc_is_kind(v0, VarKind::Not) && jitc_rewrite())
+        return jitc_var_select(v0->dep[0], a2, a1); // select(~m, a, b) -> select(m, b, a)
+
     if (!result && info.size)
         result = jitc_var_new_node_3(info.backend, VarKind::Select, info.type,
                                     info.size, info.placeholder,
@@ -1423,7 +1516,7 @@ static uint32_t jitc_scatter_gather_index(uint32_t source, uint32_t index) {
 
 /// Change all indices/counters in an expression tree to 'new_index'
 static uint32_t jitc_var_reindex(uint32_t var_index, uint32_t new_index,
-                                 uint32_t mask, uint32_t size) {
+                                 uint32_t mask, size_t size) {
     Variable *v = jitc_var(var_index);
 
     if (v->is_data() || (VarType) v->type == VarType::Void)
@@ -1804,7 +1897,7 @@ void jitc_var_printf(JitBackend backend, uint32_t mask, const char *fmt,
                      uint32_t narg, const uint32_t *arg) {
     ThreadState *ts = thread_state(backend);
     bool dirty, placeholder;
-    uint32_t size;
+    size_t size;
 
     {
         Variable *mask_v = jitc_var(mask);
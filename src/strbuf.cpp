@@ -341,7 +341,7 @@ void StringBuffer::fmt_cuda(size_t nargs, const char *fmt, ...) {
                 case 'v': {
                         const Variable *v = va_arg(args2, const Variable *);
                         put_unchecked(type_prefix[v->type]);
-                        put_u32_unchecked(v->reg_index);
+                        put_u32_unchecked(jitc_var_scratch(v).reg_index);
                     }
                     break;
 
@@ -361,7 +361,7 @@ void StringBuffer::fmt_cuda(size_t nargs, const char *fmt, ...) {
 
                 case 'o': {
                         const Variable *v = va_arg(args2, const Variable *);
-                        put_u32_unchecked(v->param_offset);
+                        put_u32_unchecked(jitc_var_scratch(v).param_offset);
                     }
                     break;
 
@@ -596,7 +596,7 @@ void StringBuffer::fmt_llvm(size_t nargs, const char *fmt, ...) {
                 case 'v': {
                         const Variable *v = va_arg(args2, const Variable *);
                         put_unchecked(type_prefix[v->type]);
-                        put_u32_unchecked(v->reg_index);
+                        put_u32_unchecked(jitc_var_scratch(v).reg_index);
                     }
                     break;
 
@@ -609,7 +609,7 @@ void StringBuffer::fmt_llvm(size_t nargs, const char *fmt, ...) {
                         *m_cur ++= '>';
                         *m_cur ++= ' ';
                         put_unchecked(type_prefix[v->type]);
-                        put_u32_unchecked(v->reg_index);
+                        put_u32_unchecked(jitc_var_scratch(v).reg_index);
                     }
                     break;
 
@@ -650,7 +650,7 @@ void StringBuffer::fmt_llvm(size_t nargs, const char *fmt, ...) {
 
                 case 'o': {
                         const Variable *v = va_arg(args2, const Variable *);
-                        put_u32_unchecked(v->param_offset / (uint32_t) sizeof(void *));
+                        put_u32_unchecked(jitc_var_scratch(v).param_offset / (uint32_t) sizeof(void *));
                     }
                     break;
 
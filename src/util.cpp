@@ -25,7 +25,7 @@ const char *reduction_name[(int) ReduceOp::Count] = { "none", "sum", "mul",
 
 /// Helper function: enqueue parallel CPU task (synchronous or asynchronous)
 template <typename Func>
-void jitc_submit_cpu(KernelType type, Func &&func, uint32_t width,
+void jitc_submit_cpu(KernelType type, Func &&func, size_t width,
                      uint32_t size = 1) {
 
     struct Payload { Func f; };
@@ -61,7 +61,7 @@ void jitc_submit_cpu(KernelType type, Func &&func, uint32_t width,
 void jitc_submit_gpu(KernelType type, CUfunction kernel, uint32_t block_count,
                      uint32_t thread_count, uint32_t shared_mem_bytes,
                      CUstream stream, void **args, void **extra,
-                     uint32_t width) {
+                     size_t width) {
 
     KernelHistoryEntry entry = {};
 
@@ -91,13 +91,21 @@ void jitc_submit_gpu(KernelType type, CUfunction kernel, uint32_t block_count,
     }
 }
 
+/// The CUDA kernels of this file use 32-bit sizes and indices
+static void jitc_check_size_u32(const char *name, size_t size) {
+    if (unlikely(size > 0xFFFFFFFF))
+        jitc_raise("%s(): the array size (%zu) exceeds the limit of 2^32 == "
+                   "4294967296 entries supported by this operation.", name,
+                   size);
+}
+
 /// Fill a device memory region with constants of a given type
-void jitc_memset_async(JitBackend backend, void *ptr, uint32_t size_,
+void jitc_memset_async(JitBackend backend, void *ptr, size_t size_,
                        uint32_t isize, const void *src) {
     if (isize != 1 && isize != 2 && isize != 4 && isize != 8)
         jitc_raise("jit_memset_async(): invalid element size (must be 1, 2, 4, or 8)!");
 
-    jitc_trace("jit_memset_async(" DRJIT_PTR ", isize=%u, size=%u)",
+    jitc_trace("jit_memset_async(" DRJIT_PTR ", isize=%u, size=%zu)",
               (uintptr_t) ptr, isize, size_);
 
     if (size_ == 0)
@@ -136,10 +144,11 @@ void jitc_memset_async(JitBackend backend, void *ptr, uint32_t size_,
                 break;
 
             case 8: {
+                    jitc_check_size_u32("jit_memset_async", size_);
                     const Device &device = state.devices[ts->device];
-                    uint32_t block_count, thread_count;
-                    device.get_launch_config(&block_count, &thread_count, size_);
-                    void *args[] = { &ptr, &size_, (void *) src };
+                    uint32_t block_count, thread_count, size_u32 = (uint32_t) size_;
+                    device.get_launch_config(&block_count, &thread_count, size_u32);
+                    void *args[] = { &ptr, &size_u32, (void *) src };
                     CUfunction kernel = jitc_cuda_fill_64[device.id];
                     jitc_submit_gpu(KernelType::Other, kernel, block_count,
                                     thread_count, 0, ts->stream, args, nullptr,
@@ -161,7 +170,7 @@ void jitc_memset_async(JitBackend backend, void *ptr, uint32_t size_,
                     case 2: {
                             uint16_t value = ((uint16_t *) src8)[0],
                                     *p = (uint16_t *) ptr;
-                            for (uint32_t i = 0; i < size; ++i)
+                            for (size_t i = 0; i < size; ++i)
                                 p[i] = value;
                         }
                         break;
@@ -169,7 +178,7 @@ void jitc_memset_async(JitBackend backend, void *ptr, uint32_t size_,
                     case 4: {
                             uint32_t value = ((uint32_t *) src8)[0],
                                     *p = (uint32_t *) ptr;
-                            for (uint32_t i = 0; i < size; ++i)
+                            for (size_t i = 0; i < size; ++i)
                                 p[i] = value;
                         }
                         break;
@@ -177,14 +186,14 @@ void jitc_memset_async(JitBackend backend, void *ptr, uint32_t size_,
                     case 8: {
                             uint64_t value = ((uint64_t *) src8)[0],
                                     *p = (uint64_t *) ptr;
-                            for (uint32_t i = 0; i < size; ++i)
+                            for (size_t i = 0; i < size; ++i)
                                 p[i] = value;
                         }
                         break;
                 }
             },
 
-            (uint32_t) size
+            size
         );
     }
 }
@@ -218,101 +227,182 @@ void jitc_memcpy_async(JitBackend backend, void *dst, const void *src, size_t si
                 memcpy(dst, src, size);
             },
 
-            (uint32_t) size
+            size
         );
     }
 }
 
-using Reduction = void (*) (const void *ptr, uint32_t start, uint32_t end, void *out);
+using Reduction = void (*) (const void *ptr, size_t start, size_t end, void *out);
+
+/* The CPU reductions below keep one accumulator per entry of a 64 byte
+   chunk. The accumulators are independent, which lets the C++ compiler map
+   the inner loops onto SIMD instructions of any width (SSE/AVX/AVX-512,
+   NEON) even for floating point operations that it may not reorder. */
+
+/// Reduce a range of values using 64 / sizeof(Value) independent accumulators
+template <typename Value, typename Op>
+static Value jitc_reduce_lanes(const Value *ptr, size_t start, size_t end,
+                               Value init, Op op) {
+    constexpr size_t Lanes = 64 / sizeof(Value);
+    Value acc[Lanes];
+    for (size_t j = 0; j < Lanes; ++j)
+        acc[j] = init;
+
+    size_t i = start;
+    for (; i + Lanes <= end; i += Lanes) {
+        for (size_t j = 0; j < Lanes; ++j)
+            acc[j] = op(acc[j], ptr[i + j]);
+    }
+
+    for (; i != end; ++i)
+        acc[0] = op(acc[0], ptr[i]);
+
+    // Combine the accumulators pairwise
+    for (size_t n = Lanes / 2; n > 0; n /= 2) {
+        for (size_t j = 0; j < n; ++j)
+            acc[j] = op(acc[j], acc[j + n]);
+    }
+
+    return acc[0];
+}
+
+/// Pairwise summation: error grows with log(n) instead of n
+template <typename Value>
+static Value jitc_reduce_sum_pairwise(const Value *ptr, size_t start, size_t end) {
+    constexpr size_t Lanes = 64 / sizeof(Value);
+
+    if (end - start <= DRJIT_REDUCE_PAIRWISE_BLOCK)
+        return jitc_reduce_lanes(ptr, start, end, Value(0),
+                                 [](Value a, Value b) { return a + b; });
+
+    size_t mid = start + ((end - start) / 2 + Lanes - 1) / Lanes * Lanes;
+    return jitc_reduce_sum_pairwise(ptr, start, mid) +
+           jitc_reduce_sum_pairwise(ptr, mid, end);
+}
+
+/// Compensated (Kahan) summation, see JitFlag::ReduceKahan
+template <typename Value>
+static Value jitc_reduce_sum_kahan(const Value *ptr, size_t start, size_t end) {
+    constexpr size_t Lanes = 64 / sizeof(Value);
+    Value sum[Lanes], comp[Lanes];
+    for (size_t j = 0; j < Lanes; ++j)
+        sum[j] = comp[j] = 0;
+
+    auto step = [](Value &s, Value &c, Value value) {
+        Value y = value - c,
+              t = s + y;
+        c = (t - s) - y;
+        s = t;
+    };
+
+    size_t i = start;
+    for (; i + Lanes <= end; i += Lanes) {
+        for (size_t j = 0; j < Lanes; ++j)
+            step(sum[j], comp[j], ptr[i + j]);
+    }
+
+    for (; i != end; ++i)
+        step(sum[0], comp[0], ptr[i]);
+
+    // Combine the accumulators and their remaining compensation terms
+    Value s = 0, c = 0;
+    for (size_t j = 0; j < Lanes; ++j) {
+        step(s, c, sum[j]);
+        step(s, c, -comp[j]);
+    }
+
+    return s;
+}
 
 template <typename Value>
-static Reduction jitc_reduce_create(ReduceOp rtype) {
+static Reduction jitc_reduce_create(ReduceOp rtype, bool kahan) {
     using UInt = uint_with_size_t<Value>;
 
     switch (rtype) {
         case ReduceOp::Add:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
-                const Value *ptr = (const Value *) ptr_;
-                Value result = 0;
-                for (uint32_t i = start; i != end; ++i)
-                    result += ptr[i];
-                *((Value *) out) = result;
+            if constexpr (std::is_floating_point<Value>::value) {
+                if (kahan)
+                    return [](const void *ptr, size_t start, size_t end, void *out) {
+                        *((Value *) out) = jitc_reduce_sum_kahan((const Value *) ptr, start, end);
+                    };
+                else
+                    return [](const void *ptr, size_t start, size_t end, void *out) {
+                        *((Value *) out) = jitc_reduce_sum_pairwise((const Value *) ptr, start, end);
+                    };
+            }
+
+            return [](const void *ptr, size_t start, size_t end, void *out) {
+                *((Value *) out) = jitc_reduce_lanes(
+                    (const Value *) ptr, start, end, Value(0),
+                    [](Value a, Value b) { return (Value) (a + b); });
             };
 
         case ReduceOp::Mul:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
-                const Value *ptr = (const Value *) ptr_;
-                Value result = 1;
-                for (uint32_t i = start; i != end; ++i)
-                    result *= ptr[i];
-                *((Value *) out) = result;
+            return [](const void *ptr, size_t start, size_t end, void *out) {
+                *((Value *) out) = jitc_reduce_lanes(
+                    (const Value *) ptr, start, end, Value(1),
+                    [](Value a, Value b) { return (Value) (a * b); });
             };
 
         case ReduceOp::Max:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
-                const Value *ptr = (const Value *) ptr_;
-                Value result = std::is_integral<Value>::value
-                                   ?  std::numeric_limits<Value>::min()
-                                   : -std::numeric_limits<Value>::infinity();
-                for (uint32_t i = start; i != end; ++i)
-                    result = std::max(result, ptr[i]);
-                *((Value *) out) = result;
+            return [](const void *ptr, size_t start, size_t end, void *out) {
+                Value init = std::is_integral<Value>::value
+                                 ?  std::numeric_limits<Value>::min()
+                                 : -std::numeric_limits<Value>::infinity();
+                *((Value *) out) = jitc_reduce_lanes(
+                    (const Value *) ptr, start, end, init,
+                    [](Value a, Value b) { return std::max(a, b); });
             };
 
         case ReduceOp::Min:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
-                const Value *ptr = (const Value *) ptr_;
-                Value result = std::is_integral<Value>::value
-                                   ?  std::numeric_limits<Value>::max()
-                                   :  std::numeric_limits<Value>::infinity();
-                for (uint32_t i = start; i != end; ++i)
-                    result = std::min(result, ptr[i]);
-                *((Value *) out) = result;
+            return [](const void *ptr, size_t start, size_t end, void *out) {
+                Value init = std::is_integral<Value>::value
+                                 ?  std::numeric_limits<Value>::max()
+                                 :  std::numeric_limits<Value>::infinity();
+                *((Value *) out) = jitc_reduce_lanes(
+                    (const Value *) ptr, start, end, init,
+                    [](Value a, Value b) { return std::min(a, b); });
             };
 
         case ReduceOp::Or:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
-                const UInt *ptr = (const UInt *) ptr_;
-                UInt result = 0;
-                for (uint32_t i = start; i != end; ++i)
-                    result |= ptr[i];
-                *((UInt *) out) = result;
+            return [](const void *ptr, size_t start, size_t end, void *out) {
+                *((UInt *) out) = jitc_reduce_lanes(
+                    (const UInt *) ptr, start, end, UInt(0),
+                    [](UInt a, UInt b) { return (UInt) (a | b); });
             };
 
         case ReduceOp::And:
-            return [](const void *ptr_, uint32_t start, uint32_t end, void *out) {
-                const UInt *ptr = (const UInt *) ptr_;
-                UInt result = (UInt) -1;
-                for (uint32_t i = start; i != end; ++i)
-                    result &= ptr[i];
-                *((UInt *) out) = result;
+            return [](const void *ptr, size_t start, size_t end, void *out) {
+                *((UInt *) out) = jitc_reduce_lanes(
+                    (const UInt *) ptr, start, end, (UInt) -1,
+                    [](UInt a, UInt b) { return (UInt) (a & b); });
             };
 
         default: jitc_raise("jit_reduce_create(): unsupported reduction type!");
     }
 }
 
-static Reduction jitc_reduce_create(VarType type, ReduceOp rtype) {
+static Reduction jitc_reduce_create(VarType type, ReduceOp rtype, bool kahan) {
     switch (type) {
-        case VarType::Int8:    return jitc_reduce_create<int8_t  >(rtype);
-        case VarType::UInt8:   return jitc_reduce_create<uint8_t >(rtype);
-        case VarType::Int16:   return jitc_reduce_create<int16_t >(rtype);
-        case VarType::UInt16:  return jitc_reduce_create<uint16_t>(rtype);
-        case VarType::Int32:   return jitc_reduce_create<int32_t >(rtype);
-        case VarType::UInt32:  return jitc_reduce_create<uint32_t>(rtype);
-        case VarType::Int64:   return jitc_reduce_create<int64_t >(rtype);
-        case VarType::UInt64:  return jitc_reduce_create<uint64_t>(rtype);
-        case VarType::Float32: return jitc_reduce_create<float   >(rtype);
-        case VarType::Float64: return jitc_reduce_create<double  >(rtype);
+        case VarType::Int8:    return jitc_reduce_create<int8_t  >(rtype, kahan);
+        case VarType::UInt8:   return jitc_reduce_create<uint8_t >(rtype, kahan);
+        case VarType::Int16:   return jitc_reduce_create<int16_t >(rtype, kahan);
+        case VarType::UInt16:  return jitc_reduce_create<uint16_t>(rtype, kahan);
+        case VarType::Int32:   return jitc_reduce_create<int32_t >(rtype, kahan);
+        case VarType::UInt32:  return jitc_reduce_create<uint32_t>(rtype, kahan);
+        case VarType::Int64:   return jitc_reduce_create<int64_t >(rtype, kahan);
+        case VarType::UInt64:  return jitc_reduce_create<uint64_t>(rtype, kahan);
+        case VarType::Float32: return jitc_reduce_create<float   >(rtype, kahan);
+        case VarType::Float64: return jitc_reduce_create<double  >(rtype, kahan);
         default: jitc_raise("jit_reduce_create(): unsupported data type!");
     }
 }
 
 void jitc_reduce(JitBackend backend, VarType type, ReduceOp rtype, const void *ptr,
-                uint32_t size, void *out) {
+                size_t size, void *out) {
     ThreadState *ts = thread_state(backend);
 
-    jitc_log(Debug, "jit_reduce(" DRJIT_PTR ", type=%s, rtype=%s, size=%u)",
+    jitc_log(Debug, "jit_reduce(" DRJIT_PTR ", type=%s, rtype=%s, size=%zu)",
             (uintptr_t) ptr, type_name[(int) type],
             reduction_name[(int) rtype], size);
 
@@ -326,15 +416,18 @@ void jitc_reduce(JitBackend backend, VarType type, ReduceOp rtype, const void *p
             jitc_raise("jit_reduce(): no existing kernel for type=%s, rtype=%s!",
                       type_name[(int) type], reduction_name[(int) rtype]);
 
+        jitc_check_size_u32("jit_reduce", size);
+
         uint32_t thread_count = 1024,
                  shared_size = thread_count * tsize,
+                 size_u32 = (uint32_t) size,
                  block_count;
 
-        device.get_launch_config(&block_count, nullptr, size, thread_count);
+        device.get_launch_config(&block_count, nullptr, size_u32, thread_count);
 
         if (size <= 1024) {
             // This is a small array, do everything in just one reduction.
-            void *args[] = { &ptr, &size, &out };
+            void *args[] = { &ptr, &size_u32, &out };
 
             jitc_submit_gpu(KernelType::Reduce, func, 1, thread_count,
                             shared_size, ts->stream, args, nullptr, size);
@@ -342,7 +435,7 @@ void jitc_reduce(JitBackend backend, VarType type, ReduceOp rtype, const void *p
             void *temp = jitc_malloc(AllocType::Device, size_t(block_count) * tsize);
 
             // First reduction
-            void *args_1[] = { &ptr, &size, &temp };
+            void *args_1[] = { &ptr, &size_u32, &temp };
 
             jitc_submit_gpu(KernelType::Reduce, func, block_count, thread_count,
                             shared_size, ts->stream, args_1, nullptr, size);
@@ -356,17 +449,19 @@ void jitc_reduce(JitBackend backend, VarType type, ReduceOp rtype, const void *p
             jitc_free(temp);
         }
     } else {
-        uint32_t block_size = size, blocks = 1;
+        size_t block_size = size;
+        uint32_t blocks = 1;
         if (pool_size() > 1) {
             block_size = DRJIT_POOL_BLOCK_SIZE;
-            blocks     = (size + block_size - 1) / block_size;
+            blocks     = (uint32_t) ((size + block_size - 1) / block_size);
         }
 
         void *target = out;
         if (blocks > 1)
             target = jitc_malloc(AllocType::HostAsync, blocks * tsize);
 
-        Reduction reduction = jitc_reduce_create(type, rtype);
+        Reduction reduction = jitc_reduce_create(
+            type, rtype, jitc_flags() & (uint32_t) JitFlag::ReduceKahan);
         jitc_submit_cpu(
             KernelType::Reduce,
             [block_size, size, tsize, ptr, reduction, target](uint32_t index) {
@@ -386,16 +481,16 @@ void jitc_reduce(JitBackend backend, VarType type, ReduceOp rtype, const void *p
 }
 
 /// 'All' reduction for boolean arrays
-bool jitc_all(JitBackend backend, uint8_t *values, uint32_t size) {
+bool jitc_all(JitBackend backend, uint8_t *values, size_t size) {
     /* When \c size is not a multiple of 4, the implementation will initialize up
        to 3 bytes beyond the end of the supplied range so that an efficient 32 bit
        reduction algorithm can be used. This is fine for allocations made using
        \ref jit_malloc(), which allow for this. */
 
-    uint32_t reduced_size = (size + 3) / 4,
-             trailing     = reduced_size * 4 - size;
+    size_t reduced_size = (size + 3) / 4,
+           trailing     = reduced_size * 4 - size;
 
-    jitc_log(Debug, "jit_all(" DRJIT_PTR ", size=%u)", (uintptr_t) values, size);
+    jitc_log(Debug, "jit_all(" DRJIT_PTR ", size=%zu)", (uintptr_t) values, size);
 
     if (trailing) {
         bool filler = true;
@@ -420,16 +515,16 @@ bool jitc_all(JitBackend backend, uint8_t *values, uint32_t size) {
 }
 
 /// 'Any' reduction for boolean arrays
-bool jitc_any(JitBackend backend, uint8_t *values, uint32_t size) {
+bool jitc_any(JitBackend backend, uint8_t *values, size_t size) {
     /* When \c size is not a multiple of 4, the implementation will initialize up
        to 3 bytes beyond the end of the supplied range so that an efficient 32 bit
        reduction algorithm can be used. This is fine for allocations made using
        \ref jit_malloc(), which allow for this. */
 
-    uint32_t reduced_size = (size + 3) / 4,
-             trailing     = reduced_size * 4 - size;
+    size_t reduced_size = (size + 3) / 4,
+           trailing     = reduced_size * 4 - size;
 
-    jitc_log(Debug, "jit_any(" DRJIT_PTR ", size=%u)", (uintptr_t) values, size);
+    jitc_log(Debug, "jit_any(" DRJIT_PTR ", size=%zu)", (uintptr_t) values, size);
 
     if (trailing) {
         bool filler = false;
@@ -454,17 +549,17 @@ bool jitc_any(JitBackend backend, uint8_t *values, uint32_t size) {
 }
 
 template <typename T>
-void sum_reduce_1(uint32_t start, uint32_t end, const void *in_, uint32_t index,
+void sum_reduce_1(size_t start, size_t end, const void *in_, uint32_t index,
                   void *scratch) {
     const T *in = (const T *) in_;
     T accum = T(0);
-    for (uint32_t i = start; i != end; ++i)
+    for (size_t i = start; i != end; ++i)
         accum += in[i];
     ((T*) scratch)[index] = accum;
 }
 
 template <typename T>
-void sum_reduce_2(uint32_t start, uint32_t end, const void *in_, void *out_,
+void sum_reduce_2(size_t start, size_t end, const void *in_, void *out_,
                   uint32_t index, const void *scratch, bool exclusive) {
     const T *in = (const T *) in_;
     T *out = (T *) out_;
@@ -476,13 +571,13 @@ void sum_reduce_2(uint32_t start, uint32_t end, const void *in_, void *out_,
         accum = T(0);
 
     if (exclusive) {
-        for (uint32_t i = start; i != end; ++i) {
+        for (size_t i = start; i != end; ++i) {
             T value = in[i];
             out[i] = accum;
             accum += value;
         }
     } else {
-        for (uint32_t i = start; i != end; ++i) {
+        for (size_t i = start; i != end; ++i) {
             T value = in[i];
             accum += value;
             out[i] = accum;
@@ -490,7 +585,7 @@ void sum_reduce_2(uint32_t start, uint32_t end, const void *in_, void *out_,
     }
 }
 
-void sum_reduce_1(VarType vt, uint32_t start, uint32_t end, const void *in, uint32_t index, void *scratch) {
+void sum_reduce_1(VarType vt, size_t start, size_t end, const void *in, uint32_t index, void *scratch) {
     switch (vt) {
         case VarType::UInt32:  sum_reduce_1<uint32_t>(start, end, in, index, scratch); break;
         case VarType::UInt64:  sum_reduce_1<uint64_t>(start, end, in, index, scratch); break;
@@ -501,7 +596,7 @@ void sum_reduce_1(VarType vt, uint32_t start, uint32_t end, const void *in, uint
     }
 }
 
-void sum_reduce_2(VarType vt, uint32_t start, uint32_t end, const void *in, void *out, uint32_t index, const void *scratch, bool exclusive) {
+void sum_reduce_2(VarType vt, size_t start, size_t end, const void *in, void *out, uint32_t index, const void *scratch, bool exclusive) {
     switch (vt) {
         case VarType::UInt32:  sum_reduce_2<uint32_t>(start, end, in, out, index, scratch, exclusive); break;
         case VarType::UInt64:  sum_reduce_2<uint64_t>(start, end, in, out, index, scratch, exclusive); break;
@@ -514,7 +609,7 @@ void sum_reduce_2(VarType vt, uint32_t start, uint32_t end, const void *in, void
 
 /// Exclusive prefix sum
 void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
-               const void *in, uint32_t size, void *out) {
+               const void *in, size_t size, void *out) {
     if (size == 0)
         return;
     if (vt == VarType::Int32)
@@ -524,8 +619,11 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
     ThreadState *ts = thread_state(backend);
 
     if (backend == JitBackend::CUDA) {
+        jitc_check_size_u32("jit_prefix_sum", size);
+
         const Device &device = state.devices[ts->device];
         scoped_set_context guard(ts->context);
+        uint32_t size_u32 = (uint32_t) size;
 
         if (size == 1) {
             if (exclusive) {
@@ -539,13 +637,13 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
         } else if ((isize == 4 && size <= 4096) || (isize == 8 && size < 2048)) {
             // Kernel for small arrays
             uint32_t items_per_thread = isize == 8 ? 2 : 4,
-                     thread_count     = round_pow2((size + items_per_thread - 1)
+                     thread_count     = round_pow2((size_u32 + items_per_thread - 1)
                                                     / items_per_thread),
                      shared_size      = thread_count * 2 * isize;
 
             jitc_log(Debug,
                      "jit_prefix_sum(" DRJIT_PTR " -> " DRJIT_PTR
-                     ", type=%s, exclusive=%i, size=%u, type=small, threads=%u, shared=%u)",
+                     ", type=%s, exclusive=%i, size=%zu, type=small, threads=%u, shared=%u)",
                      (uintptr_t) in, (uintptr_t) out, type_name[(int) vt], exclusive, size,
                      thread_count, shared_size);
 
@@ -556,7 +654,7 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
             if (!kernel)
                 jitc_raise("jit_prefix_sum(): type %s is not supported!", type_name[(int) vt]);
 
-            void *args[] = { &in, &out, &size };
+            void *args[] = { &in, &out, &size_u32 };
             jitc_submit_gpu(
                 KernelType::Other, kernel, 1,
                 thread_count, shared_size, ts->stream, args, nullptr, size);
@@ -565,13 +663,13 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
             uint32_t items_per_thread = isize == 8 ? 8 : 16,
                      thread_count     = 128,
                      items_per_block  = items_per_thread * thread_count,
-                     block_count      = (size + items_per_block - 1) / items_per_block,
+                     block_count      = (size_u32 + items_per_block - 1) / items_per_block,
                      shared_size      = items_per_block * isize,
                      scratch_items    = block_count + 32;
 
             jitc_log(Debug,
                      "jit_prefix_sum(" DRJIT_PTR " -> " DRJIT_PTR
-                     ", type=%s, exclusive=%i, size=%u, type=large, blocks=%u, threads=%u, "
+                     ", type=%s, exclusive=%i, size=%zu, type=large, blocks=%u, threads=%u, "
                      "shared=%u, scratch=%zu)",
                      (uintptr_t) in, (uintptr_t) out, type_name[(int) vt], exclusive, size,
                      block_count, thread_count, shared_size, scratch_items * sizeof(uint64_t));
@@ -598,7 +696,7 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
                             args, nullptr, scratch_items);
 
             scratch += 32; // move beyond padding area
-            void *args_2[] = { &in, &out, &size, &scratch };
+            void *args_2[] = { &in, &out, &size_u32, &scratch };
             jitc_submit_gpu(KernelType::Other, kernel, block_count,
                             thread_count, shared_size, ts->stream, args_2,
                             nullptr, scratch_items);
@@ -607,15 +705,16 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
             jitc_free(scratch);
         }
     } else {
-        uint32_t block_size = size, blocks = 1;
+        size_t block_size = size;
+        uint32_t blocks = 1;
         if (pool_size() > 1) {
             block_size = DRJIT_POOL_BLOCK_SIZE;
-            blocks     = (size + block_size - 1) / block_size;
+            blocks     = (uint32_t) ((size + block_size - 1) / block_size);
         }
 
         jitc_log(Debug,
                 "jit_prefix_sum(" DRJIT_PTR " -> " DRJIT_PTR
-                ", size=%u, block_size=%u, blocks=%u)",
+                ", size=%zu, block_size=%zu, blocks=%u)",
                 (uintptr_t) in, (uintptr_t) out, size, block_size, blocks);
 
         void *scratch = nullptr;
@@ -626,8 +725,8 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
             jitc_submit_cpu(
                 KernelType::Other,
                 [block_size, size, in, vt, scratch](uint32_t index) {
-                    uint32_t start = index * block_size,
-                             end = std::min(start + block_size, size);
+                    size_t start = index * block_size,
+                           end = std::min(start + block_size, size);
 
                     sum_reduce_1(vt, start, end, in, index, scratch);
                 },
@@ -639,8 +738,8 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
         jitc_submit_cpu(
             KernelType::Other,
             [block_size, size, in, out, vt, scratch, exclusive](uint32_t index) {
-                uint32_t start = index * block_size,
-                         end = std::min(start + block_size, size);
+                size_t start = index * block_size,
+                       end = std::min(start + block_size, size);
 
                 sum_reduce_2(vt, start, end, in, out, index, scratch, exclusive);
             },
@@ -652,10 +751,14 @@ void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
 }
 
 /// Mask compression
-uint32_t jitc_compress(JitBackend backend, const uint8_t *in, uint32_t size, uint32_t *out) {
-    if (size == 0)
+uint32_t jitc_compress(JitBackend backend, const uint8_t *in, size_t size_, uint32_t *out) {
+    if (size_ == 0)
         return 0;
 
+    // The output consists of 32-bit indices
+    jitc_check_size_u32("jit_compress", size_);
+    uint32_t size = (uint32_t) size_;
+
     ThreadState *ts = thread_state(backend);
 
     if (backend == JitBackend::CUDA) {
@@ -831,13 +934,17 @@ static ProfilerRegion profiler_region_mkperm_phase_1("jit_mkperm_phase_1");
 static ProfilerRegion profiler_region_mkperm_phase_2("jit_mkperm_phase_2");
 
 /// Compute a permutation to reorder an integer array into a sorted configuration
-uint32_t jitc_mkperm(JitBackend backend, const uint32_t *ptr, uint32_t size,
+uint32_t jitc_mkperm(JitBackend backend, const uint32_t *ptr, size_t size_,
                      uint32_t bucket_count, uint32_t *perm, uint32_t *offsets) {
-    if (size == 0)
+    if (size_ == 0)
         return 0;
     else if (unlikely(bucket_count == 0))
         jitc_fail("jit_mkperm(): bucket_count cannot be zero!");
 
+    // The permutation consists of 32-bit indices
+    jitc_check_size_u32("jit_mkperm", size_);
+    uint32_t size = (uint32_t) size_;
+
     ProfilerPhase profiler(profiler_region_mkperm);
     ThreadState *ts = thread_state(backend);
 
@@ -16,29 +16,29 @@
 extern const char *reduction_name[(int) ReduceOp::Count];
 
 /// Fill a device memory region with constants of a given type
-extern void jitc_memset_async(JitBackend backend, void *ptr, uint32_t size,
+extern void jitc_memset_async(JitBackend backend, void *ptr, size_t size,
                               uint32_t isize, const void *src);
 
 /// Reduce the given array to a single value
 extern void jitc_reduce(JitBackend backend, VarType type, ReduceOp rtype,
-                        const void *ptr, uint32_t size, void *out);
+                        const void *ptr, size_t size, void *out);
 
 /// 'All' reduction for boolean arrays
-extern bool jitc_all(JitBackend backend, uint8_t *values, uint32_t size);
+extern bool jitc_all(JitBackend backend, uint8_t *values, size_t size);
 
 /// 'Any' reduction for boolean arrays
-extern bool jitc_any(JitBackend backend, uint8_t *values, uint32_t size);
+extern bool jitc_any(JitBackend backend, uint8_t *values, size_t size);
 
 /// Exclusive prefix sum
 extern void jitc_prefix_sum(JitBackend backend, VarType vt, bool exclusive,
-                            const void *in, uint32_t size, void *out);
+                            const void *in, size_t size, void *out);
 
 /// Mask compression
-extern uint32_t jitc_compress(JitBackend backend, const uint8_t *in, uint32_t size,
+extern uint32_t jitc_compress(JitBackend backend, const uint8_t *in, size_t size,
                               uint32_t *out);
 
 /// Compute a permutation to reorder an integer array into discrete groups
-extern uint32_t jitc_mkperm(JitBackend backend, const uint32_t *values, uint32_t size,
+extern uint32_t jitc_mkperm(JitBackend backend, const uint32_t *values, size_t size,
                             uint32_t bucket_count, uint32_t *perm,
                             uint32_t *offsets);
 
@@ -15,9 +15,6 @@
 #include "op.h"
 #include "registry.h"
 
-// When debugging via valgrind, this will make iterator invalidation more obvious
-// #define DRJIT_VALGRIND 1
-
 /// Descriptive names for the various variable types
 const char *type_name[(int) VarType::Count] {
     "void",   "bool",  "int8",   "uint8",   "int16",   "uint16",  "int32",
@@ -176,11 +173,215 @@ const char *var_kind_name[(int) VarKind::Count] {
 /// Temporary string buffer for miscellaneous variable-related tasks
 StringBuffer var_buffer(0);
 
-#define jitc_check_size(name, size)                                            \
-    if (unlikely(size > 0xFFFFFFFF))                                           \
+/* Array sizes are 64-bit throughout. CUDA kernels still use a 32-bit thread
+   index, hence arrays on that backend are limited to 2^32 entries. */
+#define jitc_check_size(name, backend, size)                                   \
+    if (unlikely((backend) == JitBackend::CUDA && size > 0xFFFFFFFF))          \
         jitc_raise("%s(): tried to create an array with %zu entries, which "   \
-                   "exceeds the limit of 2^32 == 4294967296 entries.",         \
-                   name, size);
+                   "exceeds the limit of 2^32 == 4294967296 entries of the "   \
+                   "CUDA backend.", name, size);
+
+/// Maximum number of released chunks that are kept for later reuse
+#define DRJIT_VAR_CHUNK_CACHE 16
+
+VariableChunk *VariableTable::alloc_chunk() {
+    VariableChunk *chunk;
+    if (!free_chunks.empty()) {
+        chunk = free_chunks.back();
+        free_chunks.pop_back();
+    } else {
+        chunk = aligned_allocator<VariableChunk, DRJIT_VAR_CHUNK_ALIGN>().allocate(1);
+    }
+    memset(chunk->used, 0, sizeof(chunk->used));
+    chunk->live = 0;
+    chunk->created = 0;
+    m_chunk_count++;
+    return chunk;
+}
+
+void VariableTable::release_chunk(VariableChunk *chunk) {
+    m_chunk_count--;
+    if (free_chunks.size() < DRJIT_VAR_CHUNK_CACHE)
+        free_chunks.push_back(chunk);
+    else
+        aligned_allocator<VariableChunk, DRJIT_VAR_CHUNK_ALIGN>().deallocate(chunk, 1);
+}
+
+Variable *VariableTable::insert(uint32_t index, const Variable &v) {
+    uint32_t chunk_id = index >> DRJIT_VAR_CHUNK_SHIFT,
+             slot = index & (DRJIT_VAR_CHUNK_SIZE - 1);
+
+    // IDs only decrease following an overflow of 'State::variable_index'
+    if (unlikely(index <= relocated_max && relocated.find(index) != relocated.end()))
+        return nullptr;
+
+    if (unlikely(chunk_id < chunk_base)) {
+        chunks.insert(chunks.begin(), chunk_base - chunk_id, nullptr);
+        chunk_base = chunk_id;
+    }
+
+    uint32_t pos = chunk_id - chunk_base;
+    if (unlikely(pos >= chunks.size()))
+        chunks.resize(std::max((size_t) pos + 1, chunks.size() * 2), nullptr);
+
+    VariableChunk *chunk = chunks[pos];
+    if (unlikely(!chunk)) {
+        chunk = alloc_chunk();
+        // ID 0 is never handed out
+        chunk->created = chunk_id == 0 ? 1 : 0;
+        chunks[pos] = chunk;
+    }
+
+    uint64_t &used = chunk->used[slot / 64],
+             bit = 1ull << (slot % 64);
+    if (unlikely(used & bit))
+        return nullptr;
+
+    used |= bit;
+    chunk->live++;
+    chunk->created++;
+    m_size++;
+
+    if (unlikely(chunk->created == DRJIT_VAR_CHUNK_SIZE &&
+                 chunk->live <= DRJIT_VAR_CHUNK_SPARSE))
+        sparse_chunks.push_back(chunk_id);
+
+    Variable *result = chunk->vars + slot;
+    memcpy((void *) result, &v, sizeof(Variable));
+    memset(chunk->scratch + slot, 0, sizeof(VariableScratch));
+    return result;
+}
+
+void VariableTable::erase(uint32_t index) {
+    uint32_t chunk_id = index >> DRJIT_VAR_CHUNK_SHIFT,
+             pos = chunk_id - chunk_base,
+             slot = index & (DRJIT_VAR_CHUNK_SIZE - 1);
+    VariableChunk *chunk = pos < chunks.size() ? chunks[pos] : nullptr;
+    m_size--;
+
+    if (unlikely(!chunk || !(chunk->used[slot / 64] & (1ull << (slot % 64))))) {
+        // The variable was moved into a spill chunk by compact()
+        auto it = relocated.find(index);
+        Variable *v = it.value();
+        relocated.erase(it);
+        if (relocated.empty())
+            relocated_max = 0;
+
+        chunk = (VariableChunk *) ((uintptr_t) v & ~(uintptr_t) (DRJIT_VAR_CHUNK_ALIGN - 1));
+        slot = (uint32_t) (v - chunk->vars);
+        chunk->used[slot / 64] &= ~(1ull << (slot % 64));
+
+        if (--chunk->live == 0) {
+            spill_chunks.erase(std::find(spill_chunks.begin(), spill_chunks.end(), chunk));
+            release_chunk(chunk);
+        }
+        return;
+    }
+
+    chunk->used[slot / 64] &= ~(1ull << (slot % 64));
+    chunk->live--;
+
+    if (chunk->created < DRJIT_VAR_CHUNK_SIZE)
+        return;
+
+    if (chunk->live == DRJIT_VAR_CHUNK_SPARSE) {
+        sparse_chunks.push_back(chunk_id);
+    } else if (chunk->live == 0) {
+        // Release the chunk once all of its IDs were used and have been freed
+        chunks[pos] = nullptr;
+        release_chunk(chunk);
+        trim();
+    }
+}
+
+/// Drop released chunks from the front of the directory
+void VariableTable::trim() {
+    size_t n = 0;
+    while (n < chunks.size() && !chunks[n])
+        n++;
+    if (n >= 64 && n * 2 >= chunks.size()) {
+        chunks.erase(chunks.begin(), chunks.begin() + n);
+        chunk_base += (uint32_t) n;
+    }
+}
+
+void VariableTable::compact() {
+    for (uint32_t chunk_id : sparse_chunks) {
+        uint32_t pos = chunk_id - chunk_base;
+        VariableChunk *chunk = pos < chunks.size() ? chunks[pos] : nullptr;
+        if (!chunk || chunk->created < DRJIT_VAR_CHUNK_SIZE ||
+            chunk->live > DRJIT_VAR_CHUNK_SPARSE || chunk->live == 0)
+            continue;
+
+        for (uint32_t i = 0; i < DRJIT_VAR_CHUNK_SIZE; ++i) {
+            if (!(chunk->used[i / 64] & (1ull << (i % 64))))
+                continue;
+
+            // Find a free entry in the spill chunks
+            VariableChunk *spill = nullptr;
+            if (!spill_chunks.empty() && spill_chunks.back()->live < DRJIT_VAR_CHUNK_SIZE)
+                spill = spill_chunks.back();
+            for (size_t j = 0; !spill && j < spill_chunks.size(); ++j) {
+                if (spill_chunks[j]->live < DRJIT_VAR_CHUNK_SIZE)
+                    spill = spill_chunks[j];
+            }
+            if (!spill) {
+                spill = alloc_chunk();
+                spill->created = DRJIT_VAR_CHUNK_SIZE;
+                spill_chunks.push_back(spill);
+            }
+
+            uint32_t word = 0;
+            while (spill->used[word] == ~0ull)
+                word++;
+            uint32_t bit = 0;
+            while (spill->used[word] & (1ull << bit))
+                bit++;
+            uint32_t slot = word * 64 + bit;
+
+            spill->used[word] |= 1ull << bit;
+            spill->live++;
+            memcpy((void *) (spill->vars + slot), chunk->vars + i, sizeof(Variable));
+            memcpy(spill->scratch + slot, chunk->scratch + i, sizeof(VariableScratch));
+
+            uint32_t index = (chunk_id << DRJIT_VAR_CHUNK_SHIFT) + i;
+            relocated[index] = spill->vars + slot;
+            relocated_max = std::max(relocated_max, index);
+        }
+
+        chunks[pos] = nullptr;
+        release_chunk(chunk);
+    }
+
+    sparse_chunks.clear();
+    trim();
+}
+
+size_t VariableTable::memory() const {
+    return (m_chunk_count + free_chunks.size()) * DRJIT_VAR_CHUNK_ALIGN +
+           chunks.capacity() * sizeof(VariableChunk *) +
+           relocated.bucket_count() * (sizeof(uint32_t) + sizeof(Variable *));
+}
+
+void VariableTable::clear() {
+    aligned_allocator<VariableChunk, DRJIT_VAR_CHUNK_ALIGN> alloc;
+    for (VariableChunk *chunk : chunks) {
+        if (chunk)
+            alloc.deallocate(chunk, 1);
+    }
+    for (VariableChunk *chunk : free_chunks)
+        alloc.deallocate(chunk, 1);
+    for (VariableChunk *chunk : spill_chunks)
+        alloc.deallocate(chunk, 1);
+    chunks.clear();
+    chunks.shrink_to_fit();
+    free_chunks.clear();
+    spill_chunks.clear();
+    relocated.clear();
+    sparse_chunks.clear();
+    chunk_base = relocated_max = 0;
+    m_size = m_chunk_count = 0;
+}
 
 /// Cleanup handler, called when the internal/external reference count reaches zero
 void jitc_var_free(uint32_t index, Variable *v) {
@@ -239,14 +440,9 @@ void jitc_var_free(uint32_t index, Variable *v) {
         free(extra.label);
     }
 
-    // Remove from hash table
+    // Remove from the variable table
     state.variables.erase(index);
 
-#if defined(DRJIT_VALGRIND)
-    VariableMap var_new(state.variables);
-    state.variables.swap(var_new);
-#endif
-
     if (likely(!write_ptr)) {
         // Decrease reference count of dependencies
         for (int i = 0; i < 4; ++i)
@@ -258,10 +454,10 @@ void jitc_var_free(uint32_t index, Variable *v) {
 
 /// Access a variable by ID, terminate with an error if it doesn't exist
 Variable *jitc_var(uint32_t index) {
-    auto it = state.variables.find(index);
-    if (unlikely(it == state.variables.end()))
+    Variable *v = state.variables.find(index);
+    if (unlikely(!v))
         jitc_fail("jit_var(r%u): unknown variable!", index);
-    return &it.value();
+    return v;
 }
 
 /// Increase the external reference count of a given variable
@@ -429,10 +625,48 @@ void jitc_value_print(const Variable *v, bool graphviz = false) {
     #undef JIT_LITERAL_PRINT
 }
 
+/**
+ * \brief Sort the operands of commutative operations by their index
+ *
+ * Expressions like 'a + b' and 'b + a' then produce identical nodes, which
+ * lets value numbering merge them and makes kernel hashes independent of the
+ * order in which equivalent code was traced.
+ */
+static void jitc_var_canonicalize(Variable &v) {
+    switch ((VarKind) v.kind) {
+        case VarKind::And:
+        case VarKind::Or:
+            // Mixed operand types (value & mask) are not interchangeable
+            if (jitc_var(v.dep[0])->type != jitc_var(v.dep[1])->type)
+                return;
+            break;
+
+        case VarKind::Add:
+        case VarKind::Mul:
+        case VarKind::Mulhi:
+        case VarKind::Min:
+        case VarKind::Max:
+        case VarKind::Xor:
+        case VarKind::Eq:
+        case VarKind::Neq:
+        case VarKind::Fma: // Only the two multiplicands
+            break;
+
+        default:
+            return;
+    }
+
+    if (v.dep[0] > v.dep[1])
+        std::swap(v.dep[0], v.dep[1]);
+}
+
 /// Append the given variable to the instruction trace and return its ID
 uint32_t jitc_var_new(Variable &v, bool disable_lvn) {
     ThreadState *ts = thread_state(v.backend);
 
+    if (v.is_node())
+        jitc_var_canonicalize(v);
+
     bool lvn = !disable_lvn && (VarType) v.type != VarType::Void &&
                !v.is_data() &&
                jit_flag(JitFlag::ValueNumbering);
@@ -450,23 +684,16 @@ uint32_t jitc_var_new(Variable &v, bool disable_lvn) {
     Variable *vo;
 
     if (likely(!lvn || lvn_key_inserted)) {
-        #if defined(DRJIT_VALGRIND)
-            VariableMap var_new(state.variables);
-            state.variables.swap(var_new);
-        #endif
-
         // .. nope, it is new.
-        VariableMap::iterator var_it;
-        bool var_inserted = false;
+        vo = nullptr;
         do {
             index = state.variable_index++;
 
             if (unlikely(index == 0)) // overflow
                 continue;
 
-            std::tie(var_it, var_inserted) =
-                state.variables.try_emplace(index, v);
-        } while (!var_inserted);
+            vo = state.variables.insert(index, v);
+        } while (!vo);
 
         state.variable_watermark = std::max(state.variable_watermark,
                                             (uint32_t) state.variables.size());
@@ -474,7 +701,8 @@ uint32_t jitc_var_new(Variable &v, bool disable_lvn) {
         if (lvn_key_inserted)
             key_it.value() = index;
 
-        vo = &var_it.value();
+        if (!vo->is_data() && !vo->is_literal())
+            ts->auto_eval_ops++;
 
         if (unlikely(ts->prefix)) {
             vo->extra = true;
@@ -501,7 +729,7 @@ uint32_t jitc_var_new(Variable &v, bool disable_lvn) {
         var_buffer.clear();
         var_buffer.fmt("jit_var_new(%s r%u", type_name[v.type], index);
         if (v.size > 1)
-            var_buffer.fmt("[%u]", v.size);
+            var_buffer.fmt("[%zu]", v.size);
 
         uint32_t n_dep = 0;
         for (int i = 0; i < 4; ++i) {
@@ -550,7 +778,7 @@ uint32_t jitc_var_literal(JitBackend backend, VarType type, const void *value,
     if (unlikely(size == 0))
         return 0;
 
-    jitc_check_size("jit_var_literal", size);
+    jitc_check_size("jit_var_literal", backend, size);
 
     /* When initializing a value pointer array while recording a virtual
        function, we can leverage the already available `self` variable
@@ -569,7 +797,7 @@ uint32_t jitc_var_literal(JitBackend backend, VarType type, const void *value,
         memcpy(&v.literal, value, type_size[(uint32_t) type]);
         v.kind = (uint32_t) VarKind::Literal;
         v.type = (uint32_t) type;
-        v.size = (uint32_t) size;
+        v.size = size;
         v.backend = (uint32_t) backend;
 
         return jitc_var_new(v);
@@ -579,7 +807,7 @@ uint32_t jitc_var_literal(JitBackend backend, VarType type, const void *value,
             jitc_malloc(backend == JitBackend::CUDA ? AllocType::Device
                                                     : AllocType::HostAsync,
                         size * (size_t) isize);
-        jitc_memset_async(backend, data, (uint32_t) size, isize, value);
+        jitc_memset_async(backend, data, size, isize, value);
         return jitc_var_mem_map(backend, type, data, size, 1);
     }
 }
@@ -618,12 +846,17 @@ uint32_t jitc_var_counter(JitBackend backend, size_t size,
         return jitc_var_literal(backend, VarType::UInt32, &zero, 1, 0);
     }
 
-    jitc_check_size("jit_var_counter", size);
+    // Counter values are 32-bit integers
+    if (unlikely(size > 0xFFFFFFFF))
+        jitc_raise("jit_var_counter(): tried to create a counter with %zu "
+                   "entries, which exceeds the limit of 2^32 == 4294967296 "
+                   "entries.", size);
+
     Variable v;
     v.kind = VarKind::Counter;
     v.backend = (uint32_t) backend;
     v.type = (uint32_t) VarType::UInt32;
-    v.size = (uint32_t) size;
+    v.size = size;
     return jitc_var_new(v);
 }
 
@@ -672,7 +905,7 @@ void jitc_new_scope(JitBackend backend) {
 uint32_t jitc_var_stmt(JitBackend backend, VarType vt, const char *stmt,
                        int stmt_static, uint32_t n_dep,
                        const uint32_t *dep) {
-    uint32_t size = n_dep == 0 ? 1 : 0;
+    size_t size = n_dep == 0 ? 1 : 0;
     bool dirty = false, uninitialized = false, placeholder = false;
     Variable *v[4] { };
 
@@ -745,7 +978,7 @@ uint32_t jitc_var_stmt(JitBackend backend, VarType vt, const char *stmt,
  *   evaluated, and the function checks that this worked as expected.
  */
 uint32_t jitc_var_new_node_0(JitBackend backend, VarKind kind, VarType vt,
-                             uint32_t size, bool placeholder, uint64_t payload) {
+                             size_t size, bool placeholder, uint64_t payload) {
 
     Variable v;
     v.literal = payload;
@@ -759,7 +992,7 @@ uint32_t jitc_var_new_node_0(JitBackend backend, VarKind kind, VarType vt,
 }
 
 uint32_t jitc_var_new_node_1(JitBackend backend, VarKind kind, VarType vt,
-                             uint32_t size, bool placeholder,
+                             size_t size, bool placeholder,
                              uint32_t a0, Variable *v0, uint64_t payload) {
 
     if (unlikely(v0->is_dirty())) {
@@ -785,7 +1018,7 @@ uint32_t jitc_var_new_node_1(JitBackend backend, VarKind kind, VarType vt,
 }
 
 uint32_t jitc_var_new_node_2(JitBackend backend, VarKind kind, VarType vt,
-                             uint32_t size, bool placeholder,
+                             size_t size, bool placeholder,
                              uint32_t a0, Variable *v0,
                              uint32_t a1, Variable *v1, uint64_t payload) {
 
@@ -813,7 +1046,7 @@ uint32_t jitc_var_new_node_2(JitBackend backend, VarKind kind, VarType vt,
 }
 
 uint32_t jitc_var_new_node_3(JitBackend backend, VarKind kind, VarType vt,
-                             uint32_t size, bool placeholder,
+                             size_t size, bool placeholder,
                              uint32_t a0, Variable *v0, uint32_t a1, Variable *v1,
                              uint32_t a2, Variable *v2, uint64_t payload) {
     if (unlikely(v0->is_dirty() || v1->is_dirty() || v2->is_dirty())) {
@@ -842,7 +1075,7 @@ uint32_t jitc_var_new_node_3(JitBackend backend, VarKind kind, VarType vt,
 }
 
 uint32_t jitc_var_new_node_4(JitBackend backend, VarKind kind, VarType vt,
-                             uint32_t size, bool placeholder,
+                             size_t size, bool placeholder,
                              uint32_t a0, Variable *v0, uint32_t a1, Variable *v1,
                              uint32_t a2, Variable *v2, uint32_t a3, Variable *v3,
                              uint64_t payload) {
@@ -953,10 +1186,10 @@ const char *jitc_var_str(uint32_t index) {
 
     var_buffer.clear();
     var_buffer.put('[');
-    for (uint32_t i = 0; i < size; ++i) {
+    for (size_t i = 0; i < size; ++i) {
         if (size > state.print_limit && i == limit_remainder / 2) {
             var_buffer.fmt(".. %zu skipped .., ", size - limit_remainder);
-            i = (uint32_t) (size - limit_remainder / 2 - 1);
+            i = size - limit_remainder / 2 - 1;
             continue;
         }
 
@@ -965,7 +1198,7 @@ const char *jitc_var_str(uint32_t index) {
             jitc_memcpy((JitBackend) v->backend, dst, src_offset, isize);
         }
 
-        const char *comma = i + 1 < (uint32_t) size ? ", " : "";
+        const char *comma = i + 1 < size ? ", " : "";
         switch ((VarType) v->type) {
             case VarType::Bool:    var_buffer.fmt("%"   PRIu8  "%s", *(( uint8_t *) dst), comma); break;
             case VarType::Int8:    var_buffer.fmt("%"   PRId8  "%s", *((  int8_t *) dst), comma); break;
@@ -1010,10 +1243,9 @@ static void jitc_raise_consumed_error(const char *func, uint32_t index) {
 
 /// Schedule a variable \c index for future evaluation via \ref jit_eval()
 int jitc_var_schedule(uint32_t index) {
-    auto it = state.variables.find(index);
-    if (unlikely(it == state.variables.end()))
+    Variable *v = state.variables.find(index);
+    if (unlikely(!v))
         jitc_raise("jit_var_schedule(r%u): unknown variable!", index);
-    Variable *v = &it.value();
 
     if (unlikely(v->placeholder))
         jitc_raise_placeholder_error("jitc_var_schedule", index);
@@ -1049,7 +1281,7 @@ void *jitc_var_ptr(uint32_t index) {
 /// Evaluate a literal constant variable
 void jitc_var_eval_literal(uint32_t index, Variable *v) {
     jitc_log(Debug,
-            "jit_var_eval_literal(r%u): writing %s literal of size %u",
+            "jit_var_eval_literal(r%u): writing %s literal of size %zu",
             index, type_name[v->type], v->size);
 
     jitc_lvn_drop(index, v);
@@ -1058,7 +1290,7 @@ void jitc_var_eval_literal(uint32_t index, Variable *v) {
     uint32_t isize = type_size[v->type];
     void* data = jitc_malloc(backend == JitBackend::CUDA ? AllocType::Device
                                                          : AllocType::HostAsync,
-                             (size_t) v->size * (size_t) isize);
+                             v->size * (size_t) isize);
     v = jitc_var(index);
     jitc_memset_async(backend, data, v->size, isize, &v->literal);
 
@@ -1106,9 +1338,9 @@ void jitc_var_read(uint32_t index, size_t offset, void *dst) {
 
     if (v->size == 1)
         offset = 0;
-    else if (unlikely(offset >= (size_t) v->size))
+    else if (unlikely(offset >= v->size))
         jitc_raise("jit_var_read(): attempted to access entry %zu in an array of "
-                   "size %u!", offset, v->size);
+                   "size %zu!", offset, v->size);
 
     uint32_t isize = type_size[v->type];
     if (v->is_literal())
@@ -1133,9 +1365,9 @@ uint32_t jitc_var_write(uint32_t index, size_t offset, const void *src) {
     jitc_var_ptr(index); // ensure variable is evaluated, even if it is a value
 
     v = jitc_var(index);
-    if (unlikely(offset >= (size_t) v->size))
+    if (unlikely(offset >= v->size))
         jitc_raise("jit_var_write(): attempted to access entry %zu in an array of "
-                   "size %u!", offset, v->size);
+                   "size %zu!", offset, v->size);
 
     uint32_t isize = type_size[v->type];
     uint8_t *dst = (uint8_t *) v->data + offset * isize;
@@ -1150,14 +1382,14 @@ uint32_t jitc_var_mem_map(JitBackend backend, VarType type, void *ptr,
     if (unlikely(size == 0))
         return 0;
 
-    jitc_check_size("jit_var_mem_map", size);
+    jitc_check_size("jit_var_mem_map", backend, size);
 
     Variable v;
     v.kind = (uint32_t) VarKind::Data;
     v.type = (uint32_t) type;
     v.backend = (uint32_t) backend;
     v.data = ptr;
-    v.size = (uint32_t) size;
+    v.size = size;
     v.retain_data = free == 0;
 
     if (backend == JitBackend::LLVM) {
@@ -1175,7 +1407,7 @@ uint32_t jitc_var_mem_copy(JitBackend backend, AllocType atype, VarType vtype,
     if (unlikely(size == 0))
         return 0;
 
-    jitc_check_size("jit_var_mem_copy", size);
+    jitc_check_size("jit_var_mem_copy", backend, size);
 
     size_t total_size = (size_t) size * (size_t) type_size[(int) vtype];
     void *target_ptr;
@@ -1278,9 +1510,9 @@ uint32_t jitc_var_resize(uint32_t index, size_t size) {
     if (index == 0 && size == 0)
         return 0;
 
-    jitc_check_size("jit_var_resize", size);
-
     Variable *v = jitc_var(index);
+    jitc_check_size("jit_var_resize", (JitBackend) v->backend, size);
+
     if (unlikely(v->consumed))
         jitc_raise_consumed_error("jitc_var_resize", index);
 
@@ -1303,7 +1535,7 @@ uint32_t jitc_var_resize(uint32_t index, size_t size) {
         // Nobody else holds a reference -- we can directly resize this variable
         jitc_var_inc_ref(index, v);
         jitc_lvn_drop(index, v);
-        v->size = (uint32_t) size;
+        v->size = size;
         jitc_lvn_put(index, v);
         result = index;
     } else if (v->is_literal()) {
@@ -1315,7 +1547,7 @@ uint32_t jitc_var_resize(uint32_t index, size_t size) {
         v2.type = v->type;
         v2.backend = v->backend;
         v2.placeholder = v->placeholder;
-        v2.size = (uint32_t) size;
+        v2.size = size;
         v2.dep[0] = index;
         v2.stmt = (char *) (((JitBackend) v->backend == JitBackend::CUDA)
                             ? "mov.$t0 $r0, $r1"
@@ -1373,7 +1605,7 @@ uint32_t jitc_var_migrate(uint32_t src_index, AllocType dst_type) {
             jitc_memset_async(dst_type == AllocType::HostAsync
                                   ? JitBackend::LLVM
                                   : JitBackend::CUDA,
-                              ptr, (uint32_t) size, type_size[v->type], &v->literal);
+                              ptr, size, type_size[v->type], &v->literal);
         }
 
         return jitc_var_mem_map(backend, (VarType) v->type, ptr, v->size, 1);
@@ -1410,7 +1642,7 @@ uint32_t jitc_var_migrate(uint32_t src_index, AllocType dst_type) {
         dst_ptr = jitc_malloc(dst_type, size);
         jitc_memcpy_async(backend, dst_ptr, src_ptr, size);
     } else {
-        auto [size, type, device] = alloc_info_decode(it->second);
+        auto [size, type, device] = alloc_info_decode(it->second.info);
         (void) size; (void) device;
         src_type = type;
         dst_ptr = jitc_malloc_migrate(src_ptr, dst_type, 0);
@@ -1441,17 +1673,14 @@ uint32_t jitc_var_migrate(uint32_t src_index, AllocType dst_type) {
     return dst_index;
 }
 
-uint32_t jitc_var_mask_default(JitBackend backend, uint32_t size) {
+uint32_t jitc_var_mask_default(JitBackend backend, size_t size) {
     if (backend == JitBackend::CUDA) {
         bool value = true;
         return jitc_var_literal(backend, VarType::Bool, &value, size, 0);
     } else {
         // Ignore SIMD lanes that lie beyond the end of the range
-        Ref counter = steal(jitc_var_counter(backend, size, false));
-        Variable *v_counter = jitc_var(counter);
-        return jitc_var_new_node_1(backend, VarKind::DefaultMask, VarType::Bool,
-                                   v_counter->size, v_counter->placeholder,
-                                   counter, v_counter);
+        return jitc_var_new_node_0(backend, VarKind::DefaultMask, VarType::Bool,
+                                   size, false);
     }
 }
 
@@ -1473,7 +1702,7 @@ void jitc_var_mask_push(JitBackend backend, uint32_t index) {
     thread_state(backend)->mask_stack.push_back(index);
 }
 
-uint32_t jitc_var_mask_apply(uint32_t index, uint32_t size) {
+uint32_t jitc_var_mask_apply(uint32_t index, size_t size) {
     const Variable *v = jitc_var(index);
     JitBackend backend = (JitBackend) v->backend;
 
@@ -1483,8 +1712,8 @@ uint32_t jitc_var_mask_apply(uint32_t index, uint32_t size) {
     auto &stack = thread_state(backend)->mask_stack;
     Ref mask;
     if (!stack.empty()) {
-        uint32_t index_2 = stack.back(),
-                 size_2  = jitc_var(index_2)->size;
+        uint32_t index_2 = stack.back();
+        size_t size_2 = jitc_var(index_2)->size;
 
         // Use mask from the mastk stack if its size is compatible
         if (size == 1 || size_2 == 1 || size_2 == size)
@@ -1502,7 +1731,7 @@ uint32_t jitc_var_mask_apply(uint32_t index, uint32_t size) {
         result = jitc_var_resize(index, size);
     }
 
-    jitc_log(Debug, "jit_var_apply_mask(r%u <- r%u, size=%u)", result, index, size);
+    jitc_log(Debug, "jit_var_apply_mask(r%u <- r%u, size=%zu)", result, index, size);
     return result;
 }
 
@@ -1553,7 +1782,7 @@ bool jitc_var_all(uint32_t index) {
     return jitc_all((JitBackend) v->backend, (uint8_t *) v->data, v->size);
 }
 
-template <typename T> static void jitc_var_reduce_scalar(uint32_t size, void *ptr) {
+template <typename T> static void jitc_var_reduce_scalar(size_t size, void *ptr) {
     T value;
     memcpy(&value, ptr, sizeof(T));
     value = T(value * T(size));
@@ -1573,7 +1802,7 @@ uint32_t jitc_var_reduce(uint32_t index, ReduceOp reduce_op) {
 
     if (v->is_literal()) {
         uint64_t value = v->literal;
-        uint32_t size = v->size;
+        size_t size = v->size;
 
         // Tricky cases
         if (size != 1 && (reduce_op == ReduceOp::Add)) {
@@ -1603,7 +1832,7 @@ uint32_t jitc_var_reduce(uint32_t index, ReduceOp reduce_op) {
         v = jitc_var(index);
 
     uint8_t *values = (uint8_t *) v->data;
-    uint32_t size = v->size;
+    size_t size = v->size;
 
     void *data =
         jitc_malloc(backend == JitBackend::CUDA ? AllocType::Device
@@ -1641,16 +1870,15 @@ const char *jitc_var_whos() {
 
     std::vector<uint32_t> indices;
     indices.reserve(state.variables.size());
-    for (const auto& it : state.variables)
-        indices.push_back(it.first);
-    std::sort(indices.begin(), indices.end());
+    state.variables.for_each(
+        [&](uint32_t index, const Variable &) { indices.push_back(index); });
 
     size_t mem_size_evaluated = 0,
            mem_size_unevaluated = 0;
 
     for (uint32_t index: indices) {
         const Variable *v = jitc_var(index);
-        size_t mem_size = (size_t) v->size * (size_t) type_size[v->type];
+        size_t mem_size = v->size * (size_t) type_size[v->type];
 
         var_buffer.fmt("  %-9u %s %-5s ", index,
                        (JitBackend) v->backend == JitBackend::CUDA ? "cuda"
@@ -1667,7 +1895,7 @@ const char *jitc_var_whos() {
                 else
                     var_buffer.put("mapped mem.");
             } else {
-                auto [size, type, device] = alloc_info_decode(it->second);
+                auto [size, type, device] = alloc_info_decode(it->second.info);
                 (void) size;
 
                 if ((AllocType) type == AllocType::Device) {
@@ -1684,7 +1912,7 @@ const char *jitc_var_whos() {
         size_t sz = var_buffer.fmt("  %u", (uint32_t) v->ref_count);
         const char *label = jitc_var_label(index);
 
-        var_buffer.fmt("%*s%-10u%-8s   %s\n", 10 - (int) sz, "", v->size,
+        var_buffer.fmt("%*s%-10zu%-8s   %s\n", 10 - (int) sz, "", v->size,
                    jitc_mem_string(mem_size), label ? label : "");
 
         if (v->is_data())
@@ -1695,7 +1923,6 @@ const char *jitc_var_whos() {
     if (indices.empty())
         var_buffer.put("                       -- No variables registered --\n");
 
-    constexpr size_t BucketSize1 = sizeof(tsl::detail_robin_hash::bucket_entry<VariableMap::value_type, false>);
     constexpr size_t BucketSize2 = sizeof(tsl::detail_robin_hash::bucket_entry<LVNMap::value_type, false>);
 
     var_buffer.put("  =======================================================================\n\n");
@@ -1708,22 +1935,36 @@ const char *jitc_var_whos() {
     var_buffer.fmt("   - Variables created : %u (peak: %u, table size: %s).\n",
                state.variable_index, state.variable_watermark,
                jitc_mem_string(
-                   state.variables.bucket_count() * BucketSize1 +
+                   state.variables.memory() +
                    state.lvn_map.bucket_count() * BucketSize2));
     var_buffer.fmt("   - Kernel launches   : %zu (%zu cache hits, "
-               "%zu soft, %zu hard misses).\n\n",
+               "%zu soft, %zu hard misses).\n",
                state.kernel_launches, state.kernel_hits,
                state.kernel_soft_misses, state.kernel_hard_misses);
+    var_buffer.fmt("   - Kernel cache      : %zu kernels, %s (%zu evictions).\n\n",
+               state.kernel_cache.size(),
+               jitc_mem_string(state.kernel_cache_size),
+               state.kernel_evictions);
 
     var_buffer.put("  Memory allocator\n");
     var_buffer.put("  ================\n");
-    for (int i = 0; i < (int) AllocType::Count; ++i)
-        var_buffer.fmt("   - %-18s: %s/%s used (peak: %s).\n",
+    for (int i = 0; i < (int) AllocType::Count; ++i) {
+        var_buffer.fmt("   - %-18s: %s/%s used (peak: %s",
                    alloc_type_name[i],
                    std::string(jitc_mem_string(state.alloc_usage[i])).c_str(),
                    std::string(jitc_mem_string(state.alloc_allocated[i])).c_str(),
                    std::string(jitc_mem_string(state.alloc_watermark[i])).c_str());
 
+        // Rounding to size classes, and unused blocks held by the cache
+        if (state.alloc_allocated[i])
+            var_buffer.fmt(", rounding: %.1f%%, cached: %.1f%%",
+                (state.alloc_usage[i] - state.alloc_requested[i]) * 100.0 /
+                    std::max(state.alloc_usage[i], (size_t) 1),
+                (state.alloc_allocated[i] - state.alloc_usage[i]) * 100.0 /
+                    state.alloc_allocated[i]);
+        var_buffer.put(").\n");
+    }
+
     return var_buffer.get();
 }
 
@@ -1731,10 +1972,9 @@ const char *jitc_var_whos() {
 const char *jitc_var_graphviz() {
     std::vector<uint32_t> indices;
     indices.reserve(state.variables.size());
-    for (const auto& it : state.variables)
-        indices.push_back(it.first);
+    state.variables.for_each(
+        [&](uint32_t index, const Variable &) { indices.push_back(index); });
 
-    std::sort(indices.begin(), indices.end());
     var_buffer.clear();
     var_buffer.put("digraph {\n"
                    "    rankdir=TB;\n"
@@ -1874,7 +2114,7 @@ const char *jitc_var_graphviz() {
         if (labeled && !color)
             color = "wheat";
 
-        var_buffer.fmt("|{Type: %s %s|Size: %u}|{r%u|Refs: %u}}",
+        var_buffer.fmt("|{Type: %s %s|Size: %zu}|{r%u|Refs: %u}}",
             (JitBackend) v->backend == JitBackend::CUDA ? "cuda" : "llvm",
             type_name_short[v->type], v->size, index,
             (uint32_t) v->ref_count);
@@ -38,26 +38,26 @@ extern uint32_t jitc_var_stmt(JitBackend backend,
 
 /// Create a new IR node. Just a wrapper around jitc_var_new without any error checking
 extern uint32_t jitc_var_new_node_0(JitBackend backend, VarKind kind,
-                                    VarType vt, uint32_t size, bool placeholder,
+                                    VarType vt, size_t size, bool placeholder,
                                     uint64_t payload = 0);
 
 extern uint32_t jitc_var_new_node_1(JitBackend backend, VarKind kind,
-                                    VarType vt, uint32_t size, bool placeholder,
+                                    VarType vt, size_t size, bool placeholder,
                                     uint32_t a0, Variable *v0,
                                     uint64_t payload = 0);
 
 extern uint32_t jitc_var_new_node_2(JitBackend backend, VarKind kind,
-                                    VarType vt, uint32_t size, bool placeholder,
+                                    VarType vt, size_t size, bool placeholder,
                                     uint32_t a0, Variable *v0, uint32_t a1, Variable *v1,
                                     uint64_t payload = 0);
 
 extern uint32_t jitc_var_new_node_3(JitBackend backend, VarKind kind,
-                                    VarType vt, uint32_t size, bool placeholder,
+                                    VarType vt, size_t size, bool placeholder,
                                     uint32_t a0, Variable *v0, uint32_t a1, Variable *v1,
                                     uint32_t a2, Variable *v2, uint64_t payload = 0);
 
 extern uint32_t jitc_var_new_node_4(JitBackend backend, VarKind kind,
-                                    VarType vt, uint32_t size, bool placeholder,
+                                    VarType vt, size_t size, bool placeholder,
                                     uint32_t a0, Variable *v0, uint32_t a1, Variable *v1,
                                     uint32_t a2, Variable *v2, uint32_t a3, Variable *v4,
                                     uint64_t payload = 0);
@@ -186,10 +186,10 @@ extern void jitc_var_mask_push(JitBackend backend, uint32_t index);
 extern void jitc_var_mask_pop(JitBackend backend);
 
 /// Combine the given mask 'index' with the mask stack. 'size' indicates the wavefront size
-extern uint32_t jitc_var_mask_apply(uint32_t index, uint32_t size);
+extern uint32_t jitc_var_mask_apply(uint32_t index, size_t size);
 
 /// Return the default mask
-extern uint32_t jitc_var_mask_default(JitBackend backend, uint32_t size);
+extern uint32_t jitc_var_mask_default(JitBackend backend, size_t size);
 
 /// Start a new scope of the program being recorded
 extern void jitc_new_scope(JitBackend backend);
@@ -85,8 +85,9 @@ uint32_t jitc_var_vcall(const char *name, uint32_t self, uint32_t mask_,
         jitc_raise("jit_var_vcall(): list of all output indices must be a "
                    "multiple of the instance count!");
 
-    uint32_t n_out = n_out_nested / n_inst, size = 0,
+    uint32_t n_out = n_out_nested / n_inst,
              in_size_initial = 0, out_size_initial = 0;
+    size_t size = 0;
 
     bool placeholder = false, dirty = false;
 
@@ -377,7 +378,7 @@ uint32_t jitc_var_vcall(const char *name, uint32_t self, uint32_t mask_,
     jitc_log(InfoSym,
              "jit_var_vcall(r%u, self=r%u): call (\"%s\") with %u instance%s, %u "
              "input%s, %u output%s (%u devirtualized), %u side effect%s, %u "
-             "byte%s of call data, %u elements%s%s", (uint32_t) vcall_v, self, name, n_inst,
+             "byte%s of call data, %zu elements%s%s", (uint32_t) vcall_v, self, name, n_inst,
              n_inst == 1 ? "" : "s", n_in, n_in == 1 ? "" : "s", n_out,
              n_out == 1 ? "" : "s", n_devirt, se_count, se_count == 1 ? "" : "s",
              data_size, data_size == 1 ? "" : "s", size,
@@ -423,7 +424,7 @@ uint32_t jitc_var_vcall(const char *name, uint32_t self, uint32_t mask_,
         for (uint32_t i = 0; i < vcall_2->in.size(); ++i) {
             uint32_t index_2 = vcall_2->in_nested[i];
             if (index_2 &&
-                state.variables.find(index_2) == state.variables.end()) {
+                !state.variables.find(index_2)) {
                 Extra *e = &state.extra[vcall_2->id];
                 if (unlikely(e->dep[i] != vcall_2->in[i]))
                     jitc_fail("jit_var_vcall(): internal error! (1)");
@@ -558,7 +559,7 @@ static ProfilerRegion profiler_region_vcall_assemble("jit_var_vcall_assemble");
 /// Called by the JIT compiler when compiling a virtual function call
 void jitc_var_vcall_assemble(VCall *vcall, uint32_t self_reg, uint32_t mask_reg,
                              uint32_t offset_reg, uint32_t data_reg) {
-    uint32_t vcall_reg = jitc_var(vcall->id)->reg_index;
+    uint32_t vcall_reg = jitc_var_scratch(jitc_var(vcall->id)).reg_index;
 
     ProfilerPhase profiler(profiler_region_vcall_assemble);
 
@@ -568,19 +569,14 @@ void jitc_var_vcall_assemble(VCall *vcall, uint32_t self_reg, uint32_t mask_reg,
 
     struct JitBackupRecord {
         ScheduledVariable sv;
-        uint32_t param_type : 2;
-        uint32_t output_flag : 1;
-        uint32_t reg_index;
-        uint32_t param_offset;
+        VariableScratch scratch;
     };
 
     std::vector<JitBackupRecord> backup;
     backup.reserve(schedule.size());
 
     for (const ScheduledVariable &sv : schedule) {
-        const Variable *v = jitc_var(sv.index);
-        backup.push_back(JitBackupRecord{ sv, v->param_type, v->output_flag,
-                                          v->reg_index, v->param_offset });
+        backup.push_back(JitBackupRecord{ sv, jitc_var_scratch(jitc_var(sv.index)) });
     }
 
     int32_t alloca_size_backup = alloca_size;
@@ -601,33 +597,29 @@ void jitc_var_vcall_assemble(VCall *vcall, uint32_t self_reg, uint32_t mask_reg,
              n_out_active = 0;
 
     for (uint32_t i = 0; i < n_in; ++i) {
-        auto it = state.variables.find(vcall->in[i]);
-        if (it == state.variables.end())
+        const Variable *v = state.variables.find(vcall->in[i]);
+        if (!v)
             continue;
 
-        uint32_t size = type_size[it.value().type],
+        uint32_t size = type_size[v->type],
                  offset = in_size;
-        Variable *v = &it.value();
         in_size += size;
         in_align = std::max(size, in_align);
         n_in_active++;
 
         // Transfer parameter offset to instances
-        auto it2 = state.variables.find(vcall->in_nested[i]);
-        if (it2 == state.variables.end())
+        Variable *v2 = state.variables.find(vcall->in_nested[i]);
+        if (!v2)
             continue;
 
-        Variable *v2 = &it2.value();
-        v2->param_offset = offset;
-        v2->reg_index = v->reg_index;
+        jitc_var_scratch(v2).param_offset = offset;
+        jitc_var_scratch(v2).reg_index = jitc_var_scratch(v).reg_index;
     }
 
     for (uint32_t i = 0; i < n_out; ++i) {
-        auto it = state.variables.find(vcall->out_nested[i]);
-        if (it == state.variables.end())
+        Variable *v = state.variables.find(vcall->out_nested[i]);
+        if (!v)
             continue;
-
-        Variable *v = &it.value();
         uint32_t size = type_size[v->type];
         out_size += size;
         out_align = std::max(size, out_align);
@@ -666,11 +658,7 @@ void jitc_var_vcall_assemble(VCall *vcall, uint32_t self_reg, uint32_t mask_reg,
 
     schedule.clear();
     for (const JitBackupRecord &b : backup) {
-        Variable *v = jitc_var(b.sv.index);
-        v->param_type = b.param_type;
-        v->output_flag = b.output_flag;
-        v->reg_index = b.reg_index;
-        v->param_offset = b.param_offset;
+        jitc_var_scratch(jitc_var(b.sv.index)) = b.scratch;
         schedule.push_back(b.sv);
     }
 
@@ -729,7 +717,7 @@ void jitc_var_vcall_collect_data(tsl::robin_map<uint64_t, uint32_t, UInt64Hasher
             jitc_raise(
                 "jit_var_vcall(): the virtual function call associated with "
                 "instance %u accesses an evaluated variable r%u of type "
-                "%s and size %u. However, only *scalar* (size == 1) "
+                "%s and size %zu. However, only *scalar* (size == 1) "
                 "evaluated variables can be accessed while recording "
                 "virtual function calls",
                 inst_id, index, type_name[v->type], v->size);
@@ -825,7 +813,7 @@ VCallBucket *jitc_var_vcall_reduce(JitBackend backend, const char *domain,
     // Ensure input index array is fully evaluated
     jitc_var_eval(index);
 
-    uint32_t size = jitc_var(index)->size;
+    size_t size = jitc_var(index)->size;
 
     if (domain)
         jitc_log(Debug, "jit_vcall(r%u, domain=\"%s\")", index, domain);
@@ -4,9 +4,20 @@
 
 #include "test.h"
 #include <initializer_list>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 #include <typeinfo>
+#include <thread>
+#include <vector>
+#include <string>
+
+#if !defined(_WIN32)
+#  include <dirent.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
 
 TEST_BOTH(01_creation_destruction_cse) {
     // Test CSE involving normal and evaluated constant literals
@@ -652,3 +663,436 @@ TEST_BOTH(08_printf) {
     jit_eval();
 }
 #endif
+
+TEST_LLVM(09_tiered_compile) {
+    // Hot kernels are recompiled at full optimization in the background
+    jit_set_flag(JitFlag::TieredCompile, true);
+    uint32_t threshold = jit_llvm_tier_threshold();
+    jit_llvm_set_tier_threshold(2);
+    scoped_kernel_history history;
+
+    for (int i = 0; i < 20; ++i) {
+        Float x = arange<Float>(1000);
+        Float y = fmadd(x, x, Float(1.f));
+        y.eval();
+        jit_assert(y.read(999) == 998002.f);
+    }
+
+    // Once a kernel runs at tier 1, it never falls back to tier 0
+    uint32_t tier = 0;
+    for (const KernelRecord &k : history.kernels()) {
+        jit_assert(k.tier >= tier && k.tier <= 1);
+        tier = k.tier;
+    }
+
+    // The recompilation runs in the background, wait until it is used
+    for (int i = 0; i < 1000 && tier == 0; ++i) {
+        jit_sync_thread();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        Float x = arange<Float>(1000);
+        Float y = fmadd(x, x, Float(1.f));
+        y.eval();
+        jit_assert(y.read(999) == 998002.f);
+
+        for (const KernelRecord &k : history.kernels())
+            tier = std::max(tier, k.tier);
+    }
+    jit_assert(tier == 1);
+
+    jit_llvm_set_tier_threshold(threshold);
+    jit_set_flag(JitFlag::TieredCompile, false);
+}
+
+TEST_BOTH(10_kernel_cache_limit) {
+    // Least recently used kernels are evicted when the cache is too large
+    jit_flush_kernel_cache();
+    jit_kernel_cache_set_limit(0, 4);
+
+    size_t evictions_before = 0, evictions_after = 0;
+    jit_kernel_cache_stats(nullptr, nullptr, nullptr, &evictions_before, nullptr);
+
+    for (int i = 0; i < 16; ++i) {
+        Float x = arange<Float>(10) + Float((float) i);
+        x.eval();
+        jit_assert(x.read(9) == 9.f + i);
+    }
+
+    jit_kernel_cache_stats(nullptr, nullptr, nullptr, &evictions_after, nullptr);
+    jit_assert(evictions_after > evictions_before);
+
+    jit_kernel_cache_set_limit(0, 0);
+}
+
+TEST_BOTH(11_kernel_cache_prefetch) {
+    // Record the kernels of a session and load them again from disk
+    jit_flush_kernel_cache();
+    std::string manifest;
+    {
+        scoped_kernel_history history;
+        Float x = arange<Float>(10) * 3.f + 11.f;
+        x.eval();
+        manifest = history.manifest();
+    }
+
+    jit_assert(!manifest.empty());
+
+    // Kernels are now written to disk, prefetching them avoids a cache miss
+    jit_flush_kernel_cache();
+    jit_assert(jit_kernel_cache_prefetch(manifest.c_str()) >= 1);
+    jit_assert(jit_kernel_cache_prefetch(manifest.c_str()) == 0);
+
+    size_t misses_before = 0, misses_after = 0;
+    jit_kernel_cache_stats(nullptr, &misses_before, nullptr, nullptr, nullptr);
+    Float y = arange<Float>(10) * 3.f + 11.f;
+    y.eval();
+    jit_assert(y.read(9) == 38.f);
+    jit_kernel_cache_stats(nullptr, &misses_after, nullptr, nullptr, nullptr);
+    jit_assert(misses_before == misses_after);
+}
+
+#if !defined(_WIN32)
+TEST_BOTH(12_kernel_cache_disk_limit) {
+    // The pack file is compacted once it exceeds the size limit
+    const size_t limit = 800 * 1024; // The index takes up ~770 KiB
+    std::string prev_dir = jit_kernel_cache_dir();
+    size_t prev_limit = jit_kernel_cache_disk_limit();
+    jit_kernel_cache_set_dir("drjit_cache_test");
+    jit_kernel_cache_set_disk_limit(limit);
+
+    for (int i = 0; i < 64; ++i) {
+        Float x = arange<Float>(10);
+        for (int j = 0; j <= i; ++j)
+            x = x * x + (float) j;
+        x.eval();
+    }
+
+    // Wait for the background writer
+    jit_flush_kernel_cache();
+
+    // The file name of the pack includes version numbers
+    DIR *dir = opendir("drjit_cache_test");
+    jit_assert(dir);
+    size_t n_packs = 0;
+    while (struct dirent *entry = readdir(dir)) {
+        if (strncmp(entry->d_name, "kernels-v", 9) != 0)
+            continue;
+        std::string path = std::string("drjit_cache_test/") + entry->d_name;
+        struct stat st;
+        jit_assert(stat(path.c_str(), &st) == 0);
+        jit_assert((size_t) st.st_size <= limit);
+        n_packs++;
+    }
+    closedir(dir);
+    jit_assert(n_packs == 1);
+
+    jit_kernel_cache_set_dir(prev_dir.c_str());
+    jit_kernel_cache_set_disk_limit(prev_limit);
+
+    // Remove the temporary cache directory
+    dir = opendir("drjit_cache_test");
+    jit_assert(dir);
+    while (struct dirent *entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+        std::string path = std::string("drjit_cache_test/") + entry->d_name;
+        jit_assert(unlink(path.c_str()) == 0);
+    }
+    closedir(dir);
+    jit_assert(rmdir("drjit_cache_test") == 0);
+}
+#endif
+
+TEST_LLVM(13_malloc_size_classes) {
+    // Allocations are rounded to size classes finer than powers of two
+    size_t requested_0 = 0, usage_0 = 0;
+    jit_malloc_stats(AllocType::HostAsync, &requested_0, &usage_0, nullptr, nullptr);
+
+    size_t size = 5 * 1024 * 1024 + 1;
+    void *ptr = jit_malloc(AllocType::HostAsync, size);
+
+    size_t requested_1 = 0, usage_1 = 0;
+    jit_malloc_stats(AllocType::HostAsync, &requested_1, &usage_1, nullptr, nullptr);
+    jit_assert(requested_1 - requested_0 == size);
+    jit_assert(usage_1 - usage_0 >= size && usage_1 - usage_0 <= size * 5 / 4);
+
+    // A freed block is reused by an allocation of the same size class
+    jit_free(ptr);
+    void *ptr_2 = jit_malloc(AllocType::HostAsync, size + 1000);
+    jit_assert(ptr == ptr_2);
+    jit_free(ptr_2);
+}
+
+TEST_LLVM(15_malloc_policy) {
+    uint32_t policy = jit_malloc_policy();
+    jit_assert(policy == (uint32_t) MallocPolicy::Default);
+
+    // Large host allocations honor the placement policy
+    jit_malloc_set_policy((uint32_t) MallocPolicy::HugePages |
+                          (uint32_t) MallocPolicy::NumaInterleave |
+                          (uint32_t) MallocPolicy::NumaFirstTouch);
+    size_t size = 9 * 1024 * 1024 + 17;
+    uint8_t *ptr = (uint8_t *) jit_malloc(AllocType::Host, size);
+    memset(ptr, 1, size);
+    jit_assert(ptr[0] == 1 && ptr[size - 1] == 1);
+    jit_free(ptr);
+    jit_flush_malloc_cache();
+    jit_malloc_set_policy(policy);
+}
+
+TEST_LLVM(16_malloc_limit) {
+    const size_t MiB = 1024 * 1024;
+    jit_flush_malloc_cache();
+    jit_malloc_set_limit(AllocType::Host, 8 * MiB);
+
+    void *a = jit_malloc(AllocType::Host, 3 * MiB),
+         *b = jit_malloc(AllocType::Host, 4 * MiB);
+    jit_free(a);
+    jit_free(b);
+
+    // Exceeding the limit releases the least recently freed block ('a')
+    void *c = jit_malloc(AllocType::Host, 2 * MiB);
+    size_t allocated = 0;
+    jit_malloc_stats(AllocType::Host, nullptr, nullptr, &allocated, nullptr);
+    jit_assert(allocated == 6 * MiB);
+
+    // .. while 'b' remains available for reuse
+    void *d = jit_malloc(AllocType::Host, 4 * MiB);
+    jit_assert(d == b);
+
+    jit_free(c);
+    jit_free(d);
+    jit_malloc_set_limit(AllocType::Host, 0);
+}
+
+TEST_LLVM(17_var_table) {
+    // Create enough variables to span several chunks of the variable table
+    const uint32_t n = 5000;
+    std::vector<uint32_t> indices(n);
+    for (uint32_t i = 0; i < n; ++i)
+        indices[i] = jit_var_literal(Backend, VarType::UInt32, &i);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        jit_assert(jit_var_exists(indices[i]));
+        jit_assert(jit_var_ref(indices[i]) == 1);
+    }
+
+    for (uint32_t i = 0; i < n; i += 2)
+        jit_var_dec_ref(indices[i]);
+
+    for (uint32_t i = 0; i < n; ++i)
+        jit_assert(jit_var_exists(indices[i]) == (i % 2 == 1));
+
+    // IDs of freed variables are not handed out again
+    uint32_t value = n, index = jit_var_literal(Backend, VarType::UInt32, &value);
+    jit_assert(index > indices[n - 1]);
+    jit_var_dec_ref(index);
+
+    for (uint32_t i = 1; i < n; i += 2)
+        jit_var_dec_ref(indices[i]);
+    for (uint32_t i = 0; i < n; ++i)
+        jit_assert(!jit_var_exists(indices[i]));
+}
+
+TEST_LLVM(18_large_size) {
+    // Array sizes beyond 2^32 are representable on the LLVM backend
+    const size_t size = 5000000000ull;
+    uint64_t value = 2, result = 0;
+    uint32_t a = jit_var_literal(Backend, VarType::UInt64, &value, size),
+             b = jit_var_add(a, a),
+             c = jit_var_reduce(b, ReduceOp::Add),
+             m = jit_var_mask_default(Backend, size);
+
+    jit_assert(jit_var_size(b) == size && jit_var_size(m) == size);
+    jit_var_read(c, 0, &result);
+    jit_assert(result == 4 * size);
+
+    jit_var_dec_ref(a);
+    jit_var_dec_ref(b);
+    jit_var_dec_ref(c);
+    jit_var_dec_ref(m);
+
+    /* The reduction above is folded into a literal. Launch an actual kernel
+       with more than 2^32 lanes by scatter-adding into a single entry, which
+       also checks that the final partial packet is masked correctly. This
+       takes a while, hence it only runs when DRJIT_TEST_LONG is set. */
+    if (!getenv("DRJIT_TEST_LONG"))
+        return;
+
+    const size_t size_2 = ((size_t) 1 << 32) + 5;
+    uint64_t one = 1, zero = 0;
+    bool mask_value = true;
+    uint32_t target = jit_var_literal(Backend, VarType::UInt64, &zero, 1, 1),
+             ones   = jit_var_literal(Backend, VarType::UInt64, &one, size_2),
+             index  = jit_var_literal(Backend, VarType::UInt32, &zero, 1),
+             mask   = jit_var_literal(Backend, VarType::Bool, &mask_value, 1),
+             target_2 = jit_var_scatter(target, ones, index, mask, ReduceOp::Add);
+
+    jit_var_read(target_2, 0, &result);
+    jit_assert(result == size_2);
+
+    jit_var_dec_ref(target);
+    jit_var_dec_ref(ones);
+    jit_var_dec_ref(index);
+    jit_var_dec_ref(mask);
+    jit_var_dec_ref(target_2);
+}
+
+TEST_BOTH(19_fuse_scalars) {
+    // Scalar outputs are computed by the kernel of a larger array
+    scoped_kernel_history history;
+
+    uint32_t value = 3;
+    uint32_t s = jit_var_mem_copy(Backend, AllocType::Host, VarType::UInt32, &value, 1),
+             a = jit_var_counter(Backend, 100),
+             b = jit_var_add(a, s),
+             c = jit_var_mul(s, s);
+    jit_var_schedule(b);
+    jit_var_schedule(c);
+    jit_eval();
+
+    uint32_t b_value = 0, c_value = 0;
+    jit_var_read(b, 99, &b_value);
+    jit_var_read(c, 0, &c_value);
+    jit_assert(b_value == 102 && c_value == 9);
+    jit_assert(history.kernels().size() == 1);
+
+    jit_var_dec_ref(s);
+    jit_var_dec_ref(a);
+    jit_var_dec_ref(b);
+    jit_var_dec_ref(c);
+}
+
+TEST_BOTH(20_auto_eval) {
+    // Long traced computations are split by automatic evaluation checkpoints
+    jit_set_auto_eval_budget(100);
+    scoped_kernel_history history;
+
+    UInt32 x = arange<UInt32>(10);
+    uint32_t ref = 9;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        x = x * UInt32(3) + UInt32(i);
+        ref = ref * 3 + i;
+    }
+    x.eval();
+    jit_assert(x.read(9) == ref);
+    jit_assert(history.kernels().size() >= 10);
+
+    jit_set_auto_eval_budget(0);
+}
+
+TEST_LLVM(21_simplify) {
+    // Algebraic rewrites remove or replace expensive operations
+    scoped_kernel_history history;
+
+    UInt32 x = arange<UInt32>(1000),
+           y = x / UInt32(7) + x * UInt32(8) + x % UInt32(16) - (-x);
+    Float f = arange<Float>(1000),
+          g = -(-f) * Float(-1.f);
+    y.schedule();
+    g.schedule();
+    jit_eval();
+
+    for (uint32_t i : { 0u, 6u, 7u, 500u, 999u }) {
+        jit_assert(y.read(i) == i / 7 + i * 8 + i % 16 + i);
+        jit_assert(g.read(i) == -(float) i);
+    }
+
+    std::vector<KernelRecord> kernels = history.kernels();
+    jit_assert(kernels.size() == 1);
+    for (const KernelRecord &k : kernels) {
+        jit_assert(k.source.find("udiv") == std::string::npos);
+        jit_assert(k.source.find("urem") == std::string::npos);
+        jit_assert(k.source.find("fmul") == std::string::npos);
+        jit_assert(k.source.find("shl") != std::string::npos);
+    }
+}
+
+TEST_BOTH(22_cse_scopes) {
+    // Equivalent operations in different scopes are merged before assembly
+    scoped_kernel_history history;
+
+    UInt32 x = arange<UInt32>(100),
+           a = x * x + UInt32(3);
+    jit_new_scope(Backend);
+    UInt32 b = x * x + UInt32(3),
+           c = a + b;
+    c.eval();
+    jit_assert(c.read(10) == 206);
+
+    uint32_t n_eliminated = 0;
+    for (const KernelRecord &k : history.kernels())
+        n_eliminated += k.eliminated_count;
+
+    // 'x * x', the literal and the addition of the second scope
+    jit_assert(n_eliminated == 3);
+}
+
+TEST_BOTH(23_commutative) {
+    // Commutative operations with swapped operands share a node
+    UInt32 x = arange<UInt32>(10),
+           y = x * x,
+           a = x + y, b = y + x,
+           c = x ^ y, d = y ^ x;
+    jit_assert(a.index() == b.index());
+    jit_assert(c.index() == d.index());
+
+    UInt32 e = x - y, f = y - x;
+    jit_assert(e.index() != f.index());
+    jit_assert(e.read(3) == (uint32_t) -6 && f.read(3) == 6);
+}
+
+TEST_BOTH(24_literal_hoisting) {
+    // A literal that keeps changing is eventually passed as a parameter
+    jit_set_literal_hoisting(2);
+    scoped_kernel_history history;
+
+    for (uint32_t i = 0; i < 6; ++i) {
+        Float x = arange<Float>(100) * Float(i + 0.25f) + Float(1.f);
+        x.eval();
+        jit_assert(x.read(10) == 10.f * (i + 0.25f) + 1.f);
+    }
+
+    uint32_t n_hits = 0;
+    for (const KernelRecord &k : history.kernels())
+        n_hits += k.cache_hit;
+
+    // The 2nd change hoists the literal, later launches reuse this kernel
+    jit_assert(n_hits >= 3);
+
+    // Flushing the kernel cache also forgets the history of literals
+    jit_flush_kernel_cache();
+    for (uint32_t i = 0; i < 2; ++i) {
+        Float x = arange<Float>(100) * Float(i + 0.25f) + Float(1.f);
+        x.eval();
+    }
+    for (const KernelRecord &k : history.kernels())
+        jit_assert(!k.cache_hit);
+
+    jit_set_literal_hoisting(0);
+}
+
+TEST_LLVM(26_var_table_churn) {
+    // A few long-lived variables should not pin entire chunks of the table
+    const uint32_t n = 64 * 1024;
+    size_t before = jit_var_table_memory();
+
+    std::vector<uint32_t> survivors;
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t index = jit_var_literal(Backend, VarType::UInt32, &i, 1);
+        if (i % 1024 == 0)
+            survivors.push_back(index);
+        else
+            jit_var_dec_ref(index);
+    }
+
+    jit_eval();
+    size_t after = jit_var_table_memory();
+    jit_assert(after < before + 20 * 65536);
+
+    for (size_t i = 0; i < survivors.size(); ++i) {
+        std::string expected = "[" + std::to_string(i * 1024) + "]";
+        jit_assert(expected == jit_var_str(survivors[i]));
+        jit_var_dec_ref(survivors[i]);
+    }
+}
@@ -0,0 +1,216 @@
+/*
+    tests/bench.cpp -- Micro-benchmarks of the JIT compiler
+
+    Usage: bench [benchmark name]  (runs all benchmarks by default)
+
+    Each benchmark reports the median of several repetitions. The programs
+    use the LLVM backend so that they can run on any machine.
+
+    To compare two revisions of the library, build both and run the same
+    benchmark against each one on an otherwise idle machine, e.g.
+
+        $ cmake --build build-before --target bench
+        $ cmake --build build-after --target bench
+        $ build-before/tests/bench graph && build-after/tests/bench graph
+
+    Changes that claim a speedup should quote both lines in their commit
+    message. To measure a revision that predates a benchmark, copy this file
+    and the 'bench' target of tests/CMakeLists.txt into it, and drop the
+    benchmarks that use newer API.
+*/
+
+#include <drjit-core/jit.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+/// Build 'width' chains of 'depth' additions, returns the chain ends
+static std::vector<uint32_t> build_graph(uint32_t width, uint32_t depth) {
+    std::vector<uint32_t> layer(width);
+
+    for (uint32_t i = 0; i < width; ++i)
+        layer[i] = jit_var_counter(JitBackend::LLVM, 16);
+
+    for (uint32_t d = 0; d < depth; ++d) {
+        for (uint32_t i = 0; i < width; ++i) {
+            uint32_t value = d * width + i,
+                     c = jit_var_literal(JitBackend::LLVM, VarType::UInt32, &value),
+                     r = jit_var_add(layer[i], c);
+            jit_var_dec_ref(c);
+            jit_var_dec_ref(layer[i]);
+            layer[i] = r;
+        }
+    }
+
+    return layer;
+}
+
+/* Build a large graph of small arrays, then release it. This stresses
+   variable creation, lookups, and reference counting. A smaller graph is
+   also evaluated to measure the traversal and assembly in jit_eval() (the
+   kernel is compiled in the first repetition and reused afterwards). */
+static void bench_graph() {
+    const uint32_t reps = 5;
+    std::vector<double> t_build, t_free, t_eval;
+
+    for (uint32_t rep = 0; rep < reps; ++rep) {
+        Clock::time_point start = Clock::now();
+        std::vector<uint32_t> layer = build_graph(1000, 1000);
+        t_build.push_back(elapsed(start));
+
+        start = Clock::now();
+        for (uint32_t index : layer)
+            jit_var_dec_ref(index);
+        t_free.push_back(elapsed(start));
+
+        layer = build_graph(100, 100);
+        start = Clock::now();
+        for (uint32_t index : layer)
+            jit_var_schedule(index);
+        jit_eval();
+        jit_sync_thread();
+        t_eval.push_back(elapsed(start));
+
+        for (uint32_t index : layer)
+            jit_var_dec_ref(index);
+    }
+
+    double n = 2e6; // Variables created per repetition (1000x1000 graph)
+    printf("graph: build %.1f ms (%.2f M variables/s), free %.1f ms, "
+           "eval %.2f ms\n",
+           median(t_build) * 1e3, n / median(t_build) * 1e-6,
+           median(t_free) * 1e3, median(t_eval) * 1e3);
+}
+
+/* Schedule and evaluate a graph with 10^6 nodes: 1000 chains of depth 1000
+   with different sizes. The chains are structurally identical, hence all
+   kernels share the same IR and only the first one is compiled. Most of the
+   remaining time is spent in jitc_var_traverse() and the assembly. */
+static void bench_schedule() {
+    const uint32_t reps = 5, width = 1000, depth = 1000;
+    std::vector<double> t_eval;
+
+    for (uint32_t rep = 0; rep < reps; ++rep) {
+        std::vector<uint32_t> chains(width);
+        for (uint32_t i = 0; i < width; ++i) {
+            uint32_t index = jit_var_counter(JitBackend::LLVM, 16 + i);
+            for (uint32_t d = 0; d < depth; ++d) {
+                uint32_t c = jit_var_literal(JitBackend::LLVM, VarType::UInt32, &d),
+                         r = jit_var_add(index, c);
+                jit_var_dec_ref(c);
+                jit_var_dec_ref(index);
+                index = r;
+            }
+            chains[i] = index;
+        }
+
+        Clock::time_point start = Clock::now();
+        for (uint32_t index : chains)
+            jit_var_schedule(index);
+        jit_eval();
+        jit_sync_thread();
+        t_eval.push_back(elapsed(start));
+
+        for (uint32_t index : chains)
+            jit_var_dec_ref(index);
+    }
+
+    double n = (double) width * depth;
+    printf("schedule: eval %.1f ms (%.2f M nodes/s)\n",
+           median(t_eval) * 1e3, n / median(t_eval) * 1e-6);
+}
+
+/* Horizontal reductions of a 256 MiB array on the CPU. The throughput is
+   compared to that of jit_memcpy(), which approximates the memory bandwidth
+   (it reads and writes the array, hence the factor 2). */
+static void bench_reduce() {
+    const uint32_t reps = 10;
+    const size_t bytes = (size_t) 1 << 28;
+
+    uint8_t *data = (uint8_t *) jit_malloc(AllocType::Host, bytes),
+            *copy = (uint8_t *) jit_malloc(AllocType::Host, bytes);
+    void *out = jit_malloc(AllocType::Host, sizeof(double));
+
+    float *f = (float *) data;
+    for (size_t i = 0; i < bytes / sizeof(float); ++i)
+        f[i] = (float) (i % 1000) * 0.001f;
+
+    auto measure = [&](VarType type, ReduceOp op, uint32_t tsize) {
+        std::vector<double> t;
+        for (uint32_t rep = 0; rep < reps; ++rep) {
+            Clock::time_point start = Clock::now();
+            jit_reduce(JitBackend::LLVM, type, op, data, bytes / tsize, out);
+            jit_sync_thread();
+            t.push_back(elapsed(start));
+        }
+        return bytes / median(t) * 1e-9;
+    };
+
+    std::vector<double> t_copy;
+    for (uint32_t rep = 0; rep < reps; ++rep) {
+        Clock::time_point start = Clock::now();
+        jit_memcpy(JitBackend::LLVM, copy, data, bytes);
+        t_copy.push_back(elapsed(start));
+    }
+
+    double add_f32 = measure(VarType::Float32, ReduceOp::Add, 4);
+    jit_set_flag(JitFlag::ReduceKahan, true);
+    double kahan_f32 = measure(VarType::Float32, ReduceOp::Add, 4);
+    jit_set_flag(JitFlag::ReduceKahan, false);
+
+    double add_f64 = measure(VarType::Float64, ReduceOp::Add, 8),
+           add_u32 = measure(VarType::UInt32, ReduceOp::Add, 4),
+           max_f32 = measure(VarType::Float32, ReduceOp::Max, 4);
+
+    printf("reduce: sum f32 %.1f GB/s (kahan %.1f GB/s), sum f64 %.1f GB/s, "
+           "sum u32 %.1f GB/s, max f32 %.1f GB/s, memcpy %.1f GB/s\n",
+           add_f32, kahan_f32, add_f64, add_u32, max_f32,
+           2 * bytes / median(t_copy) * 1e-9);
+
+    jit_free(out);
+    jit_free(copy);
+    jit_free(data);
+}
+
+struct Benchmark {
+    const char *name;
+    void (*func)();
+};
+
+static const Benchmark benchmarks[] = {
+    { "graph", bench_graph },
+    { "schedule", bench_schedule },
+    { "reduce", bench_reduce },
+};
+
+int main(int argc, char **argv) {
+    jit_init((uint32_t) JitBackend::LLVM);
+    jit_set_log_level_stderr(LogLevel::Warn);
+
+    bool found = false;
+    for (const Benchmark &b : benchmarks) {
+        if (argc > 1 && strcmp(argv[1], b.name) != 0)
+            continue;
+        b.func();
+        found = true;
+    }
+
+    if (!found)
+        fprintf(stderr, "Unknown benchmark \"%s\"!\n", argv[1]);
+
+    jit_shutdown();
+    return found ? 0 : 1;
+}
@@ -1,5 +1,6 @@
 #include "test.h"
 #include <algorithm>
+#include <cmath>
 
 TEST_BOTH(01_all_any) {
     using Bool = Array<bool>;
@@ -329,3 +330,65 @@ TEST_BOTH(12_block_ops) {
     jit_log(Info, "block_sum:  %s\n", block_sum(a, 3).str());
 }
 #endif
+
+TEST_LLVM(13_reduce_sum) {
+    // Pairwise and compensated sums of large arrays remain accurate
+    const uint32_t n = 1u << 22;
+    double ref = (double) n * (n - 1) / 2;
+
+    for (int kahan = 0; kahan < 2; ++kahan) {
+        jit_set_flag(JitFlag::ReduceKahan, kahan);
+        Float x = arange<Float>(n);
+        x.eval();
+        double value = (double) hsum(x).read(0);
+        jit_assert(std::abs(value - ref) < 1e-6 * ref);
+    }
+
+    jit_set_flag(JitFlag::ReduceKahan, false);
+}
+
+/// Place 'value' at position 'pos' of [offset, offset + 1, ..] and reduce
+template <typename Array, typename Value>
+Value reduce_with(ReduceOp op, uint32_t size, uint32_t pos, Value offset, Value value) {
+    Array x = arange<Array>(size) + Array(offset);
+    x.eval();
+    x.write(pos, value);
+    return Array::steal(jit_var_reduce(x.index(), op)).read(0);
+}
+
+TEST_BOTH(14_reduce_min_max) {
+    // The extremum may be located in the vectorized part or in the tail
+    const uint32_t sizes[] = { 1, 7, 63, 1000, 1000003 };
+
+    for (uint32_t size : sizes) {
+        const uint32_t positions[] = { 0, size / 2, size - 1 };
+        for (uint32_t pos : positions) {
+            jit_assert(reduce_with<Float>(ReduceOp::Max, size, pos, 0.f, 1e9f) == 1e9f);
+            jit_assert(reduce_with<Float>(ReduceOp::Min, size, pos, 0.f, -5.f) == -5.f);
+            jit_assert(reduce_with<Int32>(ReduceOp::Max, size, pos, 0, 1 << 30) == 1 << 30);
+            jit_assert(reduce_with<Int32>(ReduceOp::Min, size, pos, 0, -5) == -5);
+            jit_assert(reduce_with<UInt32>(ReduceOp::Max, size, pos, 10u, 0xFFFFFFF0u) == 0xFFFFFFF0u);
+            jit_assert(reduce_with<UInt32>(ReduceOp::Min, size, pos, 10u, 3u) == 3u);
+        }
+    }
+}
+
+TEST_BOTH(15_reduce_sum_int) {
+    // Integer sums are exact, unsigned ones wrap around like in C++
+    const uint32_t sizes[] = { 1, 7, 63, 1000, 1000003 };
+
+    for (uint32_t size : sizes) {
+        uint32_t ref_u = 0;
+        for (uint32_t i = 0; i < size; ++i)
+            ref_u += i;
+        jit_assert(hsum(arange<UInt32>(size)).read(0) == ref_u);
+
+        // Signed sums must not overflow
+        if (size <= 1000) {
+            int32_t ref_i = 0;
+            for (uint32_t i = 0; i < size; ++i)
+                ref_i += (int32_t) i - 100;
+            jit_assert(hsum(arange<Int32>(size) - Int32(100)).read(0) == ref_i);
+        }
+    }
+}
@@ -2,7 +2,10 @@
 
 #include <drjit-core/array.h>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <string>
+#include <vector>
 
 using namespace drjit;
 
@@ -105,3 +108,55 @@ private:
     LogLevel m_cb_level;
     LogLevel m_stderr_level;
 };
+
+/// Kernel history entry along with a copy of its IR ('ir' is cleared)
+struct KernelRecord : KernelHistoryEntry {
+    std::string source;
+};
+
+/// RAII helper that records the kernel history while it is alive
+struct scoped_kernel_history {
+public:
+    scoped_kernel_history() {
+        m_enabled = jit_flag(JitFlag::KernelHistory);
+        jit_set_flag(JitFlag::KernelHistory, true);
+        jit_kernel_history_clear();
+    }
+
+    ~scoped_kernel_history() {
+        jit_set_flag(JitFlag::KernelHistory, m_enabled);
+    }
+
+    /// Return the launches of JIT kernels since the last call
+    std::vector<KernelRecord> kernels() {
+        std::vector<KernelRecord> result;
+        KernelHistoryEntry *history = jit_kernel_history();
+        for (KernelHistoryEntry *e = history; e && e->backend != (JitBackend) 0; ++e) {
+            if (e->type == KernelType::JIT) {
+                KernelRecord record;
+                (KernelHistoryEntry &) record = *e;
+                record.ir = nullptr;
+                record.source = e->ir ? e->ir : "";
+                result.push_back(record);
+            }
+            free(e->ir);
+        }
+        free(history);
+        return result;
+    }
+
+    /// Return a manifest of the kernels launched since the last call
+    std::string manifest() {
+        KernelHistoryEntry *history = jit_kernel_history();
+        char *manifest = jit_kernel_history_manifest(history);
+        for (KernelHistoryEntry *e = history; e && e->backend != (JitBackend) 0; ++e)
+            free(e->ir);
+        free(history);
+        std::string result = manifest ? manifest : "";
+        free(manifest);
+        return result;
+    }
+
+private:
+    int m_enabled;
+};